@@ -0,0 +1,377 @@
+/*
+    AnalogFilter.h - Filters for the samples of the Analog-Digital-Converter
+    (oversampling and decimation, moving average, median), that process one
+    sample at a time in the Interrupt-Service-Routine.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANALOGFILTER_H_
+#define ANALOGFILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "AnalogInput.h"
+
+#ifdef __cplusplus
+
+/**
+ * All filters have the same two methods:
+ *  - `bool addSample( uint16_t sample )`: processes the next sample. Returns
+ *    true, if a new result is available.
+ *  - `uint16_t getResult() const`: the latest result.
+ *
+ * The sizes of the accumulators are computed at compile-time from the
+ * number of bits of the samples (template-parameter `sampleBits`, 10 for the
+ * samples of the ADC), so they are as small as possible and never overflow.
+ * Averages are computed with shifts: no division, no loops (except in
+ * `MedianFilter`), so a filter can run in the Interrupt-Service-Routine of
+ * the ADC (see `AnalogFilterBank`).
+ */
+
+//The smallest unsigned integer-type with at least `bits` bits
+template<bool fits8, bool fits16> struct _AnalogUintSelect
+{
+    typedef uint32_t Type;
+};
+template<bool fits16> struct _AnalogUintSelect<true, fits16>
+{
+    typedef uint8_t Type;
+};
+template<> struct _AnalogUintSelect<false, true>
+{
+    typedef uint16_t Type;
+};
+template<uint8_t bits> struct _AnalogUint
+{
+    typedef typename _AnalogUintSelect<(bits <= 8), (bits <= 16)>::Type Type;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Oversampling and decimation
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Increases the resolution by `extraBits` bits: 4^extraBits samples are
+ * added up, and the sum is shifted right by `extraBits` bits (with
+ * rounding). For example `OversampleFilter<2>` gives 12-bit-results
+ * (0 ... 4092) from 16 samples of the 10-bit-ADC, so the rate of the results
+ * is 1/16 of the sample-rate.
+ *
+ * The additional bits are only real, if the input has a noise of at least
+ * 1 LSB (otherwise all samples are the same). The noise of the ADC itself is
+ * usually enough; with a very clean input a small triangle-signal can be
+ * added.
+ *
+ * @param extraBits Additional bits of resolution (1 ... 16 - sampleBits)
+ * @param sampleBits Number of bits of the samples (default 10)
+ */
+template<uint8_t extraBits, uint8_t sampleBits=10>
+class OversampleFilter
+{
+    static_assert( extraBits >= 1, "extraBits must be at least 1" );
+    static_assert( sampleBits + extraBits <= 16,
+                   "the results must not have more than 16 bits" );
+
+    typedef typename _AnalogUint<sampleBits + 2*extraBits>::Type _sum_t;
+    typedef typename _AnalogUint<2*extraBits>::Type _count_t;
+
+public:
+    /** Number of samples added up for one result */
+    static constexpr uint16_t SAMPLES = 1U << (2*extraBits);
+
+    /** Number of bits of the results */
+    static constexpr uint8_t RESULT_BITS = sampleBits + extraBits;
+
+    OversampleFilter() : _sum( 0 ), _remaining( SAMPLES - 1 ), _result( 0 )
+    {
+    }
+
+    /**
+     * Adds a sample. Returns true with each `SAMPLES`th sample, when a new
+     * result is available.
+     */
+    bool addSample( uint16_t sample )
+    {
+        _sum += sample;
+        if (_remaining)
+        {
+            _remaining--;
+            return false;
+        }
+        _result = (uint16_t)((_sum + (1U << (extraBits-1))) >> extraBits);
+        _sum = 0;
+        _remaining = SAMPLES - 1;
+        return true;
+    }
+
+    /** The latest result (0, before the first one is complete) */
+    uint16_t getResult() const
+    {
+        return _result;
+    }
+
+private:
+    _sum_t _sum;
+    _count_t _remaining;
+    uint16_t _result;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Moving average
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * The average of the last 2^log2Length samples (rounded). A running sum is
+ * kept: each sample costs one addition and one subtraction, independent of
+ * the length. The first sample fills the whole window, so the average
+ * doesn't start at 0. There is a result after each sample.
+ *
+ * @param log2Length The length of the window is 2^log2Length (1 ... 6:
+ *      2 ... 64 samples)
+ * @param sampleBits Number of bits of the samples (default 10, for example
+ *      12 after an `OversampleFilter<2>`)
+ */
+template<uint8_t log2Length, uint8_t sampleBits=10>
+class MovingAverageFilter
+{
+    static_assert( log2Length >= 1 && log2Length <= 6,
+                   "log2Length must be between 1 and 6" );
+    static_assert( sampleBits <= 16, "sampleBits must not be more than 16" );
+
+    typedef typename _AnalogUint<sampleBits + log2Length>::Type _sum_t;
+
+public:
+    /** Number of samples in the window */
+    static constexpr uint8_t LENGTH = 1U << log2Length;
+
+    MovingAverageFilter() : _sum( 0 ), _oldest( 0 ), _primed( false )
+    {
+    }
+
+    /**
+     * Adds a sample. Always returns true.
+     */
+    bool addSample( uint16_t sample )
+    {
+        if (!_primed)
+        {
+            for (uint8_t i = 0; i < LENGTH; i++) _window[i] = sample;
+            _sum = (_sum_t)sample << log2Length;
+            _primed = true;
+            return true;
+        }
+        _sum += sample;
+        _sum -= _window[_oldest];
+        _window[_oldest] = sample;
+        _oldest = (_oldest + 1) & (LENGTH - 1);
+        return true;
+    }
+
+    /** The average of the window */
+    uint16_t getResult() const
+    {
+        return (uint16_t)((_sum + (1U << (log2Length-1))) >> log2Length);
+    }
+
+private:
+    uint16_t _window[LENGTH];
+    _sum_t _sum;
+    uint8_t _oldest;
+    bool _primed;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Median
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * The median of the last `length` samples: removes single spikes (for
+ * example from switching loads), which an average would only spread out.
+ * Besides the samples in order of their arrival, a sorted copy is kept, in
+ * which each new sample replaces the oldest one (at most `length` steps).
+ * The first sample fills the whole window. There is a result after each
+ * sample.
+ *
+ * @param length The length of the window (odd, 3 ... 15)
+ */
+template<uint8_t length>
+class MedianFilter
+{
+    static_assert( length >= 3 && length <= 15 && (length & 0x01),
+                   "length must be odd and between 3 and 15" );
+
+public:
+    MedianFilter() : _oldest( 0 ), _primed( false )
+    {
+    }
+
+    /**
+     * Adds a sample. Always returns true.
+     */
+    bool addSample( uint16_t sample )
+    {
+        if (!_primed)
+        {
+            for (uint8_t i = 0; i < length; i++)
+            {
+                _window[i] = sample;
+                _sorted[i] = sample;
+            }
+            _primed = true;
+            return true;
+        }
+
+        uint16_t old = _window[_oldest];
+        _window[_oldest] = sample;
+        _oldest = (_oldest + 1 < length) ? _oldest + 1 : 0;
+
+        //replace the old sample in the sorted copy, and move the new one to
+        //its place
+        uint8_t p = 0;
+        while (_sorted[p] != old) p++;
+        while (p > 0 && _sorted[p-1] > sample)
+        {
+            _sorted[p] = _sorted[p-1];
+            p--;
+        }
+        while (p < length - 1 && _sorted[p+1] < sample)
+        {
+            _sorted[p] = _sorted[p+1];
+            p++;
+        }
+        _sorted[p] = sample;
+        return true;
+    }
+
+    /** The median of the window */
+    uint16_t getResult() const
+    {
+        return _sorted[length / 2];
+    }
+
+private:
+    uint16_t _window[length];
+    uint16_t _sorted[length];
+    uint8_t _oldest;
+    bool _primed;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Combination of filters
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Two filters one after the other: each result of the first one is a sample
+ * of the second one. For example a median against spikes, then
+ * oversampling:
+ * {@code
+ *     AnalogFilterChain< MedianFilter<3>, OversampleFilter<2> >
+ * }
+ * The `sampleBits` of the second filter must be the `RESULT_BITS` of the
+ * first one (12 after an `OversampleFilter<2>`).
+ */
+template<class First, class Second>
+class AnalogFilterChain
+{
+public:
+    /**
+     * Adds a sample to the first filter. Returns true, if the second filter
+     * has a new result.
+     */
+    bool addSample( uint16_t sample )
+    {
+        if (!_first.addSample( sample )) return false;
+        return _second.addSample( _first.getResult() );
+    }
+
+    /** The latest result of the second filter */
+    uint16_t getResult() const
+    {
+        return _second.getResult();
+    }
+
+    First& first() { return _first; }
+    Second& second() { return _second; }
+
+private:
+    First _first;
+    Second _second;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Filters in the Interrupt-Service-Routine of the ADC
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * One filter for each channel-index of the list of `startAnalogScan`,
+ * running in the Interrupt-Service-Routine of the ADC. The blocks get the
+ * results of the filters instead of the samples:
+ * {@code
+ *     typedef AnalogFilterBank< OversampleFilter<2>, 12 > Filters;
+ *
+ *     setAnalogSampleFilter( Filters::filterSample );
+ *     startAnalogScan( channels, 12, buffer, 1, ANALOG_REFERENCE_AVCC,
+ *                      ANALOG_TRIGGER_FREE_RUNNING );
+ * }
+ * Then each block contains one 12-bit-result of each channel (from 16
+ * scans).
+ *
+ * @param Filter The type of the filters (OversampleFilter, ...)
+ * @param channelCount The number of channels of the list (at least)
+ */
+template<class Filter, uint8_t channelCount>
+class AnalogFilterBank
+{
+public:
+    /**
+     * The function for `setAnalogSampleFilter`: passes the sample to the
+     * filter of its channel-index, and replaces it with the result.
+     */
+    static bool filterSample( uint8_t index, uint16_t* sample )
+    {
+        if (index >= channelCount) return true;
+        Filter& filter = _filters[index];
+        if (!filter.addSample( *sample )) return false;
+        *sample = filter.getResult();
+        return true;
+    }
+
+    /**
+     * The filter of a channel-index. Interrupts must be disabled while it is
+     * accessed, if the scan is running.
+     */
+    static Filter& getFilter( uint8_t index )
+    {
+        return _filters[index];
+    }
+
+private:
+    static Filter _filters[channelCount];
+};
+
+template<class Filter, uint8_t channelCount>
+Filter AnalogFilterBank<Filter, channelCount>::_filters[channelCount];
+
+#endif
+
+#endif /* ANALOGFILTER_H_ */
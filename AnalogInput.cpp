@@ -0,0 +1,265 @@
+/*
+    AnalogInput.cpp - Interrupt-driven scanning of the analog inputs of an
+    AVR-Microcontroller into double-buffered blocks of samples.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "AnalogInput.h"
+#include "MCUCapabilities.h"
+
+#ifndef F_CPU
+#error "F_CPU must be defined for AnalogInput.cpp"
+#endif
+
+#define _NO_BLOCK   0xFF
+#define _NO_CHANNEL 0xFF
+
+//ADMUX (and on the ATmega2560 ADCSRB) for each channel-index of the list
+static uint8_t _analogAdmux[ANALOG_SCAN_MAX_CHANNELS];
+#ifdef MUX5
+static uint8_t _analogAdcsrb[ANALOG_SCAN_MAX_CHANNELS];
+#endif
+static uint8_t _analogChannelCount;
+
+//Interrupt-flag, that the trigger-event sets (cleared by the ISR), or 0
+static uint8_t _analogTriggerFlag;
+static bool _analogTriggerTimer1;
+static bool _analogFreeRunning;
+
+//Channel-index of the conversion in progress, and of the channel in ADMUX
+static volatile uint8_t _analogConverting;
+static volatile uint8_t _analogMuxIndex;
+
+static uint16_t* _analogBuffer;
+static uint16_t _analogBlockLength;
+static uint16_t* volatile _analogFillBlock;     //block filled by the ISR
+static volatile uint16_t _analogScanOffset;     //its current scan
+static volatile uint8_t _analogReadyBlock;      //0, 1 or _NO_BLOCK
+static volatile uint8_t _analogOverruns;
+
+static AnalogSampleFilter _analogFilter;
+
+
+//////////////////////////////////////////////////////////////////////////
+// Interrupt-Service-Routine
+//////////////////////////////////////////////////////////////////////////
+
+//Marks the wake-up for the statistics of the event-loop (see EventLoop.h).
+//A weak reference: without EventLoop.cpp its address is 0.
+extern "C" void markEventLoopWake( void ) __attribute__((weak));
+
+//ADMUX is latched at the start of a conversion. In free-running mode the
+//next conversion has already started, when this ISR runs: the channel
+//written to ADMUX now is converted after it (two steps ahead). With a
+//trigger, the next conversion starts with the next event (one step ahead).
+ISR(ADC_vect)
+{
+    uint16_t sample = ADC;
+    uint8_t completed = _analogConverting;
+
+    uint8_t next = _analogMuxIndex + 1;
+    if (next >= _analogChannelCount) next = 0;
+    _analogConverting = _analogFreeRunning ? _analogMuxIndex : next;
+    _analogMuxIndex = next;
+#ifdef MUX5
+    ADCSRB = _analogAdcsrb[next];
+#endif
+    ADMUX = _analogAdmux[next];
+
+    if (_analogTriggerFlag)
+    {
+        if (_analogTriggerTimer1) TIFR1 = _analogTriggerFlag;
+        else TIFR0 = _analogTriggerFlag;
+    }
+
+    if (completed == _NO_CHANNEL) return;
+    AnalogSampleFilter filter = _analogFilter;
+    if (filter && !filter( completed, &sample )) return;
+
+    uint16_t* fillBlock = _analogFillBlock;
+    uint16_t scanOffset = _analogScanOffset;
+    fillBlock[scanOffset + completed] = sample;
+    if (completed + 1 < _analogChannelCount) return;
+
+    //the scan is complete
+    scanOffset += _analogChannelCount;
+    if (scanOffset >= _analogBlockLength)
+    {
+        //the block is complete
+        scanOffset = 0;
+        if (_analogReadyBlock == _NO_BLOCK)
+        {
+            uint8_t filled = (fillBlock == _analogBuffer) ? 0 : 1;
+            _analogReadyBlock = filled;
+            _analogFillBlock = filled ? _analogBuffer
+                                      : _analogBuffer + _analogBlockLength;
+            //only a complete block is an event for the main-loop
+            if (markEventLoopWake) markEventLoopWake();
+        }
+        else if (_analogOverruns < 0xFF)
+        {
+            _analogOverruns++;
+        }
+    }
+    _analogScanOffset = scanOffset;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+//Bits ADPS2:0 of ADCSRA: the smallest prescaler (2 ... 128), that divides
+//F_CPU down to ANALOG_SCAN_MAX_CLOCK
+static uint8_t _prescalerBits( void )
+{
+    uint8_t bits = 1;
+    while (bits < 7 && (F_CPU >> bits) > ANALOG_SCAN_MAX_CLOCK) bits++;
+    return bits;
+}
+
+bool startAnalogScan( const uint8_t* channels, uint8_t channelCount,
+                      uint16_t* buffer, uint8_t scansPerBlock,
+                      uint8_t reference, uint8_t trigger )
+{
+    if (!channels || !buffer || scansPerBlock == 0) return false;
+    if (channelCount == 0 || channelCount > ANALOG_SCAN_MAX_CHANNELS)
+    {
+        return false;
+    }
+    if (reference & ~0xC0) return false;
+    if (trigger > ANALOG_TRIGGER_TIMER1_CAPT
+        || (trigger > ANALOG_TRIGGER_FREE_RUNNING && trigger < 3))
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < channelCount; i++)
+    {
+        if (!mcuAnalogChannelExists( channels[i] )) return false;
+    }
+
+    stopAnalogScan();
+
+    uint8_t didr0 = 0;
+#ifdef DIDR2
+    uint8_t didr2 = 0;
+#endif
+    for (uint8_t i = 0; i < channelCount; i++)
+    {
+        uint8_t channel = channels[i];
+#ifdef MUX5
+        _analogAdmux[i] = reference | (channel & 0x07);
+        _analogAdcsrb[i] = trigger | ((channel & 0x08) ? (1<<MUX5) : 0);
+#else
+        _analogAdmux[i] = reference | channel;
+#endif
+        if (!mcuAnalogChannelOnPin( channel )) continue;
+#ifdef DIDR2
+        if (channel >= 8) didr2 |= 0x01 << (channel - 8);
+        else
+#endif
+        didr0 |= 0x01 << channel;
+    }
+    DIDR0 |= didr0;
+#ifdef DIDR2
+    DIDR2 |= didr2;
+#endif
+
+    _analogChannelCount = channelCount;
+    _analogFreeRunning = (trigger == ANALOG_TRIGGER_FREE_RUNNING);
+    _analogTriggerTimer1 = (trigger >= ANALOG_TRIGGER_TIMER1_COMPB);
+    switch (trigger)
+    {
+        case ANALOG_TRIGGER_TIMER0_COMPA: _analogTriggerFlag = 1<<OCF0A; break;
+        case ANALOG_TRIGGER_TIMER0_OVF:   _analogTriggerFlag = 1<<TOV0; break;
+        case ANALOG_TRIGGER_TIMER1_COMPB: _analogTriggerFlag = 1<<OCF1B; break;
+        case ANALOG_TRIGGER_TIMER1_OVF:   _analogTriggerFlag = 1<<TOV1; break;
+        case ANALOG_TRIGGER_TIMER1_CAPT:  _analogTriggerFlag = 1<<ICF1; break;
+        default:                          _analogTriggerFlag = 0; break;
+    }
+
+    _analogBuffer = buffer;
+    _analogBlockLength = (uint16_t)channelCount * scansPerBlock;
+    _analogFillBlock = buffer;
+    _analogScanOffset = 0;
+    _analogReadyBlock = _NO_BLOCK;
+    _analogOverruns = 0;
+
+    //The first conversion is channel-index 0. In free-running mode the
+    //second one starts before the ISR can change ADMUX, so it converts
+    //index 0 again: the first sample is dropped.
+    _analogConverting = _analogFreeRunning ? _NO_CHANNEL : 0;
+    _analogMuxIndex = 0;
+#ifdef MUX5
+    ADCSRB = _analogAdcsrb[0];
+#else
+    ADCSRB = trigger;
+#endif
+    ADMUX = _analogAdmux[0];
+    if (_analogTriggerFlag)
+    {
+        //an old event would start a conversion immediately
+        if (_analogTriggerTimer1) TIFR1 = _analogTriggerFlag;
+        else TIFR0 = _analogTriggerFlag;
+    }
+
+    ADCSRA = (1<<ADEN) | (1<<ADATE) | (1<<ADIF) | (1<<ADIE)
+             | (_analogFreeRunning ? (1<<ADSC) : 0) | _prescalerBits();
+    return true;
+}
+
+void setAnalogSampleFilter( AnalogSampleFilter filter )
+{
+    uint8_t sreg = SREG;
+    cli();
+    _analogFilter = filter;
+    SREG = sreg;
+}
+
+void stopAnalogScan( void )
+{
+    uint8_t sreg = SREG;
+    cli();
+    ADCSRA = (1<<ADIF);     //disables the ADC, clears a pending interrupt
+    _analogReadyBlock = _NO_BLOCK;
+    SREG = sreg;
+}
+
+bool hasAnalogScanBlock( void )
+{
+    return _analogReadyBlock != _NO_BLOCK;
+}
+
+const uint16_t* takeAnalogScanBlock( void )
+{
+    uint8_t ready = _analogReadyBlock;
+    if (ready == _NO_BLOCK) return 0;
+    return ready ? _analogBuffer + _analogBlockLength : _analogBuffer;
+}
+
+void releaseAnalogScanBlock( void )
+{
+    _analogReadyBlock = _NO_BLOCK;
+}
+
+uint8_t getAnalogScanOverruns( void )
+{
+    return _analogOverruns;
+}
@@ -0,0 +1,213 @@
+/*
+    AnalogInput.h - Interrupt-driven scanning of the analog inputs of an
+    AVR-Microcontroller into double-buffered blocks of samples.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANALOGINPUT_H_
+#define ANALOGINPUT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+/**
+ * The Analog-Digital-Converter converts the channels of a list one after the
+ * other, driven by its Conversion-Complete-Interrupt-Service-Routine (ADC_vect,
+ * which is part of this module). The main-loop doesn't wait for single
+ * conversions (13 ADC-clocks, about 100 microseconds at 16MHz): it gets whole
+ * blocks of samples.
+ *
+ * A block contains `scansPerBlock` scans of all channels of the list, scan
+ * after scan: the sample of channel-index i in scan s is
+ * `block[s * channelCount + i]`. The buffer given to `startAnalogScan` holds
+ * two blocks: while the main-loop works with one block, the
+ * Interrupt-Service-Routine fills the other one. No samples are copied.
+ *
+ * {@code
+ *     const uint8_t channels[] = { 0, 1, 2, 3 };
+ *     uint16_t buffer[ANALOG_SCAN_BUFFER_LENGTH( 4, 8 )];
+ *
+ *     startAnalogScan( channels, 4, buffer, 8, ANALOG_REFERENCE_AVCC,
+ *                      ANALOG_TRIGGER_FREE_RUNNING );
+ *     sei();
+ *     while (1) {
+ *         const uint16_t* block = takeAnalogScanBlock();
+ *         if (block) {
+ *             ... // 8 samples of each channel
+ *             releaseAnalogScanBlock();
+ *         }
+ *     }
+ * }
+ */
+
+/**
+ * Maximum number of channels in the list of `startAnalogScan`.
+ */
+#ifndef ANALOG_SCAN_MAX_CHANNELS
+#define ANALOG_SCAN_MAX_CHANNELS    16
+#endif
+
+/**
+ * The highest clock-frequency of the Analog-Digital-Converter. The prescaler
+ * is the smallest one, that divides `F_CPU` down to this frequency (128 at
+ * 16MHz: 125kHz). Up to 200kHz the full resolution of 10 bits is reached.
+ * Define it with a higher value (up to 1MHz) when compiling AnalogInput.cpp,
+ * if less resolution is enough.
+ */
+#ifndef ANALOG_SCAN_MAX_CLOCK
+#define ANALOG_SCAN_MAX_CLOCK       200000UL
+#endif
+
+/**
+ * Number of uint16_t-elements of the buffer for `startAnalogScan` (two
+ * blocks).
+ */
+#define ANALOG_SCAN_BUFFER_LENGTH( channelCount, scansPerBlock ) \
+    (2 * (channelCount) * (scansPerBlock))
+
+/**
+ * The reference-voltage of the conversions (bits REFS1:0 of ADMUX):
+ *  - ANALOG_REFERENCE_AREF: the voltage at the AREF-pin
+ *  - ANALOG_REFERENCE_AVCC: AVCC (with a capacitor at the AREF-pin)
+ *  - ANALOG_REFERENCE_INTERNAL: the internal 1.1V-reference
+ *  - ANALOG_REFERENCE_INTERNAL_2V56: the internal 2.56V-reference (only
+ *    ATmega2560)
+ */
+#define ANALOG_REFERENCE_AREF           0x00
+#define ANALOG_REFERENCE_AVCC           0x40
+#if defined(__AVR_ATmega2560__)
+#define ANALOG_REFERENCE_INTERNAL       0x80
+#define ANALOG_REFERENCE_INTERNAL_2V56  0xC0
+#else
+#define ANALOG_REFERENCE_INTERNAL       0xC0
+#endif
+
+/**
+ * What starts the conversions (bits ADTS2:0 of ADCSRB):
+ *  - ANALOG_TRIGGER_FREE_RUNNING: each conversion starts, when the previous
+ *    one is complete. The fastest way to scan.
+ *  - ANALOG_TRIGGER_TIMER0_COMPA ... ANALOG_TRIGGER_TIMER1_CAPT: a
+ *    conversion starts with the Compare-Match-A or Overflow of
+ *    Timer/Counter0, or the Compare-Match-B, Overflow or Input-Capture of
+ *    Timer/Counter1. The Timer/Counter must be set up separately; it gives
+ *    the sample-rate (one channel per event). The Interrupt-Service-Routine
+ *    of this module clears the interrupt-flag of the event, so no
+ *    Interrupt-Service-Routine of the Timer/Counter is needed.
+ */
+#define ANALOG_TRIGGER_FREE_RUNNING     0
+#define ANALOG_TRIGGER_TIMER0_COMPA     3
+#define ANALOG_TRIGGER_TIMER0_OVF       4
+#define ANALOG_TRIGGER_TIMER1_COMPB     5
+#define ANALOG_TRIGGER_TIMER1_OVF       6
+#define ANALOG_TRIGGER_TIMER1_CAPT      7
+
+/**
+ * Processes a sample in the Interrupt-Service-Routine, before it is stored
+ * in the block (see `setAnalogSampleFilter` and AnalogFilter.h). It may
+ * change the sample. Interrupts are disabled while it runs, so it must be
+ * short.
+ *
+ * @param index The channel-index of the sample in the list of
+ *      `startAnalogScan`
+ * @param sample The sample
+ * @return true, if the sample shall be stored, false, if it is dropped (for
+ *      example while an oversampling-filter collects samples).
+ */
+typedef bool (*AnalogSampleFilter)( uint8_t index, uint16_t* sample );
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Starts scanning the analog inputs. The Analog-Digital-Converter is
+ * enabled, the digital input-buffers of the scanned pins are disabled (their
+ * PINx-bits read 0 then), and the conversions start (in free-running mode
+ * immediately, otherwise with the first trigger-event). Interrupts must be
+ * globally enabled (with `sei()`). A scan already running is stopped first.
+ *
+ * @param channels The single-ended input-channels (0 for ADC0 ... 15 for
+ *      ADC15), in the order of the conversions. A channel may appear more
+ *      than once. The list is copied.
+ * @param channelCount Number of channels (1 ... ANALOG_SCAN_MAX_CHANNELS)
+ * @param buffer Memory for two blocks (see ANALOG_SCAN_BUFFER_LENGTH). It
+ *      must stay valid until `stopAnalogScan`.
+ * @param scansPerBlock Number of scans of all channels in a block (at least
+ *      1)
+ * @param reference ANALOG_REFERENCE_AREF, ANALOG_REFERENCE_AVCC, ...
+ * @param trigger ANALOG_TRIGGER_FREE_RUNNING, ANALOG_TRIGGER_TIMER0_COMPA,
+ *      ...
+ * @return false, if a parameter is invalid (then nothing is started).
+ */
+bool startAnalogScan( const uint8_t* channels, uint8_t channelCount,
+                      uint16_t* buffer, uint8_t scansPerBlock,
+                      uint8_t reference, uint8_t trigger );
+
+/**
+ * Sets the function, that processes each sample in the
+ * Interrupt-Service-Routine (see AnalogFilter.h), or 0 (the default) to
+ * store the samples unchanged. A scan is complete, when the sample of the
+ * last channel-index of the list is stored, so with a filter, that drops
+ * samples, a block contains the scans with results of all channels.
+ */
+void setAnalogSampleFilter( AnalogSampleFilter filter );
+
+/**
+ * Stops scanning and disables the Analog-Digital-Converter (to save power).
+ * A conversion in progress is discarded. The digital input-buffers of the
+ * scanned pins stay disabled.
+ */
+void stopAnalogScan( void );
+
+/**
+ * Returns true, if a complete block is waiting for the main-loop (the
+ * pending-check for the event-loop, see EventLoop.h).
+ */
+bool hasAnalogScanBlock( void );
+
+/**
+ * Takes over the complete block, or returns 0, if there is none. The
+ * Interrupt-Service-Routine doesn't touch the block, until it is given back
+ * with `releaseAnalogScanBlock`. Until then, this function returns the same
+ * block again.
+ */
+const uint16_t* takeAnalogScanBlock( void );
+
+/**
+ * Gives the block back to the Interrupt-Service-Routine, after the main-loop
+ * has processed it.
+ */
+void releaseAnalogScanBlock( void );
+
+/**
+ * Returns the number of blocks lost (up to 255), because the main-loop had
+ * not released the previous block, when the next one was complete. A lost
+ * block is filled again with newer samples.
+ */
+uint8_t getAnalogScanOverruns( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANALOGINPUT_H_ */
@@ -0,0 +1,100 @@
+/*
+    Debounce.cpp - Debouncing of buttons and switches connected to the
+    GPIO-Pins of AVR-Microcontrollers, all pins of a port at once.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "Debounce.h"
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+void initDebouncedPort( DebouncedPort* debouncedPort, uint8_t port,
+                        uint8_t mask, uint8_t activeLowMask )
+{
+    debouncedPort->port = port;
+    debouncedPort->mask = mask;
+    debouncedPort->activeLowMask = activeLowMask & mask;
+    debouncedPort->state =
+        readPort( port, mask ) ^ debouncedPort->activeLowMask;
+    debouncedPort->counter0 = 0xFF;
+    debouncedPort->counter1 = 0xFF;
+    debouncedPort->pressed = 0;
+    debouncedPort->released = 0;
+}
+
+uint8_t debouncePort( DebouncedPort* debouncedPort )
+{
+    //1-Bits: pressed pins (in this sample)
+    uint8_t sample = readPort( debouncedPort->port, debouncedPort->mask )
+                     ^ debouncedPort->activeLowMask;
+
+    //Pins, whose sample differs from the debounced state, count down their
+    //counter (3, 2, 1, 0), the other pins reset it to 3. A pin, whose
+    //counter rolls over from 0 to 3, has differed 4 times in a row and
+    //changes its debounced state.
+    uint8_t differing = sample ^ debouncedPort->state;
+    uint8_t counter0 = ~(debouncedPort->counter0 & differing);
+    uint8_t counter1 = counter0 ^ (debouncedPort->counter1 & differing);
+    uint8_t changed = differing & counter0 & counter1;
+    debouncedPort->counter0 = counter0;
+    debouncedPort->counter1 = counter1;
+
+    uint8_t state = debouncedPort->state ^ changed;
+    debouncedPort->state = state;
+    debouncedPort->pressed |= changed & state;
+    debouncedPort->released |= changed & ~state;
+    return changed;
+}
+
+void debouncePorts( DebouncedPort* debouncedPorts, uint8_t count )
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        debouncePort( &debouncedPorts[i] );
+    }
+}
+
+uint8_t getDebouncedState( const DebouncedPort* debouncedPort )
+{
+    return debouncedPort->state;
+}
+
+uint8_t getDebouncedPressed( DebouncedPort* debouncedPort )
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t pressed = debouncedPort->pressed;
+    debouncedPort->pressed = 0;
+    SREG = sreg;
+    return pressed;
+}
+
+uint8_t getDebouncedReleased( DebouncedPort* debouncedPort )
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t released = debouncedPort->released;
+    debouncedPort->released = 0;
+    SREG = sreg;
+    return released;
+}
@@ -0,0 +1,195 @@
+/*
+    Debounce.h - Debouncing of buttons and switches connected to the
+    GPIO-Pins of AVR-Microcontrollers, all pins of a port at once.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GPIO.h"
+
+/**
+ * The debounce-state of the pins of one port.
+ *
+ * The pins are sampled (with `debouncePort`) in regular intervals, for
+ * example every 5ms from a Timer-Interrupt-Service-Routine or from the
+ * main-loop. A pin changes its debounced state, when 4 samples in a row
+ * differ from the debounced state. So bouncing contacts are ignored, and a
+ * change is recognized after 4 sampling-intervals (20ms at 5ms).
+ *
+ * Each pin has its own 2-bit-counter for the number of differing samples.
+ * The counters are "vertical": Bit n of `counter0` and of `counter1` form the
+ * counter of pin n. So the counters of all 8 pins of a port are updated at
+ * once with a few logical operations, instead of one pin after the other.
+ *
+ * The members are used by the functions of this module and should not be
+ * changed directly.
+ */
+typedef struct
+{
+    uint8_t port;           // port_A ... port_L
+    uint8_t mask;           // the debounced pins
+    uint8_t activeLowMask;  // pins, that read LOW_LEVEL when pressed
+    uint8_t state;          // debounced state of the pins, 1 = pressed
+    uint8_t counter0;       // low bits of the vertical counters
+    uint8_t counter1;       // high bits of the vertical counters
+    uint8_t pressed;        // pins pressed since the last getDebouncedPressed
+    uint8_t released;       // pins released since the last getDebouncedReleased
+} DebouncedPort;
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initializes the debounce-state of the pins of a port. The current
+ * voltage-levels of the pins are taken as debounced state (pins, that are
+ * already pressed, don't produce a "pressed"-event).
+ *
+ * The pins must be configured as inputs (and the pullup-resistors turned on,
+ * if the buttons are connected to GND) before, for example with
+ * `setPortMode` and `setPortPullup`.
+ *
+ * @param debouncedPort The debounce-state to initialize
+ * @param port The port, for example port_A. Valid values are port_A,
+ *      port_B, ... port_L (some of them might not exist on the specific
+ *      Microcontroller). If the port doesn't exist, `debouncePort` does
+ *      nothing.
+ * @param mask The pins to debounce (1-Bits), for example 0x0F for the pins
+ *      0...3.
+ * @param activeLowMask The pins (1-Bits), that read a Low-Voltage-Level
+ *      when the button is pressed (buttons connected to GND, with
+ *      pullup-resistor). The other pins read a High-Voltage-Level when
+ *      pressed.
+ */
+void initDebouncedPort( DebouncedPort* debouncedPort, uint8_t port,
+                        uint8_t mask, uint8_t activeLowMask );
+
+/**
+ * Takes one sample of the pins (one `readPort`) and updates their debounced
+ * state. Call it in regular intervals, for example from a
+ * Timer-Interrupt-Service-Routine.
+ *
+ * @param debouncedPort The debounce-state of the port
+ * @return The pins (1-Bits), whose debounced state has changed with this
+ *      sample.
+ */
+uint8_t debouncePort( DebouncedPort* debouncedPort );
+
+/**
+ * Same as calling `debouncePort` for each of `count` debounce-states, for
+ * example for all ports with buttons.
+ */
+void debouncePorts( DebouncedPort* debouncedPorts, uint8_t count );
+
+/**
+ * Returns the debounced state of the pins: A 1-Bit for each pressed pin.
+ */
+uint8_t getDebouncedState( const DebouncedPort* debouncedPort );
+
+/**
+ * Returns the pins (1-Bits), that have been pressed since the last call of
+ * this function, and clears them. Interrupts are disabled shortly, so
+ * `debouncePort` may be called from an Interrupt-Service-Routine.
+ */
+uint8_t getDebouncedPressed( DebouncedPort* debouncedPort );
+
+/**
+ * Returns the pins (1-Bits), that have been released since the last call of
+ * this function, and clears them. See `getDebouncedPressed`.
+ */
+uint8_t getDebouncedReleased( DebouncedPort* debouncedPort );
+
+#ifdef __cplusplus
+}
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// C++ object-oriented API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+
+/**
+ * Class for debouncing the pins of a port. See `DebouncedPort` and the
+ * C-functions.
+ *
+ * For example 8 buttons connected between PA0...PA7 and GND:
+ * {@code
+ *     GPIOPort portA = GPIOPort( port_A );
+ *     portA.setPortMode( MODE_INPUT );
+ *     portA.setPortPullup( PULLUP_ON );
+ *     PortDebouncer buttons = PortDebouncer( port_A, 0xFF, 0xFF );
+ *
+ *     while (1) {
+ *         buttons.debounce();     //every 5ms, for example from a Timer-ISR
+ *         uint8_t pressed = buttons.getPressed();
+ *         if (pressed & 0x01) { ... }     //button on PA0 pressed
+ *         //...
+ *     }
+ * }
+ */
+class PortDebouncer
+{
+public:
+    /**
+     * Constructor. See C-function `initDebouncedPort`.
+     */
+    PortDebouncer( uint8_t port, uint8_t mask, uint8_t activeLowMask )
+    {
+        ::initDebouncedPort( &_debouncedPort, port, mask, activeLowMask );
+    }
+
+    /**
+     * Takes one sample of the pins. See C-function `debouncePort`.
+     *
+     * @return The pins, whose debounced state has changed.
+     */
+    uint8_t debounce() { return ::debouncePort( &_debouncedPort ); }
+
+    /**
+     * Returns the debounced state of the pins (1 = pressed).
+     */
+    uint8_t getState() { return ::getDebouncedState( &_debouncedPort ); }
+
+    /**
+     * Returns and clears the pins pressed since the last call.
+     */
+    uint8_t getPressed() { return ::getDebouncedPressed( &_debouncedPort ); }
+
+    /**
+     * Returns and clears the pins released since the last call.
+     */
+    uint8_t getReleased() { return ::getDebouncedReleased( &_debouncedPort ); }
+
+private:
+    DebouncedPort _debouncedPort;
+};
+
+#endif
+
+#endif /* DEBOUNCE_H_ */
@@ -0,0 +1,314 @@
+/*
+    EventLoop.cpp - A main-loop, that handles the events of
+    Interrupt-Service-Routines, and puts the AVR-Microcontroller to sleep,
+    while there is nothing to do.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "EventLoop.h"
+#include "MCUCapabilities.h"
+#include "Timebase.h"
+
+//The event-sources
+typedef struct
+{
+    EventPendingCheck isPending;
+    EventHandler handler;
+} _EventSource;
+
+static _EventSource _eventSources[EVENTLOOP_MAX_SOURCES];
+static uint8_t _eventSourceCount;
+
+static uint8_t _eventLoopSleepLimit = EVENTLOOP_SLEEP_POWER_DOWN;
+
+//The time of the first markEventLoopWake since the microcontroller has
+//gone to sleep, or since the last call of a handler
+static volatile bool _eventLoopWakeMarked;
+static volatile uint32_t _eventLoopWakeTicks;
+
+static EventLoopStatistics _eventLoopStatistics;
+
+//Bits SM2:0 of SMCR for each sleep-mode (EVENTLOOP_SLEEP_IDLE ...)
+static const uint8_t _sleepModeBits[5] =
+{
+    SLEEP_MODE_IDLE, SLEEP_MODE_IDLE, SLEEP_MODE_ADC, SLEEP_MODE_PWR_SAVE,
+    SLEEP_MODE_PWR_DOWN
+};
+
+//Sets of sleep-modes (Bit n for EVENTLOOP_SLEEP_... n), from which an
+//interrupt can wake up the microcontroller
+#define _UP_TO_IDLE         0x03
+#define _UP_TO_ADC          0x07
+#define _UP_TO_POWER_SAVE   0x0F
+#define _UP_TO_POWER_DOWN   0x1F
+
+
+//////////////////////////////////////////////////////////////////////////
+// Choice of the sleep-mode
+//////////////////////////////////////////////////////////////////////////
+
+//Adds the wake-up-restriction of an interrupt, if it is enabled
+static inline void _restrict( uint8_t* allowed, bool* wakeSource,
+                              bool enabled, uint8_t upTo )
+{
+    if (!enabled) return;
+    *wakeSource = true;
+    *allowed &= upTo;
+}
+
+uint8_t getEventLoopSleepMode( void )
+{
+    uint8_t allowed = _UP_TO_POWER_DOWN;
+    bool wakeSource = false;
+
+    //external Interrupts: edges of the synchronous ones need the I/O-clock
+    uint8_t enabledExtInts = EIMSK;
+    for (uint8_t n = 0; n < mcuExtIntCount(); n++)
+    {
+        if (!(enabledExtInts & (0x01<<n))) continue;
+
+        uint8_t senseControl;
+#ifdef EICRB
+        if (n >= 4) senseControl = (EICRB >> ((n-4)*2)) & 0x03;
+        else
+#endif
+        senseControl = (EICRA >> (n*2)) & 0x03;
+
+        bool lowLevel = (senseControl == 0x00);
+        bool async = (mcuExtIntAsyncMask() & (0x01<<n));
+        _restrict( &allowed, &wakeSource, true,
+                   (lowLevel || async) ? _UP_TO_POWER_DOWN : _UP_TO_IDLE );
+    }
+
+    _restrict( &allowed, &wakeSource, PCICR, _UP_TO_POWER_DOWN );
+    _restrict( &allowed, &wakeSource, WDTCSR & (1<<WDIE), _UP_TO_POWER_DOWN );
+
+    _restrict( &allowed, &wakeSource, TIMSK0, _UP_TO_IDLE );
+    _restrict( &allowed, &wakeSource, TIMSK1, _UP_TO_IDLE );
+    _restrict( &allowed, &wakeSource, TIMSK2,
+               (ASSR & (1<<AS2)) ? _UP_TO_POWER_SAVE : _UP_TO_IDLE );
+#ifdef TIMSK3
+    _restrict( &allowed, &wakeSource, TIMSK3, _UP_TO_IDLE );
+#endif
+#ifdef TIMSK4
+    _restrict( &allowed, &wakeSource, TIMSK4, _UP_TO_IDLE );
+#endif
+#ifdef TIMSK5
+    _restrict( &allowed, &wakeSource, TIMSK5, _UP_TO_IDLE );
+#endif
+
+    //USART: receive-, transmit- and data-register-empty-interrupt
+    const uint8_t usartInterrupts = (1<<RXCIE0) | (1<<TXCIE0) | (1<<UDRIE0);
+    _restrict( &allowed, &wakeSource, UCSR0B & usartInterrupts, _UP_TO_IDLE );
+#ifdef UCSR1B
+    _restrict( &allowed, &wakeSource, UCSR1B & usartInterrupts, _UP_TO_IDLE );
+#endif
+#ifdef UCSR2B
+    _restrict( &allowed, &wakeSource, UCSR2B & usartInterrupts, _UP_TO_IDLE );
+#endif
+#ifdef UCSR3B
+    _restrict( &allowed, &wakeSource, UCSR3B & usartInterrupts, _UP_TO_IDLE );
+#endif
+
+    //conversions started by a Timer/Counter (ADTS2:0) need the I/O-clock
+    bool adcTimerTriggered = (ADCSRA & (1<<ADATE)) && (ADCSRB & 0x07);
+    _restrict( &allowed, &wakeSource, ADCSRA & (1<<ADIE),
+               adcTimerTriggered ? _UP_TO_IDLE : _UP_TO_ADC );
+#ifdef SPCR
+    _restrict( &allowed, &wakeSource, SPCR & (1<<SPIE), _UP_TO_IDLE );
+#endif
+#ifdef TWCR
+    _restrict( &allowed, &wakeSource, TWCR & (1<<TWIE), _UP_TO_IDLE );
+#endif
+
+    if (!wakeSource) return EVENTLOOP_SLEEP_NONE;
+
+    //the deepest allowed sleep-mode up to the limit
+    uint8_t sleepMode = _eventLoopSleepLimit;
+    while (sleepMode > EVENTLOOP_SLEEP_NONE && !(allowed & (0x01<<sleepMode)))
+    {
+        sleepMode--;
+    }
+    return sleepMode;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Event-loop
+//////////////////////////////////////////////////////////////////////////
+
+bool addEventSource( EventPendingCheck isPending, EventHandler handler )
+{
+    if (!isPending || !handler) return false;
+    if (_eventSourceCount >= EVENTLOOP_MAX_SOURCES) return false;
+
+    _eventSources[_eventSourceCount].isPending = isPending;
+    _eventSources[_eventSourceCount].handler = handler;
+    _eventSourceCount++;
+    return true;
+}
+
+void setEventLoopSleepLimit( uint8_t sleepMode )
+{
+    if (sleepMode > EVENTLOOP_SLEEP_POWER_DOWN) return;
+    _eventLoopSleepLimit = sleepMode;
+}
+
+//Reads the timebase for the wake-latencies. This version is weak and
+//returns false: Timebase.cpp replaces it with one, that reads the timebase,
+//if it is running. So this module doesn't depend on Timebase.cpp, and
+//without a running timebase no latencies are recorded (instead of 0).
+extern "C" bool _eventLoopTimestamp( uint32_t* ticks ) __attribute__((weak));
+bool _eventLoopTimestamp( uint32_t* ticks )
+{
+    (void)ticks;
+    return false;
+}
+
+//Records the time from the first markEventLoopWake to now
+static void _recordWakeLatency( void )
+{
+    uint8_t sreg = SREG;
+    cli();
+    bool marked = _eventLoopWakeMarked;
+    uint32_t wakeTicks = _eventLoopWakeTicks;
+    _eventLoopWakeMarked = false;
+    SREG = sreg;
+    if (!marked) return;
+
+    uint32_t now;
+    if (!_eventLoopTimestamp( &now )) return;
+    uint32_t latency32 = now - wakeTicks;
+    uint16_t latency = latency32 > 0xFFFF ? 0xFFFF : (uint16_t)latency32;
+
+    EventLoopStatistics* statistics = &_eventLoopStatistics;
+    if (statistics->wakeCount == 0 || latency < statistics->wakeLatencyMin)
+    {
+        statistics->wakeLatencyMin = latency;
+    }
+    if (latency > statistics->wakeLatencyMax)
+    {
+        statistics->wakeLatencyMax = latency;
+    }
+    statistics->wakeLatencySum += latency;
+    if (statistics->wakeCount < 0xFFFF) statistics->wakeCount++;
+}
+
+bool runEventLoopOnce( void )
+{
+    bool handled = false;
+    for (uint8_t i = 0; i < _eventSourceCount; i++)
+    {
+        uint8_t sreg = SREG;
+        cli();
+        bool pending = _eventSources[i].isPending();
+        SREG = sreg;
+
+        if (pending)
+        {
+            if (!handled) _recordWakeLatency();
+            _eventSources[i].handler();
+            handled = true;
+        }
+    }
+    if (handled) return true;
+
+    uint8_t sleepMode = getEventLoopSleepMode();
+
+    //An interrupt between the checks and the sleep-instruction would not
+    //wake up the microcontroller, so the checks are repeated with
+    //interrupts disabled. sei() enables interrupts only after the next
+    //instruction (sleep), so no interrupt can happen in between.
+    cli();
+    for (uint8_t i = 0; i < _eventSourceCount; i++)
+    {
+        if (_eventSources[i].isPending())
+        {
+            sei();
+            return false;
+        }
+    }
+
+    //A wake-up without event (for example an interrupt, that is handled
+    //completely by its Interrupt-Service-Routine) is not measured
+    _eventLoopWakeMarked = false;
+
+    uint16_t* sleepCount = &_eventLoopStatistics.sleepCounts[sleepMode];
+    if (*sleepCount < 0xFFFF) (*sleepCount)++;
+
+    if (sleepMode == EVENTLOOP_SLEEP_NONE)
+    {
+        sei();
+        return false;
+    }
+
+    set_sleep_mode( _sleepModeBits[sleepMode] );
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    return false;
+}
+
+void runEventLoop( void )
+{
+    while (1)
+    {
+        runEventLoopOnce();
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Statistics
+//////////////////////////////////////////////////////////////////////////
+
+void markEventLoopWake( void )
+{
+    uint8_t sreg = SREG;
+    cli();
+    if (!_eventLoopWakeMarked)
+    {
+        uint32_t ticks;
+        if (_eventLoopTimestamp( &ticks ))
+        {
+            _eventLoopWakeTicks = ticks;
+            _eventLoopWakeMarked = true;
+        }
+    }
+    SREG = sreg;
+}
+
+void getEventLoopStatistics( EventLoopStatistics* statistics )
+{
+    uint8_t sreg = SREG;
+    cli();
+    *statistics = _eventLoopStatistics;
+    SREG = sreg;
+}
+
+void clearEventLoopStatistics( void )
+{
+    uint8_t sreg = SREG;
+    cli();
+    _eventLoopStatistics = EventLoopStatistics();
+    SREG = sreg;
+}
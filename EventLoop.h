@@ -0,0 +1,198 @@
+/*
+    EventLoop.h - A main-loop, that handles the events of
+    Interrupt-Service-Routines, and puts the AVR-Microcontroller to sleep,
+    while there is nothing to do.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTLOOP_H_
+#define EVENTLOOP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Maximum number of event-sources (see `addEventSource`). Define it with
+ * another value when compiling EventLoop.cpp, if needed.
+ */
+#ifndef EVENTLOOP_MAX_SOURCES
+#define EVENTLOOP_MAX_SOURCES   8
+#endif
+
+/**
+ * The sleep-modes used by the event-loop, from the lightest to the deepest:
+ *  - EVENTLOOP_SLEEP_NONE: Don't sleep (busy loop). Used, if no
+ *    interrupt is enabled, that could wake up the microcontroller.
+ *  - EVENTLOOP_SLEEP_IDLE: Only the CPU stops. Every interrupt wakes it up.
+ *  - EVENTLOOP_SLEEP_ADC: ADC-Noise-Reduction. The I/O-clock stops
+ *    (Timer/Counters except an asynchronous Timer/Counter2, USART, SPI).
+ *  - EVENTLOOP_SLEEP_POWER_SAVE: Power-down, but an asynchronous
+ *    Timer/Counter2 (with a 32kHz-crystal) keeps running.
+ *  - EVENTLOOP_SLEEP_POWER_DOWN: All clocks stop. Only external Interrupts
+ *    (see below), Pin-Change-Interrupts and the Watchdog wake it up.
+ */
+#define EVENTLOOP_SLEEP_NONE        0
+#define EVENTLOOP_SLEEP_IDLE        1
+#define EVENTLOOP_SLEEP_ADC         2
+#define EVENTLOOP_SLEEP_POWER_SAVE  3
+#define EVENTLOOP_SLEEP_POWER_DOWN  4
+
+/**
+ * Checks, if an event-source has something to do. It is called with
+ * interrupts disabled, so it must be short and must not enable interrupts
+ * (for example `hasExtIntEvent` or a check of a flag set by an
+ * Interrupt-Service-Routine).
+ */
+typedef bool (*EventPendingCheck)( void );
+
+/**
+ * Handles the events of an event-source (for example takes the events out
+ * of a queue). Called from the event-loop with interrupts enabled.
+ */
+typedef void (*EventHandler)( void );
+
+/**
+ * Statistics of the event-loop (see `getEventLoopStatistics`). Times are
+ * ticks of the timebase (see Timebase.h).
+ */
+typedef struct
+{
+    uint16_t sleepCounts[5];    // number of sleeps in each sleep-mode
+                                // (index EVENTLOOP_SLEEP_...), counts up
+                                // to 65535 ([0]: loops without sleeping)
+    uint16_t wakeCount;         // number of wake-latencies measured
+    uint16_t wakeLatencyMin;    // shortest, longest and sum of the
+    uint16_t wakeLatencyMax;    // wake-latencies
+    uint32_t wakeLatencySum;
+} EventLoopStatistics;
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Adds an event-source to the event-loop. In each round the event-loop
+ * calls the handlers of all sources, whose pending-check returns true. If
+ * no source has something to do, the microcontroller sleeps until the next
+ * interrupt.
+ *
+ * For example the queue of the external Interrupts:
+ * {@code
+ *     void handleExtIntEvents() {
+ *         ExtIntEvent event;
+ *         while (readExtIntEvent( &event )) { ... }
+ *     }
+ *     addEventSource( hasExtIntEvent, handleExtIntEvents );
+ * }
+ *
+ * @param isPending The pending-check
+ * @param handler The handler
+ * @return false, if there are already `EVENTLOOP_MAX_SOURCES` sources.
+ */
+bool addEventSource( EventPendingCheck isPending, EventHandler handler );
+
+/**
+ * Limits the sleep-mode of the event-loop. Needed, if the program uses an
+ * interrupt, that the event-loop doesn't know (see `getEventLoopSleepMode`),
+ * or if the wake-up from deeper sleep-modes takes too long.
+ *
+ * @param sleepMode The deepest sleep-mode allowed (EVENTLOOP_SLEEP_NONE ...
+ *      EVENTLOOP_SLEEP_POWER_DOWN). Default: EVENTLOOP_SLEEP_POWER_DOWN
+ */
+void setEventLoopSleepLimit( uint8_t sleepMode );
+
+/**
+ * Returns the sleep-mode, that the event-loop would use now: the deepest
+ * sleep-mode (up to the limit set with `setEventLoopSleepLimit`), from
+ * which all enabled interrupts can wake up the microcontroller. It is
+ * determined from the interrupt-enable-bits of the Special-Function-
+ * Registers:
+ *  - External Interrupts: INT3:0 of the ATmega2560 and all external
+ *    Interrupts in mode EXTINT_LOW_LEVEL_ACTIVE wake up from Power-down.
+ *    Edges of the other external Interrupts (INT1:0 of the ATmega328p,
+ *    INT7:4 of the ATmega2560) only from Idle.
+ *  - Pin-Change-Interrupts and the Watchdog-Interrupt: Power-down
+ *  - Timer/Counter2 in asynchronous mode: Power-save
+ *  - ADC: ADC-Noise-Reduction, but only Idle, if the conversions are
+ *    started by a Timer/Counter (see AnalogInput.h)
+ *  - Other Timer/Counters (also the timebase of Timebase.h), USART, SPI and
+ *    TWI: Idle
+ *
+ * @return EVENTLOOP_SLEEP_NONE ... EVENTLOOP_SLEEP_POWER_DOWN
+ */
+uint8_t getEventLoopSleepMode( void );
+
+/**
+ * Runs one round of the event-loop: Calls the handlers of all event-sources
+ * with pending events. If there are none, the microcontroller sleeps (in
+ * the mode of `getEventLoopSleepMode`) until the next interrupt. The check
+ * for pending events and going to sleep are done with interrupts disabled,
+ * so an event can't get lost between them.
+ *
+ * @return true, if handlers have been called, false if the microcontroller
+ *      has slept (or there was nothing to do).
+ */
+bool runEventLoopOnce( void );
+
+/**
+ * Runs the event-loop forever (calls `runEventLoopOnce` in a loop).
+ * Interrupts must be globally enabled (with `sei()`).
+ */
+void runEventLoop( void ) __attribute__((noreturn));
+
+/**
+ * Marks the time of a wake-up. The time from the first mark after the
+ * microcontroller has gone to sleep, to the next call of a handler, is the
+ * wake-latency (see `getEventLoopStatistics`). A mark, after which the
+ * event-loop goes to sleep again without calling a handler, is discarded.
+ *
+ * The Interrupt-Service-Routines of ExternalInterrupts.cpp,
+ * PinChangeInterrupts.cpp and AnalogInput.cpp (when a block of samples is
+ * complete) call it already. Call it from your own
+ * Interrupt-Service-Routines (or handlers), whose events shall be measured.
+ *
+ * The latencies are measured with the timebase (Timebase.h). If it is not
+ * running (Timebase.cpp is not linked, or `initTimebase` has not been
+ * called), nothing is recorded. Note, that the timebase enables the
+ * Overflow-Interrupt of its Timer/Counter (TOIE1 or TOIE3), so the
+ * event-loop sleeps in Idle at most, while it runs (see
+ * `getEventLoopSleepMode`): the latencies of ADC-Noise-Reduction,
+ * Power-save and Power-down (with the start-up time of the oscillator)
+ * can't be measured this way.
+ */
+void markEventLoopWake( void );
+
+/**
+ * Copies the statistics of the event-loop.
+ */
+void getEventLoopStatistics( EventLoopStatistics* statistics );
+
+/**
+ * Clears the statistics of the event-loop.
+ */
+void clearEventLoopStatistics( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENTLOOP_H_ */
@@ -20,29 +20,109 @@
  */ 
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
 
 #include "ExternalInterrupts.h"
+#include "RingBuffer.h"
+#include "Timebase.h"
 
 
-// Number of external Interrupts
-#if defined(INT7_vect)
-    #define EXT_INT_COUNT  8
-#elif defined(INT6_vect)
-    #define EXT_INT_COUNT  7
-#elif defined(INT5_vect)
-    #define EXT_INT_COUNT  6
-#elif defined(INT4_vect)
-    #define EXT_INT_COUNT  5
-#elif defined(INT3_vect)
-    #define EXT_INT_COUNT  4
-#elif defined(INT2_vect)
-    #define EXT_INT_COUNT  3
-#elif defined(INT1_vect)
-    #define EXT_INT_COUNT  2
-#elif defined(INT0_vect)
-    #define EXT_INT_COUNT  1
-#else
-    #error "There are no external Interrupts. Don't use this module"
+//////////////////////////////////////////////////////////////////////////
+// Handler-table and Interrupt-Service-Routines
+//////////////////////////////////////////////////////////////////////////
+
+//The handlers set with setExtIntHandler
+static ExtIntCallback _extIntHandlers[EXT_INT_COUNT];
+
+//The event-queue, and a Bit for each external Interrupt, whose events are
+//put into it
+static RingBuffer<ExtIntEvent, EXTINT_EVENT_QUEUE_SIZE> _extIntEvents;
+static uint8_t _extIntQueueingMask;
+
+//A Bit for each external Interrupt, whose events get a timestamp, and the
+//timestamp of the latest event
+static uint8_t _extIntTimestampingMask;
+static volatile uint32_t _extIntTimestamps[EXT_INT_COUNT];
+
+//The lockout-time (in ticks) of each external Interrupt (0: no lockout),
+//the remaining ticks of running lockouts, and a Bit for each running lockout
+static uint8_t _extIntLockoutTicks[EXT_INT_COUNT];
+static uint8_t _extIntLockoutCounters[EXT_INT_COUNT];
+volatile uint8_t _extIntLockedMask;
+
+//Reads the timestamp of an Interrupt-event. This version is weak and
+//returns 0: Timebase.cpp replaces it with one, that reads the timebase. So
+//this module doesn't depend on Timebase.cpp (and its Overflow-ISR), if
+//timestamping isn't used.
+extern "C" uint32_t _extIntTimestamp( void ) __attribute__((weak));
+uint32_t _extIntTimestamp( void )
+{
+    return 0;
+}
+
+//Marks the wake-up for the statistics of the event-loop (see EventLoop.h).
+//A weak reference: without EventLoop.cpp its address is 0.
+extern "C" void markEventLoopWake( void ) __attribute__((weak));
+
+static inline void _dispatchExtInt( uint8_t extIntNumber )
+{
+    //first of all, so that the time between the event and the timestamp is
+    //the same, whatever else is done
+    uint32_t timestamp = 0;
+    if (_extIntTimestampingMask & (0x01<<extIntNumber))
+    {
+        timestamp = _extIntTimestamp();
+        _extIntTimestamps[extIntNumber] = timestamp;
+    }
+    if (markEventLoopWake) markEventLoopWake();
+
+    if (_extIntQueueingMask & (0x01<<extIntNumber))
+    {
+        ExtIntEvent event;
+        event.extIntNumber = extIntNumber;
+        event.timestamp = timestamp;
+        _extIntEvents.push( event );
+    }
+
+    //lockout: no more Interrupt-events, until tickExtIntLockouts re-enables
+    //the external Interrupt
+    uint8_t lockoutTicks = _extIntLockoutTicks[extIntNumber];
+    if (lockoutTicks)
+    {
+        EIMSK &= ~(0x01<<extIntNumber);
+        _extIntLockoutCounters[extIntNumber] = lockoutTicks;
+        _extIntLockedMask |= (0x01<<extIntNumber);
+    }
+
+    ExtIntCallback handler = _extIntHandlers[extIntNumber];
+    if (handler) handler();
+}
+
+//The Interrupt-Service-Routines are weak, so that an Interrupt-Service-Routine
+//written by the user (with the ISR-Macro or EXTINT_HANDLER) replaces them.
+#define _EXTINT_WEAK   __attribute__((weak))
+
+ISR(INT0_vect, _EXTINT_WEAK) { _dispatchExtInt(0); }
+#if EXT_INT_COUNT > 1
+ISR(INT1_vect, _EXTINT_WEAK) { _dispatchExtInt(1); }
+#endif
+#if EXT_INT_COUNT > 2
+ISR(INT2_vect, _EXTINT_WEAK) { _dispatchExtInt(2); }
+#endif
+#if EXT_INT_COUNT > 3
+ISR(INT3_vect, _EXTINT_WEAK) { _dispatchExtInt(3); }
+#endif
+#if EXT_INT_COUNT > 4
+ISR(INT4_vect, _EXTINT_WEAK) { _dispatchExtInt(4); }
+#endif
+#if EXT_INT_COUNT > 5
+ISR(INT5_vect, _EXTINT_WEAK) { _dispatchExtInt(5); }
+#endif
+#if EXT_INT_COUNT > 6
+ISR(INT6_vect, _EXTINT_WEAK) { _dispatchExtInt(6); }
+#endif
+#if EXT_INT_COUNT > 7
+ISR(INT7_vect, _EXTINT_WEAK) { _dispatchExtInt(7); }
 #endif
 
 //////////////////////////////////////////////////////////////////////////
@@ -92,15 +172,108 @@ void enableExtInt( uint8_t extIntNumber )
 void disableExtInt( uint8_t extIntNumber )
 {
     if (extIntNumber >= EXT_INT_COUNT) return;
+    uint8_t sreg = SREG;
+    cli();
     EIMSK &=~ (0x01<<extIntNumber);
+    //a running lockout must not enable it again
+    _extIntLockedMask &= ~(0x01<<extIntNumber);
+    SREG = sreg;
 }
 
 void clearPendingExtIntEvent( uint8_t extIntNumber )
 {
     if (extIntNumber >= EXT_INT_COUNT) return;   
     //To clear a pending interrupt, must write 1 to the interrupt-flag
-    //This is called "write 1 to clear"
-    EIFR |= (0x01<<extIntNumber);
+    //This is called "write 1 to clear". The 0-Bits don't change the other
+    //flags (EIFR |= ... would write back and clear all pending flags).
+    EIFR = (0x01<<extIntNumber);
+}
+
+void setExtIntHandler( uint8_t extIntNumber, ExtIntCallback handler )
+{
+    if (extIntNumber >= EXT_INT_COUNT) return;
+
+    //a function-pointer has two bytes: change it with interrupts disabled
+    uint8_t sreg = SREG;
+    cli();
+    _extIntHandlers[extIntNumber] = handler;
+    SREG = sreg;
+}
+
+void setExtIntQueueing( uint8_t extIntNumber, bool onOff )
+{
+    if (extIntNumber >= EXT_INT_COUNT) return;
+
+    uint8_t sreg = SREG;
+    cli();
+    if (onOff) _extIntQueueingMask |=  (0x01<<extIntNumber);
+    else       _extIntQueueingMask &= ~(0x01<<extIntNumber);
+    SREG = sreg;
+}
+
+void setExtIntTimestamping( uint8_t extIntNumber, bool onOff )
+{
+    if (extIntNumber >= EXT_INT_COUNT) return;
+
+    uint8_t sreg = SREG;
+    cli();
+    if (onOff) _extIntTimestampingMask |=  (0x01<<extIntNumber);
+    else       _extIntTimestampingMask &= ~(0x01<<extIntNumber);
+    SREG = sreg;
+}
+
+uint32_t getExtIntTimestamp( uint8_t extIntNumber )
+{
+    if (extIntNumber >= EXT_INT_COUNT) return 0;
+
+    //a 32-bit-value is read with four instructions, and the
+    //Interrupt-Service-Routine may change it in between
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t timestamp = _extIntTimestamps[extIntNumber];
+    SREG = sreg;
+    return timestamp;
+}
+
+void setExtIntLockout( uint8_t extIntNumber, uint8_t lockoutTicks )
+{
+    if (extIntNumber >= EXT_INT_COUNT) return;
+    _extIntLockoutTicks[extIntNumber] = lockoutTicks;
+}
+
+void tickExtIntLockouts( void )
+{
+    //fast path: usually no lockout is running
+    if (_extIntLockedMask == 0) return;
+
+    uint8_t sreg = SREG;
+    cli();
+    for (uint8_t extIntNumber = 0; extIntNumber < EXT_INT_COUNT; extIntNumber++)
+    {
+        if ((_extIntLockedMask & (0x01<<extIntNumber)) == 0) continue;
+        if (--_extIntLockoutCounters[extIntNumber] != 0) continue;
+
+        //lockout is over: forget the bounces, that happened during it
+        _extIntLockedMask &= ~(0x01<<extIntNumber);
+        clearPendingExtIntEvent( extIntNumber );
+        enableExtInt( extIntNumber );
+    }
+    SREG = sreg;
+}
+
+bool readExtIntEvent( ExtIntEvent* event )
+{
+    return _extIntEvents.pop( *event );
+}
+
+bool hasExtIntEvent( void )
+{
+    return !_extIntEvents.isEmpty();
+}
+
+uint8_t getExtIntEventDropCount( void )
+{
+    return _extIntEvents.getDropCount();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -24,6 +24,12 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "SFR.h"
+#include "GPIO.h"
+#include "MCUCapabilities.h"
 
 
 #ifdef __cplusplus
@@ -44,6 +50,58 @@ extern "C" {
 #define EXTINT_FALLING_EDGE             0x02
 #define EXTINT_RISING_EDGE              0x03  
 
+/**
+ * Number of external Interrupts of the microcontroller (8 on the ATmega2560:
+ * INT0 ... INT7, 2 on the ATmega328p: INT0 and INT1).
+ */
+#if defined(INT7_vect)
+    #define EXT_INT_COUNT  8
+#elif defined(INT6_vect)
+    #define EXT_INT_COUNT  7
+#elif defined(INT5_vect)
+    #define EXT_INT_COUNT  6
+#elif defined(INT4_vect)
+    #define EXT_INT_COUNT  5
+#elif defined(INT3_vect)
+    #define EXT_INT_COUNT  4
+#elif defined(INT2_vect)
+    #define EXT_INT_COUNT  3
+#elif defined(INT1_vect)
+    #define EXT_INT_COUNT  2
+#elif defined(INT0_vect)
+    #define EXT_INT_COUNT  1
+#else
+    #error "There are no external Interrupts. Don't use this module"
+#endif
+
+/**
+ * A handler for an external Interrupt is a function without parameters and
+ * return-value. It is called from the Interrupt-Service-Routine, so it runs
+ * with interrupts disabled and should be short.
+ */
+typedef void (*ExtIntCallback)( void );
+
+/**
+ * An Interrupt-event of an external Interrupt, as stored in the event-queue
+ * (see `setExtIntQueueing`).
+ */
+typedef struct
+{
+    uint8_t extIntNumber;   // the number of the external Interrupt
+    uint32_t timestamp;     // ticks of the timebase (see Timebase.h) at the
+                            // start of the Interrupt-Service-Routine, if
+                            // timestamping is on (otherwise 0)
+} ExtIntEvent;
+
+/**
+ * Capacity of the event-queue (a power of two between 2 and 128). Define it
+ * with another value when compiling ExternalInterrupts.cpp, if bursts of
+ * more events must be queued.
+ */
+#ifndef EXTINT_EVENT_QUEUE_SIZE
+#define EXTINT_EVENT_QUEUE_SIZE     16
+#endif
+
 
 //////////////////////////////////////////////////////////////////////////
 // C-Function-API
@@ -79,8 +137,15 @@ void setExtIntEventType( uint8_t extIntNumber, uint8_t extIntEventType );
  * Interrupt-Service-Routine is executed, each time an external 
  * Interrupt-event happens.
  *
- * You have to implement the Interrupt-Service-Routine using the ISR-Macro
- * from <avr/interrupt.h> with the correct Interrupt-vector (`INTx_vect`).
+ * There are three ways to provide the code, that is executed on an
+ * Interrupt-event:
+ *  - Register a handler-function with `setExtIntHandler`. This can be
+ *    changed at runtime.
+ *  - Use the macro `EXTINT_HANDLER` (C++ only). The handler is bound at 
+ *    compile-time and called without the table-lookup and the indirect
+ *    call (a few cycles less latency).
+ *  - Implement the Interrupt-Service-Routine yourself using the ISR-Macro
+ *    from <avr/interrupt.h> with the correct Interrupt-vector (`INTx_vect`).
  *
  * @param extIntNumber The Number of the external Interrupt
  */
@@ -109,6 +174,128 @@ void disableExtInt( uint8_t extIntNumber );
  */
 void clearPendingExtIntEvent( uint8_t extIntNumber );
 
+/**
+ * Sets the function, that is called, each time an Interrupt-event of an 
+ * external Interrupt happens (while the external Interrupt is enabled).
+ *
+ * This module contains an Interrupt-Service-Routine for each `INTx_vect`,
+ * that calls the function from a table of handlers. These 
+ * Interrupt-Service-Routines are "weak": If you implement the
+ * Interrupt-Service-Routine for an `INTx_vect` yourself (with the ISR-Macro
+ * or with `EXTINT_HANDLER`), your Interrupt-Service-Routine is used, and
+ * a handler set with this function is never called.
+ *
+ * Because of the table-lookup and the indirect function-call (and because
+ * the Interrupt-Service-Routine must save all registers, that the called
+ * function may change), this costs a few cycles more than an
+ * Interrupt-Service-Routine written with `EXTINT_HANDLER`.
+ *
+ * @param extIntNumber The Number of the external Interrupt
+ * @param handler The function to call, or 0 for no function
+ */
+void setExtIntHandler( uint8_t extIntNumber, ExtIntCallback handler );
+
+/**
+ * Turns on or off the event-queue for an external Interrupt. If it is on,
+ * the Interrupt-Service-Routine of this module (see `setExtIntHandler`) puts
+ * an `ExtIntEvent` into a queue each time an Interrupt-event happens (before
+ * calling the handler, if there is one). The main-loop takes the events out
+ * of the queue with `readExtIntEvent`, without disabling interrupts. So 
+ * bursts of events are not lost, even if the main-loop is busy for a while.
+ * The events of all external Interrupts share one queue with
+ * `EXTINT_EVENT_QUEUE_SIZE` places.
+ *
+ * @param extIntNumber The Number of the external Interrupt
+ * @param onOff true to put events into the queue, false to stop it.
+ */
+void setExtIntQueueing( uint8_t extIntNumber, bool onOff );
+
+/**
+ * Turns on or off timestamping for an external Interrupt. If it is on, the
+ * Interrupt-Service-Routine of this module (see `setExtIntHandler`) reads the
+ * tick-counter of the timebase (`readTimebaseTicks`, see Timebase.h) as its
+ * first action, each time an Interrupt-event happens. The timestamp is put
+ * into the queued `ExtIntEvent` and can be read by the handler with
+ * `getExtIntTimestamp`. So pulse-widths and periods can be measured with the
+ * resolution of the timebase (0.5 microseconds at 16MHz), without an own
+ * Timer-Interrupt-Service-Routine.
+ *
+ * The timebase must have been started with `initTimebase`, and Timebase.cpp
+ * must be compiled and linked with the program, otherwise all timestamps are
+ * 0. ExternalInterrupts.cpp itself doesn't need Timebase.cpp, so a program
+ * without timestamps doesn't have to link it (and Timer/Counter1 stays free).
+ *
+ * @param extIntNumber The Number of the external Interrupt
+ * @param onOff true to take timestamps, false to stop it.
+ */
+void setExtIntTimestamping( uint8_t extIntNumber, bool onOff );
+
+/**
+ * Returns the timestamp (ticks of the timebase) of the latest Interrupt-event
+ * of an external Interrupt, if timestamping is on. Intended to be called in
+ * the handler (see `setExtIntHandler`); in the main-loop the timestamps of
+ * the event-queue are more reliable, because the next event may already
+ * have overwritten the latest timestamp.
+ *
+ * @param extIntNumber The Number of the external Interrupt
+ */
+uint32_t getExtIntTimestamp( uint8_t extIntNumber );
+
+/**
+ * Sets a lockout-time for an external Interrupt, to get a single clean
+ * Interrupt-event from a bouncing button or switch. Each time an
+ * Interrupt-event happens, the Interrupt-Service-Routine of this module (see
+ * `setExtIntHandler`) disables the external Interrupt (after queueing the
+ * event, and before calling the handler). The following `lockoutTicks`
+ * calls of `tickExtIntLockouts` count down the lockout, then the Interrupt-
+ * events during the lockout (the bounces) are cleared with
+ * `clearPendingExtIntEvent`, and the external Interrupt is enabled again.
+ *
+ * So a bouncing contact causes one Interrupt-event instead of dozens, and
+ * no CPU-time is spent on the bounces. For example with 
+ * `tickExtIntLockouts` called every millisecond, 20 ticks are a good
+ * lockout-time for most buttons.
+ *
+ * `disableExtInt` stops a running lockout (the external Interrupt remains
+ * disabled). The lockout doesn't work with an own Interrupt-Service-Routine
+ * (ISR-Macro or EXTINT_HANDLER).
+ *
+ * @param extIntNumber The Number of the external Interrupt
+ * @param lockoutTicks The lockout-time in calls of `tickExtIntLockouts`
+ *      (1...255), or 0 to turn off the lockout.
+ */
+void setExtIntLockout( uint8_t extIntNumber, uint8_t lockoutTicks );
+
+/**
+ * Counts down the running lockouts (see `setExtIntLockout`) and enables the
+ * external Interrupts, whose lockout is over. Call it in regular intervals,
+ * for example every millisecond from a Timer-Interrupt-Service-Routine or
+ * from the main-loop. If no lockout is running, it returns immediately.
+ */
+void tickExtIntLockouts( void );
+
+/**
+ * Takes the oldest event out of the event-queue. Must only be called from
+ * one place (normally the main-loop), not from an Interrupt-Service-Routine.
+ *
+ * @param event Receives the event.
+ * @return true, if an event has been taken, false if the queue is empty.
+ */
+bool readExtIntEvent( ExtIntEvent* event );
+
+/**
+ * Returns true, if the event-queue is not empty. Can be used with
+ * interrupts disabled, for example as pending-check of an event-loop (see
+ * EventLoop.h).
+ */
+bool hasExtIntEvent( void );
+
+/**
+ * Returns the number of events, that have been lost, because the 
+ * event-queue was full (counts up to 255).
+ */
+uint8_t getExtIntEventDropCount( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -139,6 +326,29 @@ public:
      */
      ExtInt( uint8_t extIntNumber, uint8_t extIntEventType,
     		 bool enabled = true );
+
+    /**
+     * Constructor for the external Interrupt on a GPIO-Pin (for example INT2
+     * for PD2 on the ATmega2560, INT0 for PD2 on the ATmega328p). The pin is
+     * programmed to be an input (with pullup-resistor, if requested) before
+     * the external Interrupt is enabled. If the pin has no external
+     * Interrupt, the object is invalid and all methods do nothing.
+     *
+     * For example a button between PD2 and GND:
+     * {@code
+     *     ExtInt button = ExtInt( GPIOPin(port_D, 2), EXTINT_FALLING_EDGE,
+     *                             PULLUP_ON );
+     * }
+     *
+     * @param pin The GPIO-Pin
+     * @param extIntEventType see the other constructor
+     * @param pullup `PULLUP_ON` or `PULLUP_OFF` (default)
+     * @param enabled see the other constructor. Default-Value: true.
+     */
+    ExtInt( const GPIOPin& pin, uint8_t extIntEventType,
+            uint8_t pullup = PULLUP_OFF, bool enabled = true )
+        : ExtInt( _configurePin( pin.getPort(), pin.getPinNumber(), pullup ),
+                  extIntEventType, enabled ) { }
     
     /**
      * This method defines, which voltage-change-Events on an INTx-Pin actually
@@ -160,9 +370,12 @@ public:
 	 * Interrupt-Service-Routine is executed, each time an external
 	 * Interrupt-event happens.
 	 *
-	 * You have to implement the Interrupt-Service-Routine using the
-	 * ISR-Macro from <avr/interrupt.h> with the correct
-	 * Interrupt-vector (`INTx_vect`).
+	 * The code executed on an Interrupt-event is a handler registered with
+	 * `setExtIntHandler`, a handler bound with the macro `EXTINT_HANDLER`
+	 * (C++ only), or an Interrupt-Service-Routine for `INTx_vect`
+	 * implemented with the ISR-Macro from <avr/interrupt.h>. The last two
+	 * replace the weak Interrupt-Service-Routine of this module. See
+	 * C-function `enableExtInt`.
      */
     void enableExtInt()
     { ::enableExtInt( _extIntNumber ); }
@@ -184,10 +397,252 @@ public:
         ::clearPendingExtIntEvent(_extIntNumber);
     }
 
+    /**
+     * Sets the function, that is called, each time an Interrupt-event
+     * happens. See C-function `setExtIntHandler`.
+     *
+     * @param handler The function to call, or 0 for no function
+     */
+    void setExtIntHandler( ExtIntCallback handler )
+    {
+        ::setExtIntHandler(_extIntNumber, handler);
+    }
+
+    /**
+     * Turns on or off putting the Interrupt-events into the event-queue.
+     * See C-function `setExtIntQueueing`.
+     *
+     * @param onOff true to put events into the queue, false to stop it.
+     */
+    void setExtIntQueueing( bool onOff )
+    {
+        ::setExtIntQueueing(_extIntNumber, onOff);
+    }
+
+    /**
+     * Turns on or off timestamping of the Interrupt-events. See C-function
+     * `setExtIntTimestamping`.
+     *
+     * @param onOff true to take timestamps, false to stop it.
+     */
+    void setExtIntTimestamping( bool onOff )
+    {
+        ::setExtIntTimestamping(_extIntNumber, onOff);
+    }
+
+    /**
+     * Returns the timestamp of the latest Interrupt-event. See C-function
+     * `getExtIntTimestamp`.
+     */
+    uint32_t getExtIntTimestamp()
+    {
+        return ::getExtIntTimestamp(_extIntNumber);
+    }
+
+    /**
+     * Sets the lockout-time after each Interrupt-event, to debounce a
+     * button or switch. See C-function `setExtIntLockout`.
+     *
+     * @param lockoutTicks The lockout-time in calls of `tickExtIntLockouts`,
+     *      or 0 to turn off the lockout.
+     */
+    void setExtIntLockout( uint8_t lockoutTicks )
+    {
+        ::setExtIntLockout(_extIntNumber, lockoutTicks);
+    }
+
 private:
+    //Programs the pin to be an input, and returns the number of its
+    //external Interrupt (0xFF, if it has none). The lookup is computed by
+    //the compiler, if port and pinNumber are constants.
+    static uint8_t _configurePin( uint8_t port, uint8_t pinNumber,
+                                  uint8_t pullup )
+    {
+        uint8_t extIntNumber = mcuExtIntNumberForPin( port, pinNumber );
+        if (extIntNumber < EXT_INT_COUNT)
+        {
+            ::setPinMode( port, pinNumber, MODE_INPUT );
+            ::setPinPullup( port, pinNumber, pullup );
+        }
+        return extIntNumber;
+    }
+
     uint8_t _extIntNumber;
 };
 
+
+//////////////////////////////////////////////////////////////////////////
+// External Interrupts known at compile-time
+//////////////////////////////////////////////////////////////////////////
+
+static_assert( mcuExtIntCount() == EXT_INT_COUNT || mcuExtIntCount() == 0,
+               "MCUCapabilities.h doesn't match <avr/io.h>" );
+
+//A Bit for each running lockout (see `setExtIntLockout`). Only used by
+//`FastExtInt`.
+extern volatile uint8_t _extIntLockedMask;
+
+/**
+ * Template for an external Interrupt, whose number is known at
+ * compile-time. It has the same methods as `ExtInt` for the
+ * Special-Function-Registers, but without any checks at runtime: the
+ * registers and bit-masks are computed by the compiler, so for example
+ * `enableExtInt()` is a single `sbi`-instruction. An external Interrupt,
+ * that doesn't exist on the microcontroller, results in a compile-error
+ * (see MCUCapabilities.h).
+ *
+ * Handlers, queueing, timestamping and lockouts are set with the
+ * C-functions or an `ExtInt`-instance, because they are not in the hot path.
+ *
+ * For example:
+ * {@code
+ *     FastExtInt<2>::setExtIntEventType( EXTINT_FALLING_EDGE );
+ *     FastExtInt<2>::clearPendingExtIntEvent();
+ *     FastExtInt<2>::enableExtInt();
+ * }
+ */
+template<uint8_t extIntNumber>
+class FastExtInt
+{
+    static_assert( extIntNumber < EXT_INT_COUNT,
+                   "This external Interrupt doesn't exist" );
+    static_assert( mcuExtIntCount() == 0 || mcuExtIntExists( extIntNumber ),
+                   "This external Interrupt doesn't exist" );
+
+public:
+    /**
+     * Constructor. See the constructor of `ExtInt`.
+     */
+    FastExtInt( uint8_t extIntEventType, bool enabled = true )
+    {
+        disableExtInt();
+        setExtIntEventType( extIntEventType );
+        clearPendingExtIntEvent();
+        if (enabled) enableExtInt();
+    }
+
+    /**
+     * Sets the voltage-change-Events, that cause an Interrupt-Event (one of
+     * the Macros EXTINT_LOW_LEVEL_ACTIVE, EXTINT_ANY_EDGE,
+     * EXTINT_FALLING_EDGE or EXTINT_RISING_EDGE).
+     */
+    static void setExtIntEventType( uint8_t extIntEventType )
+    {
+        sfr8_t& eicr = _EICR();
+        eicr = (eicr & (uint8_t)~(0x03 << _SHIFT))
+               | ((extIntEventType & 0x03) << _SHIFT);
+    }
+
+    /**
+     * Enables the external Interrupt.
+     */
+    static void enableExtInt()
+    {
+        EIMSK |= _MASK;
+    }
+
+    /**
+     * Disables the external Interrupt (and stops a running lockout).
+     */
+    static void disableExtInt()
+    {
+        uint8_t sreg = SREG;
+        cli();
+        EIMSK &= (uint8_t)~_MASK;
+        _extIntLockedMask &= (uint8_t)~_MASK;
+        SREG = sreg;
+    }
+
+    /**
+     * Clears a pending Interrupt-event (write 1 to clear).
+     */
+    static void clearPendingExtIntEvent()
+    {
+        EIFR = _MASK;
+    }
+
+    /**
+     * Programs the pin of the external Interrupt (for example PD2 for INT2
+     * on the ATmega2560) to be an input.
+     *
+     * @param pullup `PULLUP_ON` or `PULLUP_OFF`
+     */
+    static void configurePin( uint8_t pullup )
+    {
+        typedef FastPin< mcuExtIntPort( extIntNumber ),
+                         mcuExtIntPinNumber( extIntNumber ) > Pin;
+        Pin::setPinMode( MODE_INPUT );
+        Pin::setPinPullup( pullup );
+    }
+
+private:
+    static const uint8_t _MASK = 0x01 << extIntNumber;
+    static const uint8_t _SHIFT = (extIntNumber & 0x03) * 2;
+
+    //ISCn1:0 of INT0...INT3 are in EICRA, of INT4...INT7 in EICRB
+    static sfr8_t& _EICR()
+    {
+#ifdef EICRB
+        if (extIntNumber >= 4) return EICRB;
+#endif
+        return EICRA;
+    }
+};
+
+
+/**
+ * `FastExtInt` for the external Interrupt on a GPIO-Pin, for example
+ * `FastExtIntOnPin<port_D, 2>` is `FastExtInt<2>` on the ATmega2560 and
+ * `FastExtInt<0>` on the ATmega328p. A pin without external Interrupt
+ * results in a compile-error.
+ */
+template<uint8_t port, uint8_t pinNumber>
+using FastExtIntOnPin = FastExtInt< mcuExtIntNumberForPin( port, pinNumber ) >;
+
+
+//////////////////////////////////////////////////////////////////////////
+// Handlers bound at compile-time
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Binds a handler-function to an external Interrupt at compile-time. The
+ * function is called directly (no table, no indirect call), and if it is
+ * defined in the same file and short, the compiler puts its code directly
+ * into the Interrupt-Service-Routine. Used by the macro `EXTINT_HANDLER`.
+ *
+ * Using an external Interrupt, that doesn't exist on the microcontroller,
+ * results in a compile-error.
+ */
+template<uint8_t extIntNumber, void (*handler)(void)>
+struct ExtIntHandler
+{
+    static_assert( extIntNumber < EXT_INT_COUNT,
+                   "This external Interrupt doesn't exist" );
+
+    static inline void invoke() __attribute__((always_inline))
+    {
+        handler();
+    }
+};
+
+/**
+ * Generates the Interrupt-Service-Routine for external Interrupt INT<n>,
+ * that calls `handler` (see `ExtIntHandler`). `n` must be a number (not a
+ * variable or an expression), because the name of the Interrupt-vector
+ * is built from it. Use it outside of any function, for example:
+ * {@code
+ *     void onButton() { counter++; }
+ *     EXTINT_HANDLER( 2, onButton )
+ * }
+ * This replaces the Interrupt-Service-Routine of this module, so a handler
+ * set with `setExtIntHandler` for this external Interrupt is ignored.
+ */
+#define EXTINT_HANDLER(n, handler)                                      \
+    ISR(INT ## n ## _vect)                                              \
+    {                                                                   \
+        ExtIntHandler< n, handler >::invoke();                          \
+    }
+
 #endif
 
 
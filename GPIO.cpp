@@ -19,6 +19,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
 #include "GPIO.h"
 
 ////////////////////////////////////////////////////////////////
@@ -31,6 +34,215 @@ void _togglePORTBit( uint8_t port, uint8_t bitNumber );
 uint8_t _getPINBit(uint8_t port, uint8_t bitNumber);
 
 
+////////////////////////////////////////////////////////////////
+// Table of the Special-Function-Registers of each port
+////////////////////////////////////////////////////////////////
+
+//The addresses of the registers PINx, DDRx and PORTx of each port. The
+//table is indexed by the port-number (port_A ... port_L) and stored in flash
+//(PROGMEM). So each function finds the registers of a port with a few
+//instructions, that take the same time for all ports (instead of a switch
+//with 12 cases in each function). Ports, that don't exist on the
+//microcontroller have null-pointers.
+typedef struct
+{
+    sfr8_t* pin;
+    sfr8_t* ddr;
+    sfr8_t* port;
+} _PortRegisters;
+
+static const _PortRegisters _portRegisters[GPIO_PORT_COUNT] PROGMEM =
+{
+    #ifdef PORTA
+    { &PINA, &DDRA, &PORTA },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTB
+    { &PINB, &DDRB, &PORTB },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTC
+    { &PINC, &DDRC, &PORTC },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTD
+    { &PIND, &DDRD, &PORTD },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTE
+    { &PINE, &DDRE, &PORTE },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTF
+    { &PINF, &DDRF, &PORTF },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTG
+    { &PING, &DDRG, &PORTG },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTH
+    { &PINH, &DDRH, &PORTH },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTI
+    { &PINI, &DDRI, &PORTI }, //port I does not exist on any AVR
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTJ
+    { &PINJ, &DDRJ, &PORTJ },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTK
+    { &PINK, &DDRK, &PORTK },
+    #else
+    { 0, 0, 0 },
+    #endif
+    #ifdef PORTL
+    { &PINL, &DDRL, &PORTL },
+    #else
+    { 0, 0, 0 },
+    #endif
+};
+
+//Bit-masks for pin-numbers 0...7. An AVR has no barrel-shifter, so
+//(0x01<<bitNumber) would be a loop, whose duration depends on bitNumber.
+static const uint8_t _pinMasks[8] PROGMEM =
+{
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+};
+
+sfr8_t* _getPINRegister( uint8_t port )
+{
+    if (port >= GPIO_PORT_COUNT) return 0;
+    return (sfr8_t*) pgm_read_ptr( &_portRegisters[port].pin );
+}
+
+sfr8_t* _getDDRRegister( uint8_t port )
+{
+    if (port >= GPIO_PORT_COUNT) return 0;
+    return (sfr8_t*) pgm_read_ptr( &_portRegisters[port].ddr );
+}
+
+sfr8_t* _getPORTRegister( uint8_t port )
+{
+    if (port >= GPIO_PORT_COUNT) return 0;
+    return (sfr8_t*) pgm_read_ptr( &_portRegisters[port].port );
+}
+
+
+////////////////////////////////////////////////////////////////
+// Shadow-Registers
+////////////////////////////////////////////////////////////////
+
+#ifdef GPIO_SHADOW_REGISTERS
+
+//RAM-copies of the DDRx- and PORTx-Registers, indexed by the port-number.
+//0 is the reset-value of the registers.
+static uint8_t _ddrShadows[GPIO_PORT_COUNT];
+static uint8_t _portShadows[GPIO_PORT_COUNT];
+
+//Clears the bits `clear` and sets the bits `set` of the copy, and stores the
+//result into the register (which is never read).
+static void _writeShadowed( sfr8_t* reg, uint8_t* shadow, uint8_t clear,
+                            uint8_t set )
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t value = (*shadow & ~clear) | set;
+    *shadow = value;
+    *reg = value;
+    SREG = sreg;
+}
+
+void resyncGPIOShadowRegisters( uint8_t port )
+{
+    sfr8_t* ddr = _getDDRRegister(port);
+    if (!ddr) return;
+
+    uint8_t sreg = SREG;
+    cli();
+    _ddrShadows[port] = *ddr;
+    _portShadows[port] = *_getPORTRegister(port);
+    SREG = sreg;
+}
+
+#else
+
+void resyncGPIOShadowRegisters( uint8_t port )
+{
+    (void)port;
+}
+
+#endif
+
+void resyncAllGPIOShadowRegisters( void )
+{
+    for (uint8_t port = 0; port < GPIO_PORT_COUNT; port++)
+    {
+        resyncGPIOShadowRegisters( port );
+    }
+}
+
+//Clears the bits `clear` and sets the bits `set` of the DDRx- or
+//PORTx-Register of a port: one read-modify-write, or a store of the
+//changed RAM-copy with GPIO_SHADOW_REGISTERS
+static inline void _modifyDDR( uint8_t port, sfr8_t* ddr, uint8_t clear,
+                               uint8_t set )
+{
+#ifdef GPIO_SHADOW_REGISTERS
+    _writeShadowed( ddr, &_ddrShadows[port], clear, set );
+#else
+    (void)port;
+    *ddr = (*ddr & ~clear) | set;
+#endif
+}
+
+static inline void _modifyPORT( uint8_t port, sfr8_t* portReg, uint8_t clear,
+                                uint8_t set )
+{
+#ifdef GPIO_SHADOW_REGISTERS
+    _writeShadowed( portReg, &_portShadows[port], clear, set );
+#else
+    (void)port;
+    *portReg = (*portReg & ~clear) | set;
+#endif
+}
+
+void _modifyDDRRegister( uint8_t port, sfr8_t* ddr, uint8_t clear,
+                         uint8_t set )
+{
+    _modifyDDR( port, ddr, clear, set );
+}
+
+void _modifyPORTRegister( uint8_t port, sfr8_t* portReg, uint8_t clear,
+                          uint8_t set )
+{
+    _modifyPORT( port, portReg, clear, set );
+}
+
+uint8_t* _getPORTShadow( uint8_t port )
+{
+#ifdef GPIO_SHADOW_REGISTERS
+    if (port >= GPIO_PORT_COUNT) return 0;
+    return &_portShadows[port];
+#else
+    (void)port;
+    return 0;
+#endif
+}
+
+
 ////////////////////////////////////////////////////////////////
 // C-API Functions for single Pins
 ////////////////////////////////////////////////////////////////
@@ -99,453 +311,58 @@ void togglePin( uint8_t port, uint8_t pinNumber )
 
 void setPortMode ( uint8_t port, uint8_t mode, uint8_t mask )
 {
+    sfr8_t* ddr = _getDDRRegister(port);
+    if (!ddr) return; //port doesn't exist
 
-    //Ugly code, but macros must be avoided (beginners can't find the correct
-    //location of syntax-errors, when macros are used.
-    switch ( port )
-    {
-        case port_A:
-            #ifdef DDRA
-            DDRA |= mask & mode;
-            DDRA &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_B:
-            #ifdef DDRB
-            DDRB |= mask & mode;
-            DDRB &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_C:
-            #ifdef DDRC
-            DDRC |= mask & mode;
-            DDRC &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_D:
-            #ifdef DDRD
-            DDRD |= mask & mode;
-            DDRD &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_E:
-            #ifdef DDRE
-            DDRE |= mask & mode;
-            DDRE &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_F:
-            #ifdef DDRF
-            DDRF |= mask & mode;
-            DDRF &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_G:
-            #ifdef DDRG
-            DDRG |= mask & mode;
-            DDRG &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_H:
-            #ifdef DDRH
-            DDRH |= mask & mode;
-            DDRH &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_I: //I think, that port I does not exist on any AVR
-            #ifdef DDRI
-            DDRI |= mask & mode;
-            DDRI &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_J:
-            #ifdef DDRJ
-            DDRJ |= mask & mode;
-            DDRJ &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_K:
-            #ifdef DDRK
-            DDRK |= mask & mode;
-            DDRK &= ~(mask & ~mode);
-            #endif
-            return;
-
-        case port_L:
-            #ifdef DDRL
-            DDRL |= mask & mode;
-            DDRL &= ~(mask & ~mode);
-            #endif
-            return;
-
-        default:
-            break;
-    }
+    //clear the masked Bits, then set the 1-Bits
+    _modifyDDR(port, ddr, mask, mode & mask);
 }
 
 
 void setPortPullup( uint8_t port, uint8_t pullup, uint8_t mask )
 {
-    switch ( port )
-    {
-        case port_A:
-            #ifdef PORTA
-            PORTA |= mask & pullup;
-            PORTA &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        case port_B:
-            #ifdef PORTB
-            PORTB |= mask & pullup;
-            PORTB &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        case port_C:
-            #ifdef PORTC
-            PORTC |= mask & pullup;
-            PORTC &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        case port_D:
-            #ifdef PORTD
-            PORTD |= mask & pullup;
-            PORTD &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        case port_E:
-            #ifdef PORTE
-            PORTE |= mask & pullup;
-            PORTE &= ~(mask & ~pullup);
-            #endif
-            return;
+    sfr8_t* portReg = _getPORTRegister(port);
+    if (!portReg) return;
 
-        case port_F:
-            #ifdef PORTF
-            PORTF |= mask & pullup;
-            PORTF &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        case port_G:
-            #ifdef PORTG
-            PORTG |= mask & pullup;
-            PORTG &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        case port_H:
-            #ifdef PORTH
-            PORTH |= mask & pullup;
-            PORTH &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        case port_I: //I think, that port I does not exist on any AVR
-             #ifdef PORTI
-            PORTI|= mask & pullup;
-            PORTI &= ~(mask & ~pullup);
-            #endif
-            return;
- 
-        case port_J:
-            #ifdef PORTJ
-            PORTJ |= mask & pullup;
-            PORTJ &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        case port_K:
-            #ifdef PORTK
-            PORTK |= mask & pullup;
-            PORTK &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        case port_L:
-            #ifdef PORTL
-            PORTL |= mask & pullup;
-            PORTL &= ~(mask & ~pullup);
-            #endif
-            return;
-
-        default:
-            break;
-    }
+    _modifyPORT(port, portReg, mask, pullup & mask);
 }
 
 
-
 void writePort( uint8_t port, uint8_t voltageLevels, uint8_t mask )
 {
-    switch ( port )
-    {
-        case port_A:
-            #ifdef PORTA
-            PORTA |= mask & voltageLevels;
-            PORTA &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_B:
-            #ifdef PORTB
-            PORTB |= mask & voltageLevels;
-            PORTB &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_C:
-            #ifdef PORTC
-            PORTC |= mask & voltageLevels;
-            PORTC &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_D:
-            #ifdef PORTD
-            PORTD |= mask & voltageLevels;
-            PORTD &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_E:
-            #ifdef PORTE
-            PORTE |= mask & voltageLevels;
-            PORTE &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_F:
-            #ifdef PORTF
-            PORTF |= mask & voltageLevels;
-            PORTF &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_G:
-            #ifdef PORTG
-            PORTG |= mask & voltageLevels;
-            PORTG &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_H:
-            #ifdef PORTH
-            PORTH |= mask & voltageLevels;
-            PORTH &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_I: //I think, that port I does not exist on any AVR
-            #ifdef PORTI
-            PORTI |= mask & voltageLevels;
-            PORTI &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_J:
-            #ifdef PORTJ
-            PORTJ |= mask & voltageLevels;
-            PORTJ &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_K:
-            #ifdef PORTK
-            PORTK |= mask & voltageLevels;
-            PORTK &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        case port_L:
-            #ifdef PORTL
-            PORTL |= mask & voltageLevels;
-            PORTL &= ~(mask & ~voltageLevels);
-            #endif
-            return;
-
-        default:
-            break;
-    }
+    sfr8_t* portReg = _getPORTRegister(port);
+    if (!portReg) return;
 
+    _modifyPORT(port, portReg, mask, voltageLevels & mask);
 }
 
 
 void togglePort( uint8_t port, uint8_t mask )
 {
-    switch ( port )
-    {
-        case port_A:
-            #ifdef PORTA
-            PORTA ^= mask;
-            #endif
-            return;
-
-        case port_B:
-            #ifdef PORTB
-            PORTB ^= mask;
-            #endif
-            return;
-
-        case port_C:
-            #ifdef PORTC
-            PORTC ^= mask;
-            #endif
-            return;
-
-        case port_D:
-            #ifdef PORTD
-            PORTD ^= mask;
-            #endif
-            return;
-
-        case port_E:
-            #ifdef PORTE
-            PORTE ^= mask;
-            #endif
-            return;
-
-        case port_F:
-            #ifdef PORTF
-            PORTF ^= mask;
-            #endif
-            return;
-
-        case port_G:
-            #ifdef PORTG
-            PORTG ^= mask;
-            #endif
-            return;
-
-        case port_H:
-            #ifdef PORTH
-            PORTH ^= mask;
-            #endif
-            return;
-
-        case port_I: //I think, that port I does not exist on any AVR
-            #ifdef PORTI
-            PORTI ^= mask;
-            #endif
-            return;
-
-        case port_J:
-            #ifdef PORTJ
-            PORTJ ^= mask;
-            #endif
-            return;
-
-        case port_K:
-            #ifdef PORTK
-            PORTK ^= mask;
-            #endif
-            return;
-
-        case port_L:
-            #ifdef PORTL
-            PORTL ^= mask;
-            #endif
-            return;
-
-        default:
-            break;
-    }
+    sfr8_t* pin = _getPINRegister(port);
+    if (!pin) return;
+
+    //Writing a 1 to a Bit of PINx toggles the corresponding Bit of PORTx.
+    //This is a single store (no read-modify-write of PORTx), so an
+    //Interrupt-Service-Routine changing other Bits of PORTx can't interfere.
+#ifdef GPIO_SHADOW_REGISTERS
+    uint8_t sreg = SREG;
+    cli();
+    _portShadows[port] ^= mask;
+    *pin = mask;
+    SREG = sreg;
+#else
+    *pin = mask;
+#endif
 }
 
 
 uint8_t readPort( uint8_t port, uint8_t mask)
 {
-    switch ( port )
-    {
-        case port_A:
-            #ifdef PINA
-            return PINA & mask;
-            #endif
-            break;
-
-        case port_B:
-            #ifdef PINB
-            return PINB & mask;
-            #endif
-            break;
-
-        case port_C:
-            #ifdef PINC
-            return PINC & mask;
-            #endif
-            break;
-
-        case port_D:
-            #ifdef PIND
-            return PIND & mask;
-            #endif
-            break;
-
-        case port_E:
-            #ifdef PINE
-            return PINE & mask;
-            #endif
-            break;
-
-        case port_F:
-            #ifdef PINF
-            return PINF & mask;
-            #endif
-            break;
-
-        case port_G:
-            #ifdef PING
-            return PING & mask;
-            #endif
-            break;
-
-        case port_H:
-            #ifdef PINH
-            return PINH & mask;
-            #endif
-            break;
-
-        case port_I: //I think, that port I does not exist on any AVR
-            #ifdef PINI
-            return PINI & mask;
-            #endif
-            break;
-
-        case port_J:
-            #ifdef PINJ
-            return PINJ & mask;
-            #endif
-            break;
-
-        case port_K:
-            #ifdef PINK
-            return PINK & mask;
-            #endif
-            break;
+    sfr8_t* pin = _getPINRegister(port);
+    if (!pin) return 0;
 
-        case port_L:
-            #ifdef PINL
-            return PINL & mask;
-            #endif
-            break;
-
-        default:
-            break;
-    }
-    return 0;
+    return *pin & mask;
 }
 
 
@@ -558,95 +375,12 @@ uint8_t readPort( uint8_t port, uint8_t mask)
 //output. Writing a 0 to this Bit makes PB7 to an input
 void _setDDRBitValue( uint8_t port, uint8_t bitNumber, uint8_t bitValue)
 {
-    switch (port)
-    {
-        case port_A:
-            #ifdef DDRA
-            if (bitValue)  DDRA |=  (0x01<< bitNumber);
-            else           DDRA &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_B:
-            #ifdef DDRB
-            if (bitValue)  DDRB |=  (0x01<< bitNumber);
-            else           DDRB &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_C:
-            #ifdef DDRA
-            if (bitValue)  DDRC |=  (0x01<< bitNumber);
-            else           DDRC &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_D:
-            #ifdef DDRD
-            if (bitValue)  DDRD |=  (0x01<< bitNumber);
-            else           DDRD &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_E:
-            #ifdef DDRE
-            if (bitValue)  DDRE |=  (0x01<< bitNumber);
-            else           DDRE &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_F:
-            #ifdef DDRF
-            if (bitValue)  DDRF |=  (0x01<< bitNumber);
-            else           DDRF &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_G:
-            #ifdef DDRG
-            if (bitValue)  DDRG |=  (0x01<< bitNumber);
-            else           DDRG &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_H:
-            #ifdef DDRH
-            if (bitValue)  DDRH |=  (0x01<< bitNumber);
-            else           DDRH &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_I: //I think, Port I does not exist on any AVR
-            #ifdef DDRI
-            if (bitValue)  DDRI |=  (0x01<< bitNumber);
-            else           DDRI &= ~(0x01<< bitNumber);
-            #endif
-            return;
+    sfr8_t* ddr = _getDDRRegister(port);
+    if (!ddr || bitNumber > 7) return;
 
-        case port_J:
-            #ifdef DDRJ
-            if (bitValue)  DDRJ |=  (0x01<< bitNumber);
-            else           DDRJ &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_K:
-            #ifdef DDRK
-            if (bitValue)  DDRK |=  (0x01<< bitNumber);
-            else           DDRK &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_L:
-            #ifdef DDRL
-            if (bitValue)  DDRL |=  (0x01<< bitNumber);
-            else           DDRL &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        default:
-            break;
-    }
+    uint8_t mask = pgm_read_byte( &_pinMasks[bitNumber] );
+    if (bitValue)  _modifyDDR(port, ddr, 0, mask);
+    else           _modifyDDR(port, ddr, mask, 0);
 }
 
 //Sets or clears a Bit in a PORTx-Register
@@ -659,267 +393,35 @@ void _setDDRBitValue( uint8_t port, uint8_t bitNumber, uint8_t bitValue)
 //   the internal pullup-resistor, while a 1 activates it.
 void _setPORTBitValue( uint8_t port, uint8_t bitNumber, uint8_t bitValue)
 {
-    switch (port)
-    {
-        case port_A:
-            #ifdef PORTA
-            if (bitValue)  PORTA |=  (0x01<< bitNumber);
-            else           PORTA &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_B:
-            #ifdef PORTB
-            if (bitValue)  PORTB |=  (0x01<< bitNumber);
-            else           PORTB &= ~(0x01<< bitNumber);
-            #endif
-            return;
+    sfr8_t* portReg = _getPORTRegister(port);
+    if (!portReg || bitNumber > 7) return;
 
-        case port_C:
-            #ifdef PORTA
-            if (bitValue)  PORTC |=  (0x01<< bitNumber);
-            else           PORTC &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_D:
-            #ifdef PORTD
-            if (bitValue)  PORTD |=  (0x01<< bitNumber);
-            else           PORTD &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_E:
-            #ifdef PORTE
-            if (bitValue)  PORTE |=  (0x01<< bitNumber);
-            else           PORTE &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_F:
-            #ifdef PORTF
-            if (bitValue)  PORTF |=  (0x01<< bitNumber);
-            else           PORTF &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_G:
-            #ifdef PORTG
-            if (bitValue)  PORTG |=  (0x01<< bitNumber);
-            else           PORTG &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_H:
-            #ifdef PORTH
-            if (bitValue)  PORTH |=  (0x01<< bitNumber);
-            else           PORTH &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_I: //I think, Port I does not exist on any AVR
-            #ifdef PORTI
-            if (bitValue)  PORTI |=  (0x01<< bitNumber);
-            else           PORTI &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_J:
-            #ifdef PORTJ
-            if (bitValue)  PORTJ |=  (0x01<< bitNumber);
-            else           PORTJ &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_K:
-            #ifdef PORTK
-            if (bitValue)  PORTK |=  (0x01<< bitNumber);
-            else           PORTK &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        case port_L:
-            #ifdef PORTL
-            if (bitValue)  PORTL |=  (0x01<< bitNumber);
-            else           PORTL &= ~(0x01<< bitNumber);
-            #endif
-            return;
-
-        default:
-            break;
-    }
+    uint8_t mask = pgm_read_byte( &_pinMasks[bitNumber] );
+    if (bitValue)  _modifyPORT(port, portReg, 0, mask);
+    else           _modifyPORT(port, portReg, mask, 0);
 }
 
-//Toggles Bit <bitNumber> of the PORTx-Register specified by <port>
+//Toggles Bit <bitNumber> of the PORTx-Register specified by <port>, by
+//writing a 1 to the corresponding Bit of the PINx-Register (write 1 to toggle)
 void _togglePORTBit( uint8_t port, uint8_t bitNumber )
 {
-    switch ( port )
-    {
-        case port_A:
-            #ifdef PORTA
-            PORTA ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_B:
-            #ifdef PORTB
-            PORTB ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_C:
-            #ifdef PORTC
-            PORTC ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_D:
-            #ifdef PORTD
-            PORTD ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_E:
-            #ifdef PORTE
-            PORTE ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_F:
-            #ifdef PORTF
-            PORTF ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_G:
-            #ifdef PORTG
-            PORTG ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_H:
-            #ifdef PORTH
-            PORTH ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_I: //Port I doesn't exist on any AVR
-            #ifdef PORTI
-            PORTI ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_J:
-            #ifdef PORTJ
-            PORTJ ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        case port_K:
-            #ifdef PORTK
-            PORTK ^= (0x01<<bitNumber);
-            #endif
-            return;
-
-        default:
-            break;
-    }
+    sfr8_t* pin = _getPINRegister(port);
+    if (!pin || bitNumber > 7) return;
+
+#ifdef GPIO_SHADOW_REGISTERS
+    togglePort( port, pgm_read_byte( &_pinMasks[bitNumber] ) );
+#else
+    *pin = pgm_read_byte( &_pinMasks[bitNumber] );
+#endif
 }
 
 //returns the Bit-value (0 or 1) of a Bit of the PINx-Register
 //This Bit represents the actual voltage-level of the corresponding GPIO-Pin
 uint8_t _getPINBit(uint8_t port, uint8_t bitNumber)
 {
-    switch(port)
-    {
-        case port_A:
-            #ifdef PINA
-            if (PINA & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
+    sfr8_t* pin = _getPINRegister(port);
+    if (!pin || bitNumber > 7) return 0; //wrong argument or non existing port
 
-        case port_B:
-            #ifdef PINB
-            if (PINB & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
-
-        case port_C:
-            #ifdef PINC
-            if (PINC & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
-
-        case port_D:
-            #ifdef PIND
-                if (PIND & (0x01<<bitNumber)) return 1;
-                else                          return 0;
-            #endif
-            break;
-
-        case port_E:
-            #ifdef PINE
-            if (PINE & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif 
-            break;
-
-        case port_F:
-            #ifdef PINF
-            if (PINF & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
-
-        case port_G:
-            #ifdef PING
-            if (PING & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
-
-        case port_H:
-            #ifdef PINH
-            if (PINH & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
-
-        case port_I: //I think, Port I does not exist on any AVR
-            #ifdef PINI
-            if (PINI & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
-
-        case port_J:
-            #ifdef PINJ
-            if (PINJ & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
-
-        case port_K:
-            #ifdef PINK
-            if (PINK & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
-        
-        case port_L:
-            #ifdef PINL
-            if (PINL & (0x01<<bitNumber)) return 1;
-            else                          return 0;
-            #endif
-            break;
-        
-        default:
-            break;
-    }
-
-    //only reached for wrong argument or non existing port
-    return 0;
+    if (*pin & pgm_read_byte( &_pinMasks[bitNumber] )) return 1;
+    else                                               return 0;
 }
@@ -24,6 +24,9 @@
 
 #include <stdint.h>
 
+//The port-numbers port_A ... port_L and GPIO_PORT_COUNT
+#include "GPIOPorts.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -32,24 +35,6 @@ extern "C" {
 // Macros used as Arguments for the API-functions/methods
 ////////////////////////////////////////////////////////////////////////////
 
-/** 
- * GPIO-Pins are grouped in in "ports". 8 pins together form a port.
- * These Macros should be used as arguments for functions/methods,
- * that receive a port as parameter.
- */
-#define        port_A         0
-#define        port_B         1
-#define        port_C         2
-#define        port_D         3
-#define        port_E         4
-#define        port_F         5
-#define        port_G         6
-#define        port_H         7
-#define        port_I         8 /* does not exist on any AVR */
-#define        port_J         9
-#define        port_K        10
-#define        port_L        11
-
 /**
  * Argument for function `setPinMode`, constructor of `GPIOPin` and method
  * `GPIOPin::setPinMode`
@@ -124,6 +109,12 @@ uint8_t readPin( uint8_t port, uint8_t pinNumber );
  * Toggles the voltage-level-state of an output-pin. (If the Level has been 
  * low it will change to high and vice versa).
  *
+ * The pin is toggled by writing a 1 to its Bit in the PINx-Register. This is
+ * a single store-instruction, so it is safe, even if an 
+ * Interrupt-Service-Routine changes other pins of the same port. (All AVRs
+ * supported by this library toggle PORTx-Bits this way. Some older AVRs, like
+ * the ATmega8/16/32, can't do this).
+ *
  * @param port A number between 0 (port A) and up to 11 (port L). One of the 
  *      Macros port_A to port_L should be used for this parameter.
  * @param pinNumber The number of the Pin. Must be between 0 and 7.
@@ -198,6 +189,10 @@ uint8_t readPort( uint8_t port, uint8_t mask);
  * After programming some pins of a port to be outputs, with this
  * function the voltage-levels of these pins can be toggled.
  *
+ * Like `togglePin`, this function writes `mask` to the PINx-Register (a
+ * single store-instruction), so it is safe, even if an
+ * Interrupt-Service-Routine changes other pins of the same port.
+ *
  * @param port A number between 0 (port A) and up to 11 (port L). One of the 
  *      Macros port_A to port_L should be used for this parameter.
  * @param mask An 8-Bit-Pattern. Only Pins whose corresponding Bit in `mask`
@@ -206,6 +201,44 @@ uint8_t readPort( uint8_t port, uint8_t mask);
 void togglePort( uint8_t port, uint8_t mask );
 
 
+//////////////////////////////////////////////////////////////////////////
+// Shadow-Registers (optional)
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * If the macro `GPIO_SHADOW_REGISTERS` is defined when compiling GPIO.cpp
+ * (for example with -DGPIO_SHADOW_REGISTERS), the functions of this module
+ * keep a copy of each DDRx- and PORTx-Register in RAM. A change of pins is
+ * then computed from the copy and stored into the register, without reading
+ * the register first. Each change is done with interrupts disabled, so
+ * Interrupt-Service-Routines may change other pins of the same port with
+ * these functions.
+ *
+ * The copies start with the reset-values of the registers (0). The other
+ * modules of this library (`GPIOBus`, `GPIOTransaction`, SoftPWM.h) keep
+ * them up to date. If a register is changed by other means (direct
+ * register-access, `FastPin`, a bootloader, ...), the copy must be updated
+ * with `resyncGPIOShadowRegisters` before the next change of the port with
+ * the functions of this module.
+ *
+ * Without `GPIO_SHADOW_REGISTERS` these two functions do nothing.
+ */
+
+/**
+ * Reloads the copies of the DDRx- and PORTx-Register of a port from the
+ * registers.
+ *
+ * @param port A number between 0 (port A) and up to 11 (port L). One of the 
+ *      Macros port_A to port_L should be used for this parameter.
+ */
+void resyncGPIOShadowRegisters( uint8_t port );
+
+/**
+ * Reloads the copies of the DDRx- and PORTx-Registers of all ports.
+ */
+void resyncAllGPIOShadowRegisters( void );
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -213,6 +246,47 @@ void togglePort( uint8_t port, uint8_t mask );
 
 #ifdef __cplusplus
 
+#include "SFR.h"
+#include "MCUCapabilities.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Low-level access to the Special-Function-Registers of a port
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * These functions return a pointer to the PINx-, DDRx- or PORTx-Register of a
+ * port (taken from a table in flash), or a null-pointer, if the port doesn't
+ * exist on the microcontroller. They are used by other modules of this
+ * library, that need direct access to the registers of a port, whose number
+ * is only known at runtime.
+ *
+ * @param port A number between 0 (port A) and up to 11 (port L). One of the 
+ *      Macros port_A to port_L should be used for this parameter.
+ */
+sfr8_t* _getPINRegister( uint8_t port );
+sfr8_t* _getDDRRegister( uint8_t port );
+sfr8_t* _getPORTRegister( uint8_t port );
+
+/**
+ * These functions clear the bits `clear` and set the bits `set` of the
+ * DDRx- or PORTx-Register (from `_getDDRRegister` or `_getPORTRegister`) of
+ * a port. Other modules of this library change the registers with them, so
+ * that the copies of `GPIO_SHADOW_REGISTERS` stay up to date. Without
+ * shadow-registers it is a read-modify-write of the register.
+ */
+void _modifyDDRRegister( uint8_t port, sfr8_t* ddr, uint8_t clear,
+                         uint8_t set );
+void _modifyPORTRegister( uint8_t port, sfr8_t* portReg, uint8_t clear,
+                          uint8_t set );
+
+/**
+ * Returns the copy of the PORTx-Register of a port (see
+ * `GPIO_SHADOW_REGISTERS`), or a null-pointer without shadow-registers. An
+ * Interrupt-Service-Routine, that toggles pins by writing to PINx, must
+ * toggle the same bits of the copy.
+ */
+uint8_t* _getPORTShadow( uint8_t port );
+
 //////////////////////////////////////////////////////////////////////////
 // C++ Class (Wrapper) for a single GPIO-Pin
 //////////////////////////////////////////////////////////////////////////
@@ -292,17 +366,253 @@ public:
     
     /**
      * Toggles the voltage-level of the GPIO-Pin. The pin should be an output.
+     * Other pins of the port are never changed, even if an
+     * Interrupt-Service-Routine writes to them (see C-function `togglePin`).
      */
     void togglePin()
     {
         ::togglePin(_port, _pinNumber);
     }
 
+    /**
+     * Returns the port of the GPIO-Pin (port_A ... port_L)
+     */
+    uint8_t getPort() const { return _port; }
+
+    /**
+     * Returns the number of the GPIO-Pin (0...7)
+     */
+    uint8_t getPinNumber() const { return _pinNumber; }
+
 private:
     uint8_t _port;
     uint8_t _pinNumber;
 };
 
+//////////////////////////////////////////////////////////////////////////
+// C++ Template for a single GPIO-Pin, that is known at compile-time
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Helper-template, that maps a port-number (`port_A` ... `port_L`) to the
+ * Special-Function-Registers PINx, DDRx and PORTx of this port at 
+ * compile-time. It is only used by `FastPin`. There is no specialization for
+ * ports, that don't exist on the used microcontroller, so using such a port
+ * results in a compile-error.
+ */
+template<uint8_t port> struct _GPIORegisters;
+
+#ifdef PORTA
+template<> struct _GPIORegisters<port_A>
+{
+    static sfr8_t& PINx()  { return PINA; }
+    static sfr8_t& DDRx()  { return DDRA; }
+    static sfr8_t& PORTx() { return PORTA; }
+};
+#endif
+
+#ifdef PORTB
+template<> struct _GPIORegisters<port_B>
+{
+    static sfr8_t& PINx()  { return PINB; }
+    static sfr8_t& DDRx()  { return DDRB; }
+    static sfr8_t& PORTx() { return PORTB; }
+};
+#endif
+
+#ifdef PORTC
+template<> struct _GPIORegisters<port_C>
+{
+    static sfr8_t& PINx()  { return PINC; }
+    static sfr8_t& DDRx()  { return DDRC; }
+    static sfr8_t& PORTx() { return PORTC; }
+};
+#endif
+
+#ifdef PORTD
+template<> struct _GPIORegisters<port_D>
+{
+    static sfr8_t& PINx()  { return PIND; }
+    static sfr8_t& DDRx()  { return DDRD; }
+    static sfr8_t& PORTx() { return PORTD; }
+};
+#endif
+
+#ifdef PORTE
+template<> struct _GPIORegisters<port_E>
+{
+    static sfr8_t& PINx()  { return PINE; }
+    static sfr8_t& DDRx()  { return DDRE; }
+    static sfr8_t& PORTx() { return PORTE; }
+};
+#endif
+
+#ifdef PORTF
+template<> struct _GPIORegisters<port_F>
+{
+    static sfr8_t& PINx()  { return PINF; }
+    static sfr8_t& DDRx()  { return DDRF; }
+    static sfr8_t& PORTx() { return PORTF; }
+};
+#endif
+
+#ifdef PORTG
+template<> struct _GPIORegisters<port_G>
+{
+    static sfr8_t& PINx()  { return PING; }
+    static sfr8_t& DDRx()  { return DDRG; }
+    static sfr8_t& PORTx() { return PORTG; }
+};
+#endif
+
+#ifdef PORTH
+template<> struct _GPIORegisters<port_H>
+{
+    static sfr8_t& PINx()  { return PINH; }
+    static sfr8_t& DDRx()  { return DDRH; }
+    static sfr8_t& PORTx() { return PORTH; }
+};
+#endif
+
+#ifdef PORTJ
+template<> struct _GPIORegisters<port_J>
+{
+    static sfr8_t& PINx()  { return PINJ; }
+    static sfr8_t& DDRx()  { return DDRJ; }
+    static sfr8_t& PORTx() { return PORTJ; }
+};
+#endif
+
+#ifdef PORTK
+template<> struct _GPIORegisters<port_K>
+{
+    static sfr8_t& PINx()  { return PINK; }
+    static sfr8_t& DDRx()  { return DDRK; }
+    static sfr8_t& PORTx() { return PORTK; }
+};
+#endif
+
+#ifdef PORTL
+template<> struct _GPIORegisters<port_L>
+{
+    static sfr8_t& PINx()  { return PINL; }
+    static sfr8_t& DDRx()  { return DDRL; }
+    static sfr8_t& PORTx() { return PORTL; }
+};
+#endif
+
+/**
+ * Template-class for a single GPIO-Pin, whose port and pin-number are known
+ * at compile-time. It has the same methods as `GPIOPin`, but there is no 
+ * function-call, no switch over the port and no shift at runtime: The 
+ * compiler knows the address of the Special-Function-Register and the 
+ * bit-mask, so (if compiled with optimization, e.g. -Os) each method reduces
+ * to a single instruction:
+ *
+ * - `writePin`, `setPinMode` and `setPinPullup` with a constant argument
+ *   become one `sbi` or `cbi`.
+ * - `readPin` becomes one `sbis`/`sbic` when used in a condition (otherwise
+ *   an `in` and a bit-test).
+ * - `togglePin` becomes one `out` (writing a 1 to a bit in PINx toggles the
+ *   corresponding bit in PORTx), which is atomic with respect to
+ *   Interrupt-Service-Routines.
+ *
+ * Note: `sbi`, `cbi` and `sbis` can only access the lower I/O-space. On the
+ * ATmega2560 the registers of ports H, J, K and L are outside of it, so for
+ * these ports the compiler uses `lds`/`sts` (and a read-modify-write, that is
+ * not atomic with respect to Interrupt-Service-Routines, for `writePin`,
+ * `setPinMode` and `setPinPullup`).
+ *
+ * For example, to use pin PB7 (the LED on the Arduino Mega) use
+ * {@code
+ *     FastPin<port_B, 7> ledPin = FastPin<port_B, 7>( MODE_OUTPUT );
+ *     ledPin.togglePin();
+ * }
+ * Because the instance has no state, the methods can also be called without
+ * an instance, for example `FastPin<port_B, 7>::togglePin();`.
+ *
+ * A port or pin, that doesn't exist on the used microcontroller (see
+ * MCUCapabilities.h), results in a compile-error.
+ */
+template<uint8_t port, uint8_t pinNumber>
+class FastPin
+{
+    static_assert( pinNumber < 8, "pinNumber must be between 0 and 7" );
+    static_assert( mcuPinExists( port, pinNumber ),
+                   "This pin doesn't exist on the microcontroller" );
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param mode `MODE_OUTPUT` or 1 to make the pin an output, `MODE_INPUT` 
+     *      or 0 to make it an input. Default-value is `MODE_INPUT`
+     */
+    FastPin( uint8_t mode = MODE_INPUT ) { setPinMode( mode ); }
+
+    /**
+     * Turns the GPIO-pin into an input or an output
+     *
+     * @param mode `MODE_OUTPUT` or 1 to make the pin an output, `MODE_INPUT` 
+     *      or 0 to make it an input.
+     */
+    static void setPinMode( uint8_t mode )
+    {
+        if (mode == MODE_OUTPUT)     _GPIORegisters<port>::DDRx() |=  _mask;
+        else if (mode == MODE_INPUT) _GPIORegisters<port>::DDRx() &= ~_mask;
+    }
+
+    /**
+     * Activates or Deactivates the internal pullup-resistor for this pin. The
+     * pin should have been configured as input, if this method is used.
+     *
+     * @param onOff `PULLUP_OFF` or 0 deactivates the pullup-resistor, 
+     *      `PULLUP_ON` or 1 activates it.
+     */
+    static void setPinPullup( uint8_t onOff )
+    {
+        if (onOff == PULLUP_ON)       _GPIORegisters<port>::PORTx() |=  _mask;
+        else if (onOff == PULLUP_OFF) _GPIORegisters<port>::PORTx() &= ~_mask;
+    }
+
+    /**
+     * Puts out a high- or low-voltage-level at the GPIO-Pin. The pin should
+     * be an output.
+     *
+     * @param voltageLevel: 0 or 1 (low- or high-level). Macros `LOW_LEVEL` and
+     *      `HIGH_LEVEL` can be used for this parameter.
+     */
+    static void writePin( uint8_t voltageLevel )
+    {
+        if (voltageLevel == HIGH_LEVEL)     _GPIORegisters<port>::PORTx() |=  _mask;
+        else if (voltageLevel == LOW_LEVEL) _GPIORegisters<port>::PORTx() &= ~_mask;
+    }
+
+    /**
+     * Returns the voltage-Level of the GPIO-Pin
+     *
+     * @return `HIGH_LEVEL` (1) or `LOW_LEVEL` (0)
+     */
+    static uint8_t readPin()
+    {
+        if (_GPIORegisters<port>::PINx() & _mask) return HIGH_LEVEL;
+        else                                      return LOW_LEVEL;
+    }
+
+    /**
+     * Toggles the voltage-level of the GPIO-Pin. The pin should be an output.
+     * Writes the bit-mask to PINx (write 1 to toggle), so no read-modify-write
+     * of PORTx is done.
+     */
+    static void togglePin()
+    {
+        _GPIORegisters<port>::PINx() = _mask;
+    }
+
+private:
+    static const uint8_t _mask = (uint8_t)(0x01 << pinNumber);
+};
+
 //////////////////////////////////////////////////////////////////////////
 // C++ Class (Wrapper) for a GPIO-Port (8 pins)
 //////////////////////////////////////////////////////////////////////////
@@ -404,12 +714,23 @@ public:
      *      is 1 will be toggled, the other Pins remain unchanged.
      *      (default-value=0xFF, all 8 pins are toggled, all 8 pins should be
      *      outputs).
+     *
+     * @see togglePort()
      */
     void togglePort( uint8_t mask=0xFF )
     {
         ::togglePort( _port, mask );
     }
 
+    /**
+     * Reloads the RAM-copies of DDRx and PORTx of this port (only with
+     * `GPIO_SHADOW_REGISTERS`, see `resyncGPIOShadowRegisters`).
+     */
+    void resyncShadowRegisters()
+    {
+        ::resyncGPIOShadowRegisters( _port );
+    }
+
 private:
     uint8_t _port;
 };
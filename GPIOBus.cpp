@@ -0,0 +1,225 @@
+/*
+    GPIOBus.cpp - A Library for parallel buses (for example the data-lines of
+    a display or external latches), whose lines are spread over the
+    GPIO-Pins of several ports of an AVR-Microcontroller.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "GPIOBus.h"
+#include "MCUCapabilities.h"
+
+GPIOBus::GPIOBus( const GPIOBusPin* pins, uint8_t width, uint8_t mode,
+                  bool atomic )
+    : _portCount(0), _width(0), _atomic(atomic)
+{
+    if (width == 0 || width > 32) return; //invalid bus
+
+    uint8_t portNumbers[GPIOBUS_MAX_PORTS];
+    uint8_t segmentCount = 0;
+
+    //Each port gets an entry in _ports, in the order of the first bit of the
+    //bus-word on this port. Then all bits on this port are combined to
+    //segments.
+    for (uint8_t firstBit = 0; firstBit < width; firstBit++)
+    {
+        uint8_t port = pins[firstBit].port;
+
+        bool known = false;
+        for (uint8_t p = 0; p < _portCount; p++)
+        {
+            if (portNumbers[p] == port) known = true;
+        }
+        if (known) continue;
+
+        if (_portCount >= GPIOBUS_MAX_PORTS) 
+        {
+            _portCount = 0;
+            return; //invalid bus: too many ports
+        }
+
+        _Port& busPort = _ports[_portCount];
+        busPort.pinReg = _getPINRegister( port );
+        busPort.ddrReg = _getDDRRegister( port );
+        busPort.portReg = _getPORTRegister( port );
+        busPort.port = port;
+        busPort.mask = 0;
+        busPort.segmentCount = 0;
+        if (!busPort.pinReg)
+        {
+            _portCount = 0;
+            return; //invalid bus: port doesn't exist
+        }
+
+        _Segment* segment = 0;
+        uint8_t lastBit = 0;
+        uint8_t lastPin = 0;
+
+        for (uint8_t bit = firstBit; bit < width; bit++)
+        {
+            if (pins[bit].port != port) continue;
+
+            uint8_t pinNumber = pins[bit].pinNumber;
+            if (!mcuPinExists( port, pinNumber )
+                || (busPort.mask & (0x01<<pinNumber)))
+            {
+                _portCount = 0;
+                return; //invalid bus: pin doesn't exist, or duplicate pin
+            }
+
+            //start a new segment, if this bit doesn't continue the last one
+            if (!segment || bit != lastBit+1 || pinNumber != lastPin+1)
+            {
+                if (segmentCount >= GPIOBUS_MAX_SEGMENTS)
+                {
+                    _portCount = 0;
+                    return; //invalid bus: too many segments
+                }
+                segment = &_segments[segmentCount++];
+                segment->byteIndex = bit / 8;
+                segment->shift = (int8_t)pinNumber - (int8_t)(bit % 8);
+                segment->mask = 0;
+                busPort.segmentCount++;
+            }
+
+            segment->mask |= (0x01<<pinNumber);
+            busPort.mask |= (0x01<<pinNumber);
+            lastBit = bit;
+            lastPin = pinNumber;
+        }
+
+        portNumbers[_portCount] = port;
+        _portCount++;
+    }
+
+    _width = width;
+    setBusMode( mode );
+}
+
+
+void GPIOBus::setBusMode( uint8_t mode )
+{
+    if (mode != MODE_OUTPUT && mode != MODE_INPUT) return;
+
+    for (uint8_t p = 0; p < _portCount; p++)
+    {
+        const _Port& busPort = _ports[p];
+        _modifyDDRRegister( busPort.port, busPort.ddrReg, busPort.mask,
+                            mode == MODE_OUTPUT ? busPort.mask : 0 );
+    }
+}
+
+
+void GPIOBus::setBusPullup( uint8_t onOff )
+{
+    if (onOff != PULLUP_ON && onOff != PULLUP_OFF) return;
+
+    for (uint8_t p = 0; p < _portCount; p++)
+    {
+        const _Port& busPort = _ports[p];
+        _modifyPORTRegister( busPort.port, busPort.portReg, busPort.mask,
+                             onOff == PULLUP_ON ? busPort.mask : 0 );
+    }
+}
+
+
+void GPIOBus::write( uint32_t word )
+{
+    //the bytes of the bus-word (one more 0-byte, because each segment
+    //takes two bytes)
+    uint8_t bytes[5];
+    bytes[0] = (uint8_t) word;
+    bytes[1] = (uint8_t)(word >> 8);
+    bytes[2] = (uint8_t)(word >> 16);
+    bytes[3] = (uint8_t)(word >> 24);
+    bytes[4] = 0;
+
+    //First calculate the new values of all ports of the bus ...
+    uint8_t values[GPIOBUS_MAX_PORTS];
+    const _Segment* segment = _segments;
+    for (uint8_t p = 0; p < _portCount; p++)
+    {
+        uint8_t value = 0;
+        for (uint8_t s = 0; s < _ports[p].segmentCount; s++, segment++)
+        {
+            uint16_t bits = bytes[segment->byteIndex] 
+                            | (bytes[segment->byteIndex+1] << 8);
+            if (segment->shift >= 0) bits <<= segment->shift;
+            else                     bits >>= -segment->shift;
+            value |= (uint8_t)bits & segment->mask;
+        }
+        values[p] = value;
+    }
+
+    //... then write them, one read-modify-write for each port
+    uint8_t sreg = 0;
+    if (_atomic)
+    {
+        sreg = SREG;
+        cli();
+    }
+
+    for (uint8_t p = 0; p < _portCount; p++)
+    {
+        const _Port& busPort = _ports[p];
+        _modifyPORTRegister( busPort.port, busPort.portReg, busPort.mask,
+                             values[p] );
+    }
+
+    if (_atomic) SREG = sreg;
+}
+
+
+uint32_t GPIOBus::read()
+{
+    //First read all PINx-Registers of the bus ...
+    uint8_t values[GPIOBUS_MAX_PORTS];
+
+    uint8_t sreg = 0;
+    if (_atomic)
+    {
+        sreg = SREG;
+        cli();
+    }
+
+    for (uint8_t p = 0; p < _portCount; p++)
+    {
+        values[p] = *_ports[p].pinReg;
+    }
+
+    if (_atomic) SREG = sreg;
+
+    //... then put the bits of the segments together to the bus-word
+    uint8_t bytes[5] = { 0, 0, 0, 0, 0 };
+    const _Segment* segment = _segments;
+    for (uint8_t p = 0; p < _portCount; p++)
+    {
+        for (uint8_t s = 0; s < _ports[p].segmentCount; s++, segment++)
+        {
+            uint16_t bits = values[p] & segment->mask;
+            if (segment->shift >= 0) bits >>= segment->shift;
+            else                     bits <<= -segment->shift;
+            bytes[segment->byteIndex] |= (uint8_t)bits;
+            bytes[segment->byteIndex+1] |= (uint8_t)(bits >> 8);
+        }
+    }
+
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8)
+           | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
@@ -0,0 +1,178 @@
+/*
+    GPIOBus.h - A Library for parallel buses (for example the data-lines of
+    a display or external latches), whose lines are spread over the
+    GPIO-Pins of several ports of an AVR-Microcontroller.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GPIOBUS_H_
+#define GPIOBUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GPIO.h"
+
+#ifdef __cplusplus
+
+/**
+ * Maximum number of different ports and of segments (see `GPIOBus`), that
+ * one bus can use. Each `GPIOBus`-instance reserves memory for this number
+ * of ports and segments, so they are kept small. Define them with other
+ * values before including this header, if your buses need more.
+ */
+#ifndef GPIOBUS_MAX_PORTS
+#define GPIOBUS_MAX_PORTS       4
+#endif
+
+#ifndef GPIOBUS_MAX_SEGMENTS
+#define GPIOBUS_MAX_SEGMENTS    8
+#endif
+
+/**
+ * One line of a bus: The GPIO-Pin, that is used for one bit of the bus-word.
+ */
+struct GPIOBusPin
+{
+    uint8_t port;       // port_A ... port_L
+    uint8_t pinNumber;  // 0 ... 7
+};
+
+/**
+ * Class for a parallel bus with up to 32 lines, whose GPIO-Pins can be
+ * spread over several ports. Bit 0 of the bus-word is the first pin of the
+ * pin-map given to the constructor, bit 1 the second one, and so on.
+ *
+ * The constructor analyzes the pin-map once: Pins of the same port, whose
+ * pin-numbers follow each other in the same order as the bits of the
+ * bus-word, are combined to a "segment", that is moved with one mask and one
+ * shift. So `write()` accesses each PORTx-Register of the bus only once
+ * (one read-modify-write per port) and `read()` reads each PINx-Register only
+ * once.
+ *
+ * For example a 16-bit-bus on PA0...PA7 (bits 0...7) and PC0...PC7 (bits
+ * 8...15):
+ * {@code
+ *     const GPIOBusPin busPins[16] = {
+ *         {port_A,0}, {port_A,1}, {port_A,2}, {port_A,3},
+ *         {port_A,4}, {port_A,5}, {port_A,6}, {port_A,7},
+ *         {port_C,0}, {port_C,1}, {port_C,2}, {port_C,3},
+ *         {port_C,4}, {port_C,5}, {port_C,6}, {port_C,7} };
+ *     GPIOBus dataBus = GPIOBus( busPins, 16, MODE_OUTPUT );
+ *     dataBus.write( 0x1234 );
+ * }
+ * This bus has two ports with one segment each.
+ */
+class GPIOBus
+{
+public:
+    /**
+     * Constructor.
+     *
+     * If the pin-map contains a port or pin, that doesn't exist, or needs
+     * more than `GPIOBUS_MAX_PORTS` ports or `GPIOBUS_MAX_SEGMENTS` segments,
+     * the bus is invalid: `getWidth()` returns 0 and all methods do nothing.
+     *
+     * @param pins The pin-map: `pins[0]` is the GPIO-Pin of bit 0 of the
+     *      bus-word, `pins[1]` of bit 1 and so on. The pin-map is only used
+     *      in the constructor, so it doesn't need to exist any longer.
+     * @param width The number of lines of the bus (1...32).
+     * @param mode `MODE_OUTPUT` or `MODE_INPUT`: All pins of the bus are
+     *      programmed to be outputs or inputs. Default: `MODE_INPUT`
+     * @param atomic If true, `write()` changes all ports of the bus with
+     *      interrupts disabled, so no Interrupt-Service-Routine can see a
+     *      half-written bus-word (and `read()` reads all ports with
+     *      interrupts disabled). Default: false
+     */
+    GPIOBus( const GPIOBusPin* pins, uint8_t width,
+             uint8_t mode = MODE_INPUT, bool atomic = false );
+
+    /**
+     * Programs all pins of the bus to be outputs or inputs.
+     *
+     * @param mode `MODE_OUTPUT` or 1 makes all pins outputs, `MODE_INPUT` or
+     *      0 makes them inputs.
+     */
+    void setBusMode( uint8_t mode );
+
+    /**
+     * Activates or deactivates the internal pullup-resistors of all pins of
+     * the bus. The pins should be inputs.
+     *
+     * @param onOff `PULLUP_OFF` or 0 deactivates the pullup-resistors,
+     *      `PULLUP_ON` or 1 activates them.
+     */
+    void setBusPullup( uint8_t onOff );
+
+    /**
+     * Puts out a bus-word. Each PORTx-Register of the bus is read and written
+     * once. Pins of these ports, that don't belong to the bus, remain
+     * unchanged.
+     *
+     * @param word Bit n of `word` is put out on the pin `pins[n]` of the
+     *      pin-map. Bits above the width of the bus are ignored.
+     */
+    void write( uint32_t word );
+
+    /**
+     * Reads in the voltage-levels of all pins of the bus. Each PINx-Register
+     * of the bus is read once.
+     *
+     * @return Bit n is the voltage-level of the pin `pins[n]` of the pin-map.
+     *      Bits above the width of the bus are 0.
+     */
+    uint32_t read();
+
+    /**
+     * Returns the number of lines of the bus, or 0 if the bus is invalid.
+     */
+    uint8_t getWidth() { return _width; }
+
+private:
+    //All pins of a bus, that are on the same port
+    struct _Port
+    {
+        sfr8_t* pinReg;
+        sfr8_t* ddrReg;
+        sfr8_t* portReg;
+        uint8_t port;           //port-number (for the shadow-registers)
+        uint8_t mask;           //pins of this port belonging to the bus
+        uint8_t segmentCount;   //this port's segments follow those of
+                                //the ports before it in _segments
+    };
+
+    //Consecutive bits of the bus-word on consecutive pins of a port.
+    //The bits are taken from the bytes `byteIndex` and `byteIndex+1` of the
+    //bus-word (as 16-bit-value) and shifted by `shift` (left for positive
+    //values, right for negative values) to the position of the pins.
+    struct _Segment
+    {
+        uint8_t byteIndex;
+        int8_t  shift;
+        uint8_t mask;           //pins of the port belonging to the segment
+    };
+
+    _Port _ports[GPIOBUS_MAX_PORTS];
+    _Segment _segments[GPIOBUS_MAX_SEGMENTS];
+    uint8_t _portCount;
+    uint8_t _width;
+    bool _atomic;
+};
+
+#endif
+
+#endif /* GPIOBUS_H_ */
@@ -0,0 +1,47 @@
+/*
+    GPIOPorts.h - The numbers of the ports of AVR-Microcontrollers, shared
+    by GPIO.h and MCUCapabilities.h. This is part of the
+    simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#ifndef GPIOPORTS_H_
+#define GPIOPORTS_H_
+
+/** 
+ * GPIO-Pins are grouped in in "ports". 8 pins together form a port.
+ * These Macros should be used as arguments for functions/methods,
+ * that receive a port as parameter.
+ */
+#define        port_A         0
+#define        port_B         1
+#define        port_C         2
+#define        port_D         3
+#define        port_E         4
+#define        port_F         5
+#define        port_G         6
+#define        port_H         7
+#define        port_I         8 /* does not exist on any AVR */
+#define        port_J         9
+#define        port_K        10
+#define        port_L        11
+
+/**
+ * Number of port-numbers (port_A ... port_L). Valid port-numbers are smaller.
+ */
+#define        GPIO_PORT_COUNT  12
+
+#endif /* GPIOPORTS_H_ */
@@ -0,0 +1,145 @@
+/*
+    GPIOTransaction.cpp - Collects changes of many GPIO-Pins of an
+    AVR-Microcontroller and carries them out with one register-access per
+    port.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "GPIOTransaction.h"
+
+bool GPIOTransaction::setPinMode( uint8_t port, uint8_t pinNumber,
+                                  uint8_t mode )
+{
+    if (pinNumber > 7 || mode > MODE_OUTPUT) return false;
+    return _change( port, 0x01<<pinNumber, mode ? 0xFF : 0x00, true );
+}
+
+bool GPIOTransaction::setPinPullup( uint8_t port, uint8_t pinNumber,
+                                    uint8_t onOff )
+{
+    if (pinNumber > 7 || onOff > PULLUP_ON) return false;
+    return _change( port, 0x01<<pinNumber, onOff ? 0xFF : 0x00, false );
+}
+
+bool GPIOTransaction::writePin( uint8_t port, uint8_t pinNumber,
+                                uint8_t voltageLevel )
+{
+    if (pinNumber > 7 || voltageLevel > HIGH_LEVEL) return false;
+    return _change( port, 0x01<<pinNumber, voltageLevel ? 0xFF : 0x00, false );
+}
+
+bool GPIOTransaction::writePort( uint8_t port, uint8_t voltageLevels,
+                                 uint8_t mask )
+{
+    return _change( port, mask, voltageLevels, false );
+}
+
+bool GPIOTransaction::setPortMode( uint8_t port, uint8_t mode, uint8_t mask )
+{
+    return _change( port, mask, mode, true );
+}
+
+
+void GPIOTransaction::commit()
+{
+    uint8_t sreg = 0;
+    if (_atomic)
+    {
+        sreg = SREG;
+        cli();
+    }
+
+    for (uint8_t p = 0; p < _portCount; p++)
+    {
+        const _Port& entry = _ports[p];
+        //pins, that become inputs, are released first, pins, that become
+        //outputs, are driven last (with their new voltage-level)
+        if (entry.ddrClear)
+        {
+            _modifyDDRRegister( _portNumbers[p], entry.ddrReg,
+                                entry.ddrClear, 0x00 );
+        }
+        if (entry.portSet | entry.portClear)
+        {
+            _modifyPORTRegister( _portNumbers[p], entry.portReg,
+                                 entry.portClear, entry.portSet );
+        }
+        if (entry.ddrSet)
+        {
+            _modifyDDRRegister( _portNumbers[p], entry.ddrReg,
+                                0x00, entry.ddrSet );
+        }
+    }
+
+    if (_atomic) SREG = sreg;
+
+    _portCount = 0;
+}
+
+
+////////////////////////////////////////////////////////////////
+// "private" helper-Functions
+////////////////////////////////////////////////////////////////
+
+GPIOTransaction::_Port* GPIOTransaction::_findPort( uint8_t port )
+{
+    for (uint8_t p = 0; p < _portCount; p++)
+    {
+        if (_portNumbers[p] == port) return &_ports[p];
+    }
+
+    if (_portCount >= GPIOTRANSACTION_MAX_PORTS) return 0; //table full
+
+    _Port& entry = _ports[_portCount];
+    entry.ddrReg = _getDDRRegister( port );
+    entry.portReg = _getPORTRegister( port );
+    if (!entry.ddrReg) return 0; //port doesn't exist
+    entry.ddrSet = 0;
+    entry.ddrClear = 0;
+    entry.portSet = 0;
+    entry.portClear = 0;
+    _portNumbers[_portCount] = port;
+    _portCount++;
+    return &entry;
+}
+
+//Records, that the bits `mask` of the DDRx- (ddr = true) or PORTx-Register
+//get the values of the corresponding bits of `values`. A bit is either in
+//the Set- or in the Clear-mask, so the last change of a pin wins.
+bool GPIOTransaction::_change( uint8_t port, uint8_t mask, uint8_t values,
+                               bool ddr )
+{
+    _Port* entry = _findPort( port );
+    if (!entry) return false;
+
+    uint8_t set = values & mask;
+    uint8_t clear = ~values & mask;
+    if (ddr)
+    {
+        entry->ddrSet = (entry->ddrSet & ~clear) | set;
+        entry->ddrClear = (entry->ddrClear & ~set) | clear;
+    }
+    else
+    {
+        entry->portSet = (entry->portSet & ~clear) | set;
+        entry->portClear = (entry->portClear & ~set) | clear;
+    }
+    return true;
+}
@@ -0,0 +1,191 @@
+/*
+    GPIOTransaction.h - Collects changes of many GPIO-Pins of an
+    AVR-Microcontroller and carries them out with one register-access per
+    port.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GPIOTRANSACTION_H_
+#define GPIOTRANSACTION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GPIO.h"
+
+#ifdef __cplusplus
+
+/**
+ * Maximum number of different ports, that one transaction can change. Each
+ * `GPIOTransaction`-instance reserves memory for this number of ports.
+ * Define it with another value before including this header, if needed.
+ */
+#ifndef GPIOTRANSACTION_MAX_PORTS
+#define GPIOTRANSACTION_MAX_PORTS   4
+#endif
+
+/**
+ * Class collecting changes of GPIO-Pins (modes, pullup-resistors and
+ * voltage-levels) in RAM, without touching the Special-Function-Registers.
+ * `commit()` then carries out all changes with at most one read-modify-write
+ * of each DDRx- and PORTx-Register involved. This is much faster than one
+ * `writePin` after the other, and the pins of a port change at the same
+ * instant.
+ *
+ * A later change of the same pin overrides an earlier one.
+ *
+ * For example the outputs of a state-machine:
+ * {@code
+ *     GPIOPin motorOn = GPIOPin( port_A, 0, MODE_OUTPUT );
+ *     GPIOPin valve = GPIOPin( port_A, 3, MODE_OUTPUT );
+ *     GPIOPin lamp = GPIOPin( port_C, 7, MODE_OUTPUT );
+ *
+ *     GPIOTransaction outputs;
+ *     outputs.writePin( motorOn, HIGH_LEVEL );
+ *     outputs.writePin( valve, LOW_LEVEL );
+ *     outputs.writePin( lamp, HIGH_LEVEL );
+ *     outputs.commit();       //one read-modify-write of PORTA and of PORTC
+ * }
+ */
+class GPIOTransaction
+{
+public:
+    /**
+     * Constructor. The transaction is empty.
+     *
+     * @param atomic If true, `commit()` changes all registers with interrupts
+     *      disabled, so no Interrupt-Service-Routine can see (or disturb) a
+     *      half-done transaction. Default: false
+     */
+    GPIOTransaction( bool atomic = false ) : _portCount(0), _atomic(atomic) { }
+
+    /**
+     * Records, that a GPIO-Pin becomes an input or an output.
+     *
+     * @param port The port, for example port_A.
+     * @param pinNumber The number of the pin (0...7)
+     * @param mode `MODE_OUTPUT` or 1, `MODE_INPUT` or 0
+     * @return false, if the change has not been recorded, because the pin
+     *      doesn't exist, `mode` is invalid, or the transaction already
+     *      changes `GPIOTRANSACTION_MAX_PORTS` other ports.
+     */
+    bool setPinMode( uint8_t port, uint8_t pinNumber, uint8_t mode );
+
+    /**
+     * Records, that the pullup-resistor of a GPIO-Pin is activated or
+     * deactivated (the bit of the pin in the PORTx-Register is set or
+     * cleared, same as `writePin`).
+     *
+     * @param onOff `PULLUP_ON` or 1, `PULLUP_OFF` or 0
+     * @return false, if the change has not been recorded (see `setPinMode`).
+     */
+    bool setPinPullup( uint8_t port, uint8_t pinNumber, uint8_t onOff );
+
+    /**
+     * Records, that a voltage-level is put out at a GPIO-Pin.
+     *
+     * @param voltageLevel `HIGH_LEVEL` or 1, `LOW_LEVEL` or 0
+     * @return false, if the change has not been recorded (see `setPinMode`).
+     */
+    bool writePin( uint8_t port, uint8_t pinNumber, uint8_t voltageLevel );
+
+    /**
+     * Records, that voltage-levels are put out at several pins of a port.
+     *
+     * @param voltageLevels The voltage-levels of the pins (bit n for pin n)
+     * @param mask The pins to change (1-Bits)
+     * @return false, if the change has not been recorded (see `setPinMode`).
+     */
+    bool writePort( uint8_t port, uint8_t voltageLevels, uint8_t mask );
+
+    /**
+     * Records, that several pins of a port become inputs or outputs.
+     *
+     * @param mode The modes of the pins (bit n for pin n, 1 = output)
+     * @param mask The pins to change (1-Bits)
+     * @return false, if the change has not been recorded (see `setPinMode`).
+     */
+    bool setPortMode( uint8_t port, uint8_t mode, uint8_t mask );
+
+    bool setPinMode( const GPIOPin& pin, uint8_t mode )
+    {
+        return setPinMode( pin.getPort(), pin.getPinNumber(), mode );
+    }
+
+    bool setPinPullup( const GPIOPin& pin, uint8_t onOff )
+    {
+        return setPinPullup( pin.getPort(), pin.getPinNumber(), onOff );
+    }
+
+    bool writePin( const GPIOPin& pin, uint8_t voltageLevel )
+    {
+        return writePin( pin.getPort(), pin.getPinNumber(), voltageLevel );
+    }
+
+    /**
+     * Carries out all recorded changes, and empties the transaction, so it
+     * can be used again.
+     *
+     * For each port the pins, that become inputs, are released first (their
+     * DDRx-Bits are cleared), then the PORTx-Register is written, and then
+     * the pins, that become outputs, are switched on (their DDRx-Bits are
+     * set). So pins, that become outputs, start with their new
+     * voltage-level, and pins, that become inputs, are never driven with
+     * their new PORTx-value (the pullup-setting) before they are released.
+     * Pins of the ports, that are not changed by the transaction, keep their
+     * state.
+     */
+    void commit();
+
+    /**
+     * Discards all recorded changes.
+     */
+    void clear() { _portCount = 0; }
+
+    /**
+     * Returns true, if no changes are recorded.
+     */
+    bool isEmpty() { return _portCount == 0; }
+
+private:
+    //The changes of one port: bits, that are set (Set-masks) or cleared
+    //(Clear-masks) in the DDRx- and PORTx-Registers
+    struct _Port
+    {
+        sfr8_t* ddrReg;
+        sfr8_t* portReg;
+        uint8_t ddrSet;
+        uint8_t ddrClear;
+        uint8_t portSet;
+        uint8_t portClear;
+    };
+
+    //Returns the entry of a port (a new one, if the port is not changed yet),
+    //or 0, if the port doesn't exist or the table is full.
+    _Port* _findPort( uint8_t port );
+
+    bool _change( uint8_t port, uint8_t mask, uint8_t values, bool ddr );
+
+    _Port _ports[GPIOTRANSACTION_MAX_PORTS];
+    uint8_t _portNumbers[GPIOTRANSACTION_MAX_PORTS];
+    uint8_t _portCount;
+    bool _atomic;
+};
+
+#endif
+
+#endif /* GPIOTRANSACTION_H_ */
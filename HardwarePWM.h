@@ -0,0 +1,472 @@
+/*
+    HardwarePWM.h - PWM-Signals generated by the Timer/Counters of
+    AVR-Microcontrollers, configured at compile-time.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HARDWAREPWM_H_
+#define HARDWAREPWM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "GPIO.h"
+#include "SFR.h"
+
+#ifdef __cplusplus
+
+#ifndef F_CPU
+#error "F_CPU (the clock-frequency in Hz) must be defined for HardwarePWM.h"
+#endif
+
+/**
+ * Possible values of template-parameter `mode` of `HardwarePWM`:
+ *  - PWM_MODE_FAST: Fast-PWM. The Timer/Counter counts from 0 up to TOP and
+ *    starts again at 0. The output is on from 0 up to the duty.
+ *  - PWM_MODE_PHASE_CORRECT: Phase-Correct-PWM. The Timer/Counter counts up
+ *    to TOP and down again, so the pulses are centered in the period (half
+ *    the frequency of Fast-PWM with the same TOP). Preferred for
+ *    motor-controllers.
+ */
+#define PWM_MODE_FAST               0
+#define PWM_MODE_PHASE_CORRECT      1
+
+/**
+ * The Output-Compare-Channels of a Timer/Counter (each has its own pin,
+ * OCnA, OCnB, OCnC). Channel C only exists for the 16-Bit-Timer/Counters of
+ * the ATmega2560.
+ */
+#define PWM_CHANNEL_A               0
+#define PWM_CHANNEL_B               1
+#define PWM_CHANNEL_C               2
+
+/**
+ * Upper bound of the cycles of `setDuties` from the last read of TCNTn to
+ * the last write of an Output-Compare-Register. `setDuties` doesn't start
+ * writing within this time before TOP, so all channels are updated in the
+ * same period. The default is counted from the instructions of the writes
+ * of three 16-Bit-channels (about 40 cycles), with some reserve. The
+ * benchmarks `HardwarePWM8_writeDuties` and `HardwarePWM16_writeDuties`
+ * measure the writes (see doc/Benchmarks.md), and run_benchmarks.py warns,
+ * if they take more cycles than this value.
+ */
+#ifndef HARDWAREPWM_WRITE_CYCLES
+#define HARDWAREPWM_WRITE_CYCLES    48
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// Registers, prescalers and pins of the Timer/Counters
+//////////////////////////////////////////////////////////////////////////
+
+//Specializations for each Timer/Counter: registers (reg_t is the type of
+//TCNTn, OCRnx and ICRn), number of channels, available prescalers, and the
+//pins of the channels.
+template<uint8_t timer> struct _PWMTimer;
+
+//The prescalers of Timer/Counter 0, 1, 3, 4, 5 (clock-select-bits CSn2:0
+//are the index + 1)
+constexpr uint16_t _pwmPrescaler5( uint8_t index )
+{
+    return index == 0 ? 1 : index == 1 ? 8 : index == 2 ? 64
+         : index == 3 ? 256 : 1024;
+}
+
+//The prescalers of Timer/Counter 2
+constexpr uint16_t _pwmPrescaler7( uint8_t index )
+{
+    return index == 0 ? 1 : index == 1 ? 8 : index == 2 ? 32
+         : index == 3 ? 64 : index == 4 ? 128 : index == 5 ? 256 : 1024;
+}
+
+#define _PWM_TIMER16( n, channels, portA, pinA, portB, pinB, portC, pinC ) \
+template<> struct _PWMTimer<n>                                          \
+{                                                                       \
+    typedef sfr16_t reg_t;                                              \
+    static const bool is16Bit = true;                                   \
+    static const uint8_t channelCount = channels;                       \
+    static const uint8_t prescalerCount = 5;                            \
+    static constexpr uint16_t prescaler( uint8_t index )                \
+        { return _pwmPrescaler5( index ); }                             \
+    static sfr8_t& TCCRA() { return TCCR ## n ## A; }                   \
+    static sfr8_t& TCCRB() { return TCCR ## n ## B; }                   \
+    static reg_t& TCNT()   { return TCNT ## n; }                        \
+    static reg_t& ICR()    { return ICR ## n; }                         \
+    static reg_t& OCR( uint8_t channel );                               \
+    static constexpr uint8_t channelPort( uint8_t channel )             \
+        { return channel == 0 ? portA : channel == 1 ? portB : portC; } \
+    static constexpr uint8_t channelPin( uint8_t channel )              \
+        { return channel == 0 ? pinA : channel == 1 ? pinB : pinC; }    \
+};
+
+#define _PWM_TIMER8( n, prescalers, portA, pinA, portB, pinB )          \
+template<> struct _PWMTimer<n>                                          \
+{                                                                       \
+    typedef sfr8_t reg_t;                                               \
+    static const bool is16Bit = false;                                  \
+    static const uint8_t channelCount = 2;                              \
+    static const uint8_t prescalerCount = prescalers;                   \
+    static constexpr uint16_t prescaler( uint8_t index )                \
+        { return prescalers == 7 ? _pwmPrescaler7( index )              \
+                                 : _pwmPrescaler5( index ); }           \
+    static sfr8_t& TCCRA() { return TCCR ## n ## A; }                   \
+    static sfr8_t& TCCRB() { return TCCR ## n ## B; }                   \
+    static reg_t& TCNT()   { return TCNT ## n; }                        \
+    static reg_t& OCR( uint8_t channel )                                \
+        { return channel == 0 ? OCR ## n ## A : OCR ## n ## B; }        \
+    static constexpr uint8_t channelPort( uint8_t channel )             \
+        { return channel == 0 ? portA : portB; }                        \
+    static constexpr uint8_t channelPin( uint8_t channel )              \
+        { return channel == 0 ? pinA : pinB; }                          \
+};
+
+#if defined(__AVR_ATmega2560__)
+_PWM_TIMER8(  0, 5, port_B, 7, port_G, 5 )
+_PWM_TIMER16( 1, 3, port_B, 5, port_B, 6, port_B, 7 )
+_PWM_TIMER8(  2, 7, port_B, 4, port_H, 6 )
+_PWM_TIMER16( 3, 3, port_E, 3, port_E, 4, port_E, 5 )
+_PWM_TIMER16( 4, 3, port_H, 3, port_H, 4, port_H, 5 )
+_PWM_TIMER16( 5, 3, port_L, 3, port_L, 4, port_L, 5 )
+inline sfr16_t& _PWMTimer<1>::OCR( uint8_t c ) { return c == 0 ? OCR1A : c == 1 ? OCR1B : OCR1C; }
+inline sfr16_t& _PWMTimer<3>::OCR( uint8_t c ) { return c == 0 ? OCR3A : c == 1 ? OCR3B : OCR3C; }
+inline sfr16_t& _PWMTimer<4>::OCR( uint8_t c ) { return c == 0 ? OCR4A : c == 1 ? OCR4B : OCR4C; }
+inline sfr16_t& _PWMTimer<5>::OCR( uint8_t c ) { return c == 0 ? OCR5A : c == 1 ? OCR5B : OCR5C; }
+#elif defined(__AVR_ATmega328P__)
+_PWM_TIMER8(  0, 5, port_D, 6, port_D, 5 )
+_PWM_TIMER16( 1, 2, port_B, 1, port_B, 2, 0, 0 )
+_PWM_TIMER8(  2, 7, port_B, 3, port_D, 3 )
+inline sfr16_t& _PWMTimer<1>::OCR( uint8_t c ) { return c == 0 ? OCR1A : OCR1B; }
+#endif
+
+#undef _PWM_TIMER8
+#undef _PWM_TIMER16
+
+//TOP of a 16-Bit-Timer/Counter for the frequency and a prescaler
+constexpr uint32_t _pwmTop16( uint16_t prescaler, uint32_t frequency,
+                              uint8_t mode )
+{
+    return mode == PWM_MODE_FAST
+           ? F_CPU / ((uint32_t)prescaler * frequency) - 1
+           : F_CPU / (2UL * prescaler * frequency);
+}
+
+//Frequency of an 8-Bit-Timer/Counter (TOP = 255) with a prescaler
+constexpr uint32_t _pwmFrequency8( uint16_t prescaler, uint8_t mode )
+{
+    return mode == PWM_MODE_FAST ? F_CPU / (256UL * prescaler)
+                                 : F_CPU / (510UL * prescaler);
+}
+
+constexpr uint32_t _pwmDistance( uint32_t a, uint32_t b )
+{
+    return a > b ? a - b : b - a;
+}
+
+//Index of the prescaler of a 16-Bit-Timer/Counter: the smallest one (best
+//resolution), with which TOP fits into 16 bits
+template<typename Timer>
+constexpr uint8_t _pwmIndex16( uint32_t frequency, uint8_t mode,
+                               uint8_t i = 0 )
+{
+    return (i + 1 >= Timer::prescalerCount
+            || _pwmTop16( Timer::prescaler(i), frequency, mode ) <= 0xFFFF)
+           ? i : _pwmIndex16<Timer>( frequency, mode, i + 1 );
+}
+
+//Index of the prescaler of an 8-Bit-Timer/Counter: the one giving the
+//nearest frequency
+template<typename Timer>
+constexpr uint8_t _pwmIndex8( uint32_t frequency, uint8_t mode,
+                              uint8_t i = 1, uint8_t best = 0 )
+{
+    return i >= Timer::prescalerCount ? best
+         : _pwmIndex8<Timer>( frequency, mode, i + 1,
+               _pwmDistance( _pwmFrequency8( Timer::prescaler(i), mode ), frequency )
+               < _pwmDistance( _pwmFrequency8( Timer::prescaler(best), mode ), frequency )
+               ? i : best );
+}
+
+//Writes TOP into ICRn (only 16-Bit-Timer/Counters have it)
+template<bool is16Bit> struct _PWMTop
+{
+    template<typename Timer> static void set( uint16_t ) { }
+};
+
+template<> struct _PWMTop<true>
+{
+    template<typename Timer> static void set( uint16_t top ) { Timer::ICR() = top; }
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// HardwarePWM
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Template-class for a Timer/Counter generating PWM-Signals on its
+ * Output-Compare-pins (OCnA, OCnB and OCnC). Everything, that can be
+ * computed at compile-time, is computed at compile-time: the prescaler, TOP
+ * and the register-values.
+ *
+ * - 16-Bit-Timer/Counters (1, 3, 4, 5): TOP is stored in ICRn, and the
+ *   smallest prescaler (best resolution) is chosen, with which TOP fits into
+ *   16 bits. So the frequency is (nearly) exact.
+ * - 8-Bit-Timer/Counters (0, 2): TOP is 255, and the prescaler giving the
+ *   nearest frequency is chosen. `FREQUENCY` is the actual frequency.
+ *
+ * The duty of a channel is a value between 0 (always off) and `TOP` (always
+ * on). The Output-Compare-Registers are double-buffered by the hardware: a
+ * new duty takes effect at the end of the current period (at TOP or BOTTOM),
+ * so a period is never cut or doubled. The methods additionally write the
+ * 16-Bit-registers with interrupts disabled (an Interrupt-Service-Routine
+ * accessing another 16-Bit-register between the two bytes would corrupt
+ * the value), and `setDuties` updates several channels within the same
+ * period. In Fast-PWM the new duty is taken over at BOTTOM (right after
+ * TOP), in Phase-Correct-PWM at TOP.
+ *
+ * Note: In Fast-PWM a duty of 0 still produces a pulse of one tick per
+ * period (a property of the hardware). Use `disableChannel` or
+ * Phase-Correct-PWM, if the output must stay off.
+ *
+ * The Timer/Counter can't be used for other purposes at the same time, for
+ * example Timer/Counter1 (or 3) by the timebase (Timebase.h), or
+ * Timer/Counter2 by the Software-PWM (SoftPWM.h).
+ *
+ * For example a 20kHz-PWM for two motors on the pins OC4A and OC4B (PH3
+ * and PH4 on the ATmega2560):
+ * {@code
+ *     typedef HardwarePWM<4, 20000, PWM_MODE_PHASE_CORRECT> MotorPWM;
+ *     MotorPWM::init();
+ *     MotorPWM::enableChannel( PWM_CHANNEL_A );
+ *     MotorPWM::enableChannel( PWM_CHANNEL_B );
+ *     MotorPWM::setDuties( MotorPWM::TOP / 2, MotorPWM::TOP / 4 );
+ * }
+ *
+ * @param timer The number of the Timer/Counter (0...5 on the ATmega2560,
+ *      0...2 on the ATmega328p). A Timer/Counter, that doesn't exist,
+ *      results in a compile-error.
+ * @param frequency The PWM-frequency in Hz.
+ * @param mode PWM_MODE_FAST or PWM_MODE_PHASE_CORRECT
+ */
+template<uint8_t timer, uint32_t frequency, uint8_t mode = PWM_MODE_FAST>
+class HardwarePWM
+{
+    typedef _PWMTimer<timer> _Timer;
+    typedef typename _Timer::reg_t _reg_t;
+
+    static constexpr uint8_t _INDEX = _Timer::is16Bit
+        ? _pwmIndex16<_Timer>( frequency, mode )
+        : _pwmIndex8<_Timer>( frequency, mode );
+
+public:
+    /** The prescaler of the Timer/Counter */
+    static constexpr uint16_t PRESCALER = _Timer::prescaler( _INDEX );
+
+    /** The maximum duty (the duty for "always on") */
+    static constexpr uint16_t TOP = _Timer::is16Bit
+        ? (uint16_t)_pwmTop16( PRESCALER, frequency, mode ) : 255;
+
+    /** The actual PWM-frequency in Hz */
+    static constexpr uint32_t FREQUENCY = mode == PWM_MODE_FAST
+        ? F_CPU / ((uint32_t)PRESCALER * (TOP + 1UL))
+        : F_CPU / (2UL * PRESCALER * TOP);
+
+private:
+    static_assert( frequency > 0, "frequency must not be 0" );
+    static_assert( !_Timer::is16Bit
+                   || _pwmTop16( PRESCALER, frequency, mode ) <= 0xFFFF,
+                   "frequency is too low for this Timer/Counter" );
+
+    //Ticks before TOP, in which `setDuties` waits for the next period,
+    //because writing all channels might not finish before the end of the
+    //period: HARDWAREPWM_WRITE_CYCLES rounded up to ticks, plus one tick,
+    //because TCNTn may have been read at the end of a tick.
+    static constexpr uint16_t _MARGIN =
+        (HARDWAREPWM_WRITE_CYCLES + PRESCALER - 1) / PRESCALER + 1;
+
+    static_assert( TOP > 4 * _MARGIN,
+                   "frequency is too high for a useful resolution" );
+
+    //Bits COMnx1:0 of channel x in TCCRnA (10: non-inverting PWM)
+    static constexpr uint8_t _comMask( uint8_t channel )
+    {
+        return (uint8_t)(0xC0 >> (2*channel));
+    }
+    static constexpr uint8_t _comNonInverting( uint8_t channel )
+    {
+        return (uint8_t)(0x80 >> (2*channel));
+    }
+
+    //Bits WGMn1:0 in TCCRnA and WGMn3:2 in TCCRnB:
+    // 8 Bit: Fast-PWM TOP=0xFF (mode 3), Phase-Correct TOP=0xFF (mode 1)
+    //16 Bit: Fast-PWM TOP=ICRn (mode 14), Phase-Correct TOP=ICRn (mode 10)
+    static constexpr uint8_t _WGM_A = _Timer::is16Bit ? 0x02
+                                    : (mode == PWM_MODE_FAST ? 0x03 : 0x01);
+    static constexpr uint8_t _WGM_B = !_Timer::is16Bit ? 0x00
+                                    : (mode == PWM_MODE_FAST ? 0x18 : 0x10);
+
+public:
+    /**
+     * Configures the Timer/Counter and starts it. All channels are
+     * disabled (their pins are ordinary GPIO-Pins), and their duties are 0.
+     */
+    static void init()
+    {
+        uint8_t sreg = SREG;
+        cli();
+        _Timer::TCCRB() = 0;                  //stop
+        _Timer::TCCRA() = _WGM_A;
+        _PWMTop<_Timer::is16Bit>::template set<_Timer>( TOP );
+        for (uint8_t channel = 0; channel < _Timer::channelCount; channel++)
+        {
+            _Timer::OCR(channel) = 0;
+        }
+        _Timer::TCNT() = 0;
+        _Timer::TCCRB() = _WGM_B | (_INDEX + 1);   //start with the prescaler
+        SREG = sreg;
+    }
+
+    /**
+     * Connects a channel to its pin: The pin is programmed to be an output,
+     * and puts out the PWM-Signal.
+     *
+     * @param channel PWM_CHANNEL_A, PWM_CHANNEL_B or PWM_CHANNEL_C
+     */
+    static void enableChannel( uint8_t channel )
+    {
+        if (channel >= _Timer::channelCount) return;
+        writePin( _Timer::channelPort(channel), _Timer::channelPin(channel),
+                  LOW_LEVEL );
+        setPinMode( _Timer::channelPort(channel), _Timer::channelPin(channel),
+                    MODE_OUTPUT );
+        uint8_t sreg = SREG;
+        cli();
+        _Timer::TCCRA() = (_Timer::TCCRA() & ~_comMask(channel))
+                          | _comNonInverting(channel);
+        SREG = sreg;
+    }
+
+    /**
+     * Disconnects a channel from its pin. The pin is an ordinary GPIO-Pin
+     * again (an output with Low-Voltage-Level).
+     */
+    static void disableChannel( uint8_t channel )
+    {
+        if (channel >= _Timer::channelCount) return;
+        uint8_t sreg = SREG;
+        cli();
+        _Timer::TCCRA() &= ~_comMask(channel);
+        SREG = sreg;
+    }
+
+    /**
+     * Sets the duty of a channel. It takes effect at the end of the current
+     * period.
+     *
+     * @param channel PWM_CHANNEL_A, PWM_CHANNEL_B or PWM_CHANNEL_C
+     * @param duty 0 (always off) ... TOP (always on). Greater values are
+     *      limited to TOP.
+     */
+    static void setDuty( uint8_t channel, uint16_t duty )
+    {
+        if (channel >= _Timer::channelCount) return;
+        _writeOCR( channel, _limit(duty) );
+    }
+
+    /**
+     * Sets the duties of the channels A and B, so that both take effect at
+     * the end of the same period (it waits up to a few ticks, if the period
+     * is nearly over).
+     */
+    static void setDuties( uint16_t dutyA, uint16_t dutyB )
+    {
+        uint8_t sreg = SREG;
+        cli();
+        _waitForSafeWindow();
+        _writeDuties( dutyA, dutyB );
+        SREG = sreg;
+    }
+
+    /**
+     * Sets the duties of the channels A, B and C (only Timer/Counters with
+     * 3 channels), so that all take effect at the end of the same period.
+     */
+    static void setDuties( uint16_t dutyA, uint16_t dutyB, uint16_t dutyC )
+    {
+        static_assert( _Timer::channelCount == 3,
+                       "This Timer/Counter has no channel C" );
+        uint8_t sreg = SREG;
+        cli();
+        _waitForSafeWindow();
+        _writeDuties( dutyA, dutyB, dutyC );
+        SREG = sreg;
+    }
+
+    //The writes of `setDuties` without waiting, with interrupts disabled.
+    //Only used by `setDuties` and by the benchmarks, which measure their
+    //cycles (see HARDWAREPWM_WRITE_CYCLES).
+    static inline void _writeDuties( uint16_t dutyA, uint16_t dutyB )
+        __attribute__((always_inline))
+    {
+        _Timer::OCR(PWM_CHANNEL_A) = _limit(dutyA);
+        _Timer::OCR(PWM_CHANNEL_B) = _limit(dutyB);
+    }
+
+    static inline void _writeDuties( uint16_t dutyA, uint16_t dutyB,
+                                     uint16_t dutyC )
+        __attribute__((always_inline))
+    {
+        _Timer::OCR(PWM_CHANNEL_A) = _limit(dutyA);
+        _Timer::OCR(PWM_CHANNEL_B) = _limit(dutyB);
+        _Timer::OCR(PWM_CHANNEL_C) = _limit(dutyC);
+    }
+
+private:
+    static uint16_t _limit( uint16_t duty )
+    {
+        return duty > TOP ? (uint16_t)TOP : duty;
+    }
+
+    static void _writeOCR( uint8_t channel, uint16_t value )
+    {
+        if (_Timer::is16Bit)
+        {
+            //the two bytes go through the shared TEMP-register
+            uint8_t sreg = SREG;
+            cli();
+            _Timer::OCR(channel) = value;
+            SREG = sreg;
+        }
+        else
+        {
+            _Timer::OCR(channel) = value;
+        }
+    }
+
+    //Waits (with interrupts disabled), while the counter is within _MARGIN
+    //ticks of TOP, where the double-buffered registers are updated.
+    static void _waitForSafeWindow()
+    {
+        while ((uint16_t)_Timer::TCNT() >= TOP - _MARGIN) { }
+    }
+};
+
+#endif
+
+#endif /* HARDWAREPWM_H_ */
@@ -0,0 +1,329 @@
+/*
+    MCUCapabilities.h - Tables of the GPIO-Pins, external Interrupts,
+    Pin-Change-Interrupts and analog inputs, that exist on an
+    AVR-Microcontroller, for checks at compile-time.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MCUCAPABILITIES_H_
+#define MCUCAPABILITIES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+#include "GPIOPorts.h"
+
+#ifdef __cplusplus
+
+/**
+ * The functions of this header are `constexpr`: With constant arguments they
+ * are computed by the compiler, so they can be used in `static_assert` and
+ * as template-arguments, and cost nothing on the microcontroller. The
+ * templates of this library (`FastPin`, `FastExtInt`, ...) use them to
+ * reject pins and external Interrupts, that don't exist, with a
+ * compile-error instead of a check at runtime.
+ */
+
+//////////////////////////////////////////////////////////////////////////
+// GPIO-Pins
+//////////////////////////////////////////////////////////////////////////
+
+//The existing pins (1-Bits) of each port, indexed by the port-number
+#if defined(__AVR_ATmega2560__)
+constexpr uint8_t _mcuPortPinMasks[GPIO_PORT_COUNT] =
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,     //A ... F
+    0x3F,                                   //G: PG0 ... PG5
+    0xFF, 0x00, 0xFF, 0xFF, 0xFF            //H, (I), J, K, L
+};
+#elif defined(__AVR_ATmega328P__)
+constexpr uint8_t _mcuPortPinMasks[GPIO_PORT_COUNT] =
+{
+    0x00,
+    0xFF,                                   //B: PB6, PB7 with crystal
+    0x7F,                                   //C: PC0 ... PC6 (PC6 is RESET)
+    0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+#else
+//other microcontrollers: all pins of the ports defined in <avr/io.h>
+#ifdef PORTA
+#define _MCU_PORTA 0xFF
+#else
+#define _MCU_PORTA 0x00
+#endif
+#ifdef PORTB
+#define _MCU_PORTB 0xFF
+#else
+#define _MCU_PORTB 0x00
+#endif
+#ifdef PORTC
+#define _MCU_PORTC 0xFF
+#else
+#define _MCU_PORTC 0x00
+#endif
+#ifdef PORTD
+#define _MCU_PORTD 0xFF
+#else
+#define _MCU_PORTD 0x00
+#endif
+#ifdef PORTE
+#define _MCU_PORTE 0xFF
+#else
+#define _MCU_PORTE 0x00
+#endif
+#ifdef PORTF
+#define _MCU_PORTF 0xFF
+#else
+#define _MCU_PORTF 0x00
+#endif
+#ifdef PORTG
+#define _MCU_PORTG 0xFF
+#else
+#define _MCU_PORTG 0x00
+#endif
+#ifdef PORTH
+#define _MCU_PORTH 0xFF
+#else
+#define _MCU_PORTH 0x00
+#endif
+#ifdef PORTJ
+#define _MCU_PORTJ 0xFF
+#else
+#define _MCU_PORTJ 0x00
+#endif
+#ifdef PORTK
+#define _MCU_PORTK 0xFF
+#else
+#define _MCU_PORTK 0x00
+#endif
+#ifdef PORTL
+#define _MCU_PORTL 0xFF
+#else
+#define _MCU_PORTL 0x00
+#endif
+constexpr uint8_t _mcuPortPinMasks[GPIO_PORT_COUNT] =
+{
+    _MCU_PORTA, _MCU_PORTB, _MCU_PORTC, _MCU_PORTD, _MCU_PORTE, _MCU_PORTF,
+    _MCU_PORTG, _MCU_PORTH, 0x00, _MCU_PORTJ, _MCU_PORTK, _MCU_PORTL
+};
+#endif
+
+/**
+ * Returns the pins (1-Bits), that exist on a port, or 0, if the port
+ * doesn't exist.
+ *
+ * @param port A number between 0 (port A) and up to 11 (port L). One of the
+ *      Macros port_A to port_L should be used for this parameter.
+ */
+constexpr uint8_t mcuPortPinMask( uint8_t port )
+{
+    return port < GPIO_PORT_COUNT ? _mcuPortPinMasks[port] : 0x00;
+}
+
+/**
+ * Returns true, if a port exists on the microcontroller.
+ */
+constexpr bool mcuPortExists( uint8_t port )
+{
+    return mcuPortPinMask( port ) != 0x00;
+}
+
+/**
+ * Returns true, if a GPIO-Pin exists on the microcontroller.
+ *
+ * @param port The port, for example port_A.
+ * @param pinNumber The number of the pin (0...7)
+ */
+constexpr bool mcuPinExists( uint8_t port, uint8_t pinNumber )
+{
+    return pinNumber < 8 && (mcuPortPinMask( port ) & (0x01 << pinNumber));
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// External Interrupts
+//////////////////////////////////////////////////////////////////////////
+
+//The pin of each external Interrupt (INT0, INT1, ...): the port in the high
+//nibble, the pin-number in the low nibble
+#if defined(__AVR_ATmega2560__)
+constexpr uint8_t _mcuExtIntPins[] =
+{
+    (port_D<<4) | 0, (port_D<<4) | 1, (port_D<<4) | 2, (port_D<<4) | 3,
+    (port_E<<4) | 4, (port_E<<4) | 5, (port_E<<4) | 6, (port_E<<4) | 7
+};
+#elif defined(__AVR_ATmega328P__)
+constexpr uint8_t _mcuExtIntPins[] =
+{
+    (port_D<<4) | 2, (port_D<<4) | 3
+};
+#else
+//other microcontrollers: the pins are not known
+constexpr uint8_t _mcuExtIntPins[1] = { 0xFF };
+#define _MCU_EXT_INT_UNKNOWN
+#endif
+
+/**
+ * Returns the number of external Interrupts (INT0, INT1, ...), whose pins
+ * are known (0 for other microcontrollers than the ATmega2560 and the
+ * ATmega328p).
+ */
+constexpr uint8_t mcuExtIntCount()
+{
+#ifdef _MCU_EXT_INT_UNKNOWN
+    return 0;
+#else
+    return sizeof(_mcuExtIntPins) / sizeof(_mcuExtIntPins[0]);
+#endif
+}
+
+/**
+ * Returns true, if the external Interrupt INT<extIntNumber> exists.
+ */
+constexpr bool mcuExtIntExists( uint8_t extIntNumber )
+{
+    return extIntNumber < mcuExtIntCount();
+}
+
+/**
+ * Returns the port of the pin of an external Interrupt (for example port_D
+ * for INT2 on the ATmega2560), or 0xFF, if it doesn't exist.
+ */
+constexpr uint8_t mcuExtIntPort( uint8_t extIntNumber )
+{
+    return mcuExtIntExists( extIntNumber )
+           ? (_mcuExtIntPins[extIntNumber] >> 4) : 0xFF;
+}
+
+/**
+ * Returns the pin-number of the pin of an external Interrupt (for example 2
+ * for INT2 on the ATmega2560), or 0xFF, if it doesn't exist.
+ */
+constexpr uint8_t mcuExtIntPinNumber( uint8_t extIntNumber )
+{
+    return mcuExtIntExists( extIntNumber )
+           ? (_mcuExtIntPins[extIntNumber] & 0x0F) : 0xFF;
+}
+
+/**
+ * Returns the external Interrupts (1-Bits), whose edges are detected
+ * without a clock, so they wake up the microcontroller from any sleep-mode
+ * (INT3:0 on the ATmega2560). The other external Interrupts need the
+ * I/O-clock for edges: only a low level wakes them up from Power-down.
+ */
+constexpr uint8_t mcuExtIntAsyncMask()
+{
+#if defined(__AVR_ATmega2560__)
+    return 0x0F;
+#else
+    return 0x00;
+#endif
+}
+
+constexpr uint8_t _mcuExtIntNumberForPin( uint8_t port, uint8_t pinNumber,
+                                          uint8_t extIntNumber )
+{
+    return extIntNumber >= mcuExtIntCount() ? 0xFF
+         : (mcuExtIntPort( extIntNumber ) == port
+            && mcuExtIntPinNumber( extIntNumber ) == pinNumber) ? extIntNumber
+         : _mcuExtIntNumberForPin( port, pinNumber, extIntNumber + 1 );
+}
+
+/**
+ * Returns the number of the external Interrupt on a GPIO-Pin (for example 2
+ * for PD2 on the ATmega2560), or 0xFF, if the pin has no external
+ * Interrupt.
+ *
+ * @param port The port, for example port_D.
+ * @param pinNumber The number of the pin (0...7)
+ */
+constexpr uint8_t mcuExtIntNumberForPin( uint8_t port, uint8_t pinNumber )
+{
+    return _mcuExtIntNumberForPin( port, pinNumber, 0 );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Pin-Change-Interrupts
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns the Pin-Change-Interrupts (1-Bits), that exist in a bank (bank 0
+ * is PCINT0 ... PCINT7, bank 1 PCINT8 ... PCINT15, bank 2 PCINT16 ...
+ * PCINT23), or 0, if the bank doesn't exist. On the ATmega328p, PCINT15
+ * doesn't exist (there is no pin PC7).
+ */
+constexpr uint8_t mcuPinChangeIntMask( uint8_t bank )
+{
+#if defined(__AVR_ATmega328P__)
+    return bank == 1 ? 0x7F : bank < 3 ? 0xFF : 0x00;
+#else
+    return bank < 3 ? 0xFF : 0x00;
+#endif
+}
+
+/**
+ * Returns true, if the Pin-Change-Interrupt PCINT<pcintNumber> exists.
+ */
+constexpr bool mcuPinChangeIntExists( uint8_t pcintNumber )
+{
+    return (mcuPinChangeIntMask( pcintNumber / 8 )
+            & (0x01 << (pcintNumber % 8))) != 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Analog-Digital-Converter
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns true, if the single-ended input-channel exists on the
+ * Analog-Digital-Converter: ADC0 ... ADC15 on the ATmega2560; ADC0 ... ADC7,
+ * the temperature-sensor (8), the bandgap-reference (14) and GND (15) on the
+ * ATmega328p.
+ */
+constexpr bool mcuAnalogChannelExists( uint8_t channel )
+{
+#if defined(__AVR_ATmega2560__)
+    return channel < 16;
+#elif defined(__AVR_ATmega328P__)
+    return channel <= 8 || channel == 14 || channel == 15;
+#else
+    return channel < 8;
+#endif
+}
+
+/**
+ * Returns true, if the analog input-channel is on a GPIO-Pin, whose digital
+ * input-buffer can be disabled (with the DIDRn-Registers).
+ */
+constexpr bool mcuAnalogChannelOnPin( uint8_t channel )
+{
+#if defined(__AVR_ATmega2560__)
+    return channel < 16;
+#elif defined(__AVR_ATmega328P__)
+    return channel < 6;     //ADC7:6 of the TQFP-package have no GPIO-Pin
+#else
+    return channel < 8;
+#endif
+}
+
+#endif
+
+#endif /* MCUCAPABILITIES_H_ */
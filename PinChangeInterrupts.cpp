@@ -0,0 +1,214 @@
+/*
+    PinChangeInterrupts.cpp - A Library for Interrupts caused by
+    voltage-level-changes on the PCINTx-Pins of AVR-Microcontrollers
+    (The so called Pin-Change-Interrupts).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "PinChangeInterrupts.h"
+#include "MCUCapabilities.h"
+
+#if !defined(PCINT2_vect)
+    #error "There are no three banks of Pin-Change-Interrupts. Don't use this module"
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// "private" data and helper-functions
+//////////////////////////////////////////////////////////////////////////
+
+//The handler-table: One function for each pin of each bank
+static PinChangeHandler _handlers[3][8];
+
+//Pins of each bank, that are enabled and have a handler. Only for these
+//pins the Interrupt-Service-Routine calls the handler.
+static uint8_t _dispatchMasks[3];
+
+//Voltage-levels of the pins of each bank at the last interrupt
+static uint8_t _lastLevels[3];
+
+//Returns the voltage-levels of the eight pins of a bank. Bit n is the level
+//of pin PCINT(8*bank+n).
+static inline uint8_t _readBank( uint8_t bank )
+{
+    switch (bank)
+    {
+        case 0:
+            return PINB;
+
+        case 1:
+            #if defined(__AVR_ATmega2560__)
+            //PCINT8 is PE0, PCINT9...PCINT15 are PJ0...PJ6
+            return (PINE & 0x01) | (PINJ << 1);
+            #else
+            return PINC;
+            #endif
+
+        default:
+            #if defined(__AVR_ATmega2560__)
+            return PINK;
+            #else
+            return PIND;
+            #endif
+    }
+}
+
+//Returns the Pin-Change-Mask-Register PCMSKn of a bank
+static inline sfr8_t* _getPCMSKRegister( uint8_t bank )
+{
+    switch (bank)
+    {
+        case 0:  return &PCMSK0;
+        case 1:  return &PCMSK1;
+        default: return &PCMSK2;
+    }
+}
+
+//Recalculates, for which pins of a bank the Interrupt-Service-Routine
+//calls a handler
+static void _updateDispatchMask( uint8_t bank )
+{
+    uint8_t mask = 0;
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+        if (_handlers[bank][bit]) mask |= (0x01<<bit);
+    }
+    _dispatchMasks[bank] = mask & *_getPCMSKRegister(bank);
+}
+
+//Marks the wake-up for the statistics of the event-loop (see EventLoop.h).
+//A weak reference: without EventLoop.cpp its address is 0.
+extern "C" void markEventLoopWake( void ) __attribute__((weak));
+
+//Called by the three Interrupt-Service-Routines. Calls the handlers of the 
+//pins, whose voltage-levels have changed since the last interrupt.
+static inline void _dispatch( uint8_t bank, uint8_t levels )
+{
+    if (markEventLoopWake) markEventLoopWake();
+
+    uint8_t changed = (levels ^ _lastLevels[bank]) & _dispatchMasks[bank];
+    _lastLevels[bank] = levels;
+
+    const PinChangeHandler* handler = _handlers[bank];
+    for (uint8_t mask = 0x01; changed; mask <<= 1, handler++)
+    {
+        if (changed & mask)
+        {
+            changed &= ~mask;
+            (*handler)( (levels & mask) ? HIGH_LEVEL : LOW_LEVEL );
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Interrupt-Service-Routines
+//////////////////////////////////////////////////////////////////////////
+
+ISR(PCINT0_vect)
+{
+    _dispatch( 0, _readBank(0) );
+}
+
+ISR(PCINT1_vect)
+{
+    _dispatch( 1, _readBank(1) );
+}
+
+ISR(PCINT2_vect)
+{
+    _dispatch( 2, _readBank(2) );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Functions-API
+//////////////////////////////////////////////////////////////////////////
+
+void setPinChangeIntHandler( uint8_t pcintNumber, PinChangeHandler handler )
+{
+    if (!mcuPinChangeIntExists( pcintNumber )) return;
+    uint8_t bank = pcintNumber / 8;
+
+    uint8_t sreg = SREG;
+    cli();
+    _handlers[bank][pcintNumber % 8] = handler;
+    _updateDispatchMask( bank );
+    SREG = sreg;
+}
+
+void enablePinChangeInt( uint8_t pcintNumber )
+{
+    if (!mcuPinChangeIntExists( pcintNumber )) return;
+    uint8_t bank = pcintNumber / 8;
+    uint8_t bit = 0x01 << (pcintNumber % 8);
+
+    uint8_t sreg = SREG;
+    cli();
+    //The level of the pin at this moment is the start for detecting changes.
+    //Only its own bit: a change of another enabled pin of the bank, whose
+    //interrupt is pending, must still be detected.
+    _lastLevels[bank] = (_lastLevels[bank] & ~bit) | (_readBank( bank ) & bit);
+    *_getPCMSKRegister(bank) |= bit;
+    PCICR |= (0x01 << bank);
+    _updateDispatchMask( bank );
+    SREG = sreg;
+}
+
+void disablePinChangeInt( uint8_t pcintNumber )
+{
+    if (!mcuPinChangeIntExists( pcintNumber )) return;
+    uint8_t bank = pcintNumber / 8;
+
+    uint8_t sreg = SREG;
+    cli();
+    sfr8_t* pcmsk = _getPCMSKRegister( bank );
+    *pcmsk &= ~(0x01 << (pcintNumber % 8));
+    if (*pcmsk == 0)
+    {
+        //no pin of this bank is enabled any more
+        PCICR &= ~(0x01 << bank);
+    }
+    _updateDispatchMask( bank );
+    SREG = sreg;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// C++ object-oriented API
+//////////////////////////////////////////////////////////////////////////
+
+PinChangeInt::PinChangeInt( uint8_t pcintNumber, PinChangeHandler handler,
+                            bool enabled )
+{
+    if (!mcuPinChangeIntExists( pcintNumber ))
+    {
+        //This is an invalid object (No Pin-Change-Interrupt with this
+        //number exists)
+        _pcintNumber = 0xFF;
+        return;
+    }
+
+    _pcintNumber = pcintNumber;
+    setPinChangeIntHandler( handler );
+
+    if (enabled) 
+        enablePinChangeInt();
+    else
+        disablePinChangeInt();
+}
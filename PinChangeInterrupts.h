@@ -0,0 +1,171 @@
+/*
+    PinChangeInterrupts.h - A Library for Interrupts caused by
+    voltage-level-changes on the PCINTx-Pins of AVR-Microcontrollers
+    (The so called Pin-Change-Interrupts).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#ifndef PINCHANGEINTERRUPTS_H_
+#define PINCHANGEINTERRUPTS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GPIO.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Macros and types
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Number of Pin-Change-Interrupts (PCINT0 ... PCINT23). They are grouped in 
+ * three banks of eight: Bank 0 is PCINT0...PCINT7, bank 1 is PCINT8...PCINT15
+ * and bank 2 is PCINT16...PCINT23. All pins of a bank share one 
+ * Interrupt-vector (PCINT0_vect ... PCINT2_vect).
+ *
+ * ATmega2560: PCINT0...7 are pins PB0...PB7, PCINT8 is PE0, PCINT9...15 are
+ *             PJ0...PJ6, PCINT16...23 are PK0...PK7.
+ * ATmega328p: PCINT0...7 are pins PB0...PB7, PCINT8...14 are PC0...PC6,
+ *             PCINT16...23 are PD0...PD7. PCINT15 doesn't exist.
+ *
+ * The functions ignore numbers of Pin-Change-Interrupts, that don't exist on
+ * the microcontroller (see `mcuPinChangeIntExists` in MCUCapabilities.h),
+ * and a PinChangeInt-object for such a number is invalid.
+ */
+#define PCINT_COUNT     24
+
+/**
+ * A Pin-Change-Handler is a function, that is called from the
+ * Interrupt-Service-Routine each time the voltage-level of its PCINTx-Pin 
+ * changes. It gets the new voltage-level (`HIGH_LEVEL` or `LOW_LEVEL`) as
+ * argument. It runs with interrupts disabled, so it should be short.
+ */
+typedef void (*PinChangeHandler)( uint8_t voltageLevel );
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Sets the function, that is called, when the voltage-level of a 
+ * PCINTx-Pin changes. 
+ *
+ * This module contains the Interrupt-Service-Routines for PCINT0_vect, 
+ * PCINT1_vect and PCINT2_vect. They compare the voltage-levels of the pins
+ * of their bank with the levels at the last interrupt, and call the handlers
+ * only for the pins, that have changed and are enabled. So don't write your
+ * own ISR for these vectors, if you use this module.
+ *
+ * Latency: the first handler is called after the interrupt-response, the
+ * saving of the registers, one read of the pins of the bank and the lookup
+ * in the handler-table. The handlers of the pins, that have changed at the
+ * same time, are called one after the other, from the lowest pin-number up:
+ * each further pin adds one pass of the dispatch-loop plus the duration of
+ * the handler before it. The cycles of the Interrupt-Service-Routine of
+ * bank 0 with one changed pin are measured by the benchmark `PCINT0_vect`
+ * (see doc/Benchmarks.md).
+ *
+ * @param pcintNumber The number of the Pin-Change-Interrupt (0 ... 23).
+ * @param handler The function to call, or 0 for no function.
+ */
+void setPinChangeIntHandler( uint8_t pcintNumber, PinChangeHandler handler );
+
+/**
+ * Enables a Pin-Change-Interrupt. If Interrupts are also globally allowed
+ * (for example using `sei();` from <avr/interrupt.h>), then the handler is
+ * called, each time the voltage-level of the pin changes.
+ *
+ * The pin should be programmed to be an input (with or without pullup)
+ * before.
+ *
+ * @param pcintNumber The number of the Pin-Change-Interrupt (0 ... 23).
+ */
+void enablePinChangeInt( uint8_t pcintNumber );
+
+/**
+ * Disables a Pin-Change-Interrupt. The handler is not called any longer, if
+ * the voltage-level of the pin changes.
+ *
+ * @param pcintNumber The number of the Pin-Change-Interrupt (0 ... 23).
+ */
+void disablePinChangeInt( uint8_t pcintNumber );
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+
+//////////////////////////////////////////////////////////////////////////
+// C++ object-oriented API
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Class for Pin-Change-Interrupts. Use one PinChangeInt-Instance for each
+ * PCINTx-Pin used in your program.
+ */
+class PinChangeInt
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param pcintNumber The number of the Pin-Change-Interrupt (0 ... 23).
+     * @param handler The function, that is called, when the voltage-level
+     *      of the pin changes (see C-function `setPinChangeIntHandler`).
+     * @param enabled Fill in true or false to enable/disable the 
+     *      Pin-Change-Interrupt. Default-Value: true.
+     */
+    PinChangeInt( uint8_t pcintNumber, PinChangeHandler handler,
+                  bool enabled = true );
+
+    /**
+     * Sets the function, that is called, when the voltage-level of the pin
+     * changes.
+     *
+     * @param handler The function to call, or 0 for no function.
+     */
+    void setPinChangeIntHandler( PinChangeHandler handler )
+    { ::setPinChangeIntHandler( _pcintNumber, handler ); }
+
+    /**
+     * Enables the Pin-Change-Interrupt.
+     */
+    void enablePinChangeInt()
+    { ::enablePinChangeInt( _pcintNumber ); }
+
+    /**
+     * Disables the Pin-Change-Interrupt.
+     */
+    void disablePinChangeInt()
+    { ::disablePinChangeInt( _pcintNumber ); }
+
+private:
+    uint8_t _pcintNumber;
+};
+
+#endif
+
+
+#endif /* PINCHANGEINTERRUPTS_H_ */
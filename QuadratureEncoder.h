@@ -0,0 +1,275 @@
+/*
+    QuadratureEncoder.h - Decoding of quadrature-encoders (for example on
+    motor-shafts) with two external Interrupts of an AVR-Microcontroller.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUADRATUREENCODER_H_
+#define QUADRATUREENCODER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "GPIO.h"
+#include "ExternalInterrupts.h"
+#include "MCUCapabilities.h"
+
+#ifdef __cplusplus
+
+/**
+ * Template for a quadrature-encoder, whose channels A and B are connected to
+ * the external Interrupts `extIntA` and `extIntB`. Both external Interrupts
+ * are triggered by any edge (EXTINT_ANY_EDGE), so each edge of each channel
+ * counts (four steps per period of the encoder).
+ *
+ * The Interrupt-Service-Routine reads the pins of both channels with a
+ * single read of the port, and looks up the step (+1, -1 or 0) in a table
+ * with 16 entries, indexed by the previous and the current state of the
+ * pins: no branches for the direction. The steps are added up in an 8-bit
+ * counter, which is only added to the 32-bit position every 64 steps (and
+ * when the position is read), so the usual path needs no 32-bit
+ * arithmetic. Its cycles (without prologue and epilogue) are measured by
+ * the benchmark `QuadratureEncoder_update` (see doc/Benchmarks.md); the
+ * highest edge-rate, that can be followed, is F_CPU divided by the cycles of
+ * the whole Interrupt-Service-Routine. A transition, in which both channels
+ * have changed, is illegal: an edge was missed (the edges came faster than
+ * the Interrupt-Service-Routine, or there is noise on the lines). It doesn't
+ * change the position, but is counted.
+ *
+ * Both pins must be in the same port: INT0 ... INT3 (port D) or INT4 ...
+ * INT7 (port E) on the ATmega2560, INT0 and INT1 on the ATmega328p. Other
+ * combinations result in a compile-error.
+ *
+ * The Interrupt-Service-Routines are generated by the macro
+ * `QUADRATURE_ENCODER_HANDLER` (once for each encoder, outside of any
+ * function). They replace the Interrupt-Service-Routines of
+ * ExternalInterrupts.h for these two external Interrupts. For example two
+ * encoders on the ATmega2560:
+ * {@code
+ *     typedef QuadratureEncoder<0, 1> LeftEncoder;
+ *     typedef QuadratureEncoder<2, 3> RightEncoder;
+ *     QUADRATURE_ENCODER_HANDLER( 0, 1 )
+ *     QUADRATURE_ENCODER_HANDLER( 2, 3 )
+ *
+ *     LeftEncoder::start( PULLUP_ON );
+ *     RightEncoder::start( PULLUP_ON );
+ *     sei();
+ *     ...
+ *     int32_t distance = LeftEncoder::getPosition();
+ * }
+ */
+template<uint8_t extIntA, uint8_t extIntB>
+class QuadratureEncoder
+{
+    static_assert( extIntA != extIntB,
+                   "The two channels need different external Interrupts" );
+    static_assert( mcuExtIntPort( extIntA ) == mcuExtIntPort( extIntB ),
+                   "The pins of both channels must be in the same port" );
+
+    typedef FastExtInt<extIntA> _ExtIntA;
+    typedef FastExtInt<extIntB> _ExtIntB;
+    typedef _GPIORegisters< mcuExtIntPort( extIntA ) > _Port;
+
+    static const uint8_t _MASK_A = 0x01 << mcuExtIntPinNumber( extIntA );
+    static const uint8_t _MASK_B = 0x01 << mcuExtIntPinNumber( extIntB );
+
+    //Entry of `_STEPS` for an illegal transition
+    static const int8_t _ILLEGAL = 2;
+
+public:
+    /**
+     * Constructor. See `start`.
+     */
+    QuadratureEncoder( uint8_t pullup )
+    {
+        start( pullup );
+    }
+
+    /**
+     * Programs the pins of both channels to be inputs, sets the position and
+     * the number of illegal transitions to 0, and enables both external
+     * Interrupts for any edge. Interrupts must be globally enabled (with
+     * `sei()`).
+     *
+     * @param pullup `PULLUP_ON` (for encoders with open-collector-outputs) or
+     *      `PULLUP_OFF`
+     */
+    static void start( uint8_t pullup )
+    {
+        _ExtIntA::disableExtInt();
+        _ExtIntB::disableExtInt();
+        _ExtIntA::configurePin( pullup );
+        _ExtIntB::configurePin( pullup );
+        _ExtIntA::setExtIntEventType( EXTINT_ANY_EDGE );
+        _ExtIntB::setExtIntEventType( EXTINT_ANY_EDGE );
+
+        uint8_t sreg = SREG;
+        cli();
+        _previous = _readState() << 2;
+        _position = 0;
+        _pendingSteps = 0;
+        _illegalTransitions = 0;
+        _ExtIntA::clearPendingExtIntEvent();
+        _ExtIntB::clearPendingExtIntEvent();
+        _ExtIntA::enableExtInt();
+        _ExtIntB::enableExtInt();
+        SREG = sreg;
+    }
+
+    /**
+     * Disables both external Interrupts. The position is kept.
+     */
+    static void stop()
+    {
+        _ExtIntA::disableExtInt();
+        _ExtIntB::disableExtInt();
+    }
+
+    /**
+     * Returns the position in steps (four per period of the encoder). It is
+     * positive, if channel A leads channel B. It is read with interrupts
+     * disabled, so all four bytes belong to the same position.
+     */
+    static int32_t getPosition()
+    {
+        uint8_t sreg = SREG;
+        cli();
+        int32_t position = _position + _pendingSteps;
+        SREG = sreg;
+        return position;
+    }
+
+    /**
+     * Sets the position (for example to 0 at a reference-point).
+     */
+    static void setPosition( int32_t position )
+    {
+        uint8_t sreg = SREG;
+        cli();
+        _position = position;
+        _pendingSteps = 0;
+        SREG = sreg;
+    }
+
+    /**
+     * Returns the number of illegal transitions (up to 255) since `start` or
+     * `clearIllegalTransitions`. Each one is a lost step.
+     */
+    static uint8_t getIllegalTransitions()
+    {
+        return _illegalTransitions;
+    }
+
+    static void clearIllegalTransitions()
+    {
+        _illegalTransitions = 0;
+    }
+
+    /**
+     * Decodes the current state of the pins. Called by the
+     * Interrupt-Service-Routines of both external Interrupts (see
+     * `QUADRATURE_ENCODER_HANDLER`), not by the program.
+     */
+    static inline void update() __attribute__((always_inline))
+    {
+        //bits 3:2 are the previous state, bits 1:0 the current one
+        uint8_t index = _previous | _readState();
+        _previous = (uint8_t)(index << 2) & 0x0C;
+
+        int8_t step = _STEPS[index];
+        if (step == _ILLEGAL)
+        {
+            if (_illegalTransitions < 0xFF) _illegalTransitions++;
+            return;
+        }
+        int8_t pending = _pendingSteps + step;
+        if (pending > -64 && pending < 64)
+        {
+            _pendingSteps = pending;
+            return;
+        }
+        _position += pending;
+        _pendingSteps = 0;
+    }
+
+private:
+    //The state of the pins: bit 0 is channel A, bit 1 channel B (one read
+    //of PINx, so both belong to the same moment)
+    static uint8_t _readState() __attribute__((always_inline))
+    {
+        uint8_t pins = _Port::PINx();
+        uint8_t state = 0;
+        if (pins & _MASK_A) state |= 0x01;
+        if (pins & _MASK_B) state |= 0x02;
+        return state;
+    }
+
+    //The step for each transition: index is previous state * 4 + current
+    //state. Forward (A leads B) the states are 0, 1, 3, 2, 0, ...
+    static const int8_t _STEPS[16];
+
+    static uint8_t _previous;   //previous state, shifted left by 2
+    static volatile int32_t _position;
+    static volatile int8_t _pendingSteps;   //not yet added to _position
+    static volatile uint8_t _illegalTransitions;
+};
+
+template<uint8_t extIntA, uint8_t extIntB>
+const int8_t QuadratureEncoder<extIntA, extIntB>::_STEPS[16] =
+{
+     0, +1, -1, _ILLEGAL,
+    -1,  0, _ILLEGAL, +1,
+    +1, _ILLEGAL,  0, -1,
+    _ILLEGAL, -1, +1,  0
+};
+
+template<uint8_t extIntA, uint8_t extIntB>
+uint8_t QuadratureEncoder<extIntA, extIntB>::_previous;
+
+template<uint8_t extIntA, uint8_t extIntB>
+volatile int32_t QuadratureEncoder<extIntA, extIntB>::_position;
+
+template<uint8_t extIntA, uint8_t extIntB>
+volatile int8_t QuadratureEncoder<extIntA, extIntB>::_pendingSteps;
+
+template<uint8_t extIntA, uint8_t extIntB>
+volatile uint8_t QuadratureEncoder<extIntA, extIntB>::_illegalTransitions;
+
+
+/**
+ * Generates the Interrupt-Service-Routines of the external Interrupts
+ * INT<a> and INT<b>, that call `QuadratureEncoder<a, b>::update()`. `a` and
+ * `b` must be numbers (not variables or expressions), because the names of
+ * the Interrupt-vectors are built from them. Use it outside of any function,
+ * once for each encoder (see `QuadratureEncoder`). Handlers set with
+ * `setExtIntHandler` for these external Interrupts are ignored.
+ */
+#define QUADRATURE_ENCODER_HANDLER(a, b)                                \
+    ISR(INT ## a ## _vect)                                              \
+    {                                                                   \
+        QuadratureEncoder< a, b >::update();                            \
+    }                                                                   \
+    ISR(INT ## b ## _vect)                                              \
+    {                                                                   \
+        QuadratureEncoder< a, b >::update();                            \
+    }
+
+#endif
+
+#endif /* QUADRATUREENCODER_H_ */
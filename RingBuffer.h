@@ -0,0 +1,171 @@
+/*
+    RingBuffer.h - A queue for passing data from an Interrupt-Service-Routine
+    to the main-loop (or vice versa) without disabling interrupts.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RINGBUFFER_H_
+#define RINGBUFFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+
+/**
+ * Template-class for a ring-buffer (a queue with a fixed capacity), that is
+ * filled by exactly one "producer" (for example an Interrupt-Service-Routine)
+ * and emptied by exactly one "consumer" (for example the main-loop).
+ *
+ * Neither side has to disable interrupts: The producer only changes the
+ * write-index, the consumer only changes the read-index, and both indices
+ * are 8-bit-values, which the AVR reads and writes with a single
+ * instruction. An item is written completely, before the write-index makes
+ * it visible to the consumer.
+ *
+ * For example, an Interrupt-Service-Routine puts values into the buffer,
+ * and the main-loop takes them out:
+ * {@code
+ *     RingBuffer<uint16_t, 16> samples;
+ *
+ *     ISR(ADC_vect) { samples.push( ADC ); }
+ *
+ *     int main() {
+ *         //...
+ *         uint16_t sample;
+ *         while (samples.pop( sample )) { ... }
+ *     }
+ * }
+ *
+ * @param T The type of the items. Items are copied into and out of the
+ *      buffer, so they should be small.
+ * @param capacity The maximum number of items in the buffer. Must be a
+ *      power of two between 2 and 128.
+ */
+template<typename T, uint8_t capacity>
+class RingBuffer
+{
+    static_assert( capacity >= 2 && capacity <= 128
+                   && (capacity & (capacity-1)) == 0,
+                   "capacity must be a power of two between 2 and 128" );
+
+public:
+    RingBuffer() : _writeIndex(0), _readIndex(0), _dropCount(0) { }
+
+    /**
+     * Puts an item into the buffer. Only the producer may call this method.
+     *
+     * @param item The item to put into the buffer.
+     * @return true, if the item has been put into the buffer. false, if the
+     *      buffer is full (the item is lost and the drop-count is increased).
+     */
+    bool push( const T& item )
+    {
+        uint8_t writeIndex = _writeIndex;
+        if ((uint8_t)(writeIndex - _readIndex) == capacity)
+        {
+            if (_dropCount != 0xFF) _dropCount++;
+            return false;
+        }
+
+        _items[writeIndex & (capacity-1)] = item;
+        _barrier(); //the item must be written, before the index shows it
+        _writeIndex = writeIndex + 1;
+        return true;
+    }
+
+    /**
+     * Takes the oldest item out of the buffer. Only the consumer may call this
+     * method.
+     *
+     * @param item Receives the item.
+     * @return true, if an item has been taken. false, if the buffer is empty
+     *      (`item` is unchanged).
+     */
+    bool pop( T& item )
+    {
+        uint8_t readIndex = _readIndex;
+        if (readIndex == _writeIndex) return false;
+        _barrier(); //the item must not be read, before the index shows it
+
+        item = _items[readIndex & (capacity-1)];
+        _barrier(); //the item must be read, before the index frees its place
+        _readIndex = readIndex + 1;
+        return true;
+    }
+
+    /**
+     * Returns a pointer to the oldest item without taking it out of the
+     * buffer, or a null-pointer, if the buffer is empty. Only the consumer
+     * may call this method. The item stays valid until `pop` or `discard`
+     * is called.
+     */
+    const T* peek() const
+    {
+        uint8_t readIndex = _readIndex;
+        if (readIndex == _writeIndex) return 0;
+        _barrier(); //the item must not be read, before the index shows it
+        return (const T*)&_items[readIndex & (capacity-1)];
+    }
+
+    /**
+     * Removes the oldest item from the buffer (after using `peek`). Only the
+     * consumer may call this method.
+     */
+    void discard()
+    {
+        uint8_t readIndex = _readIndex;
+        if (readIndex == _writeIndex) return;
+        _barrier();
+        _readIndex = readIndex + 1;
+    }
+
+    /**
+     * Returns the number of items in the buffer.
+     */
+    uint8_t getCount() const { return (uint8_t)(_writeIndex - _readIndex); }
+
+    /**
+     * Returns true, if there are no items in the buffer.
+     */
+    bool isEmpty() const { return _writeIndex == _readIndex; }
+
+    /**
+     * Returns true, if no more items fit into the buffer.
+     */
+    bool isFull() const { return getCount() == capacity; }
+
+    /**
+     * Returns the number of items, that have been lost, because the buffer
+     * was full (counts up to 255).
+     */
+    uint8_t getDropCount() const { return _dropCount; }
+
+private:
+    //Prevents the compiler from moving memory-accesses across this point.
+    //(The AVR itself executes them in the order of the program).
+    static void _barrier() { __asm__ __volatile__ ( "" ::: "memory" ); }
+
+    T _items[capacity];
+    volatile uint8_t _writeIndex;
+    volatile uint8_t _readIndex;
+    volatile uint8_t _dropCount;
+};
+
+#endif
+
+#endif /* RINGBUFFER_H_ */
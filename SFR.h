@@ -0,0 +1,49 @@
+/*
+    SFR.h - Types for accessing the Special-Function-Registers of
+    AVR-Microcontrollers. This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#ifndef SFR_H_
+#define SFR_H_
+
+#include <avr/io.h>
+
+/**
+ * Type of an 8-Bit-Special-Function-Register (like PORTB or EIMSK). Use it,
+ * when a reference or a pointer to a Special-Function-Register is needed.
+ *
+ * On the microcontroller this is just `volatile uint8_t`. If the library is
+ * compiled for the host (see doc/Host.md), <avr/io.h> is replaced by
+ * host/avr/io.h, and the Special-Function-Registers are objects, that count
+ * each read- and write-access.
+ */
+#ifdef SIMPLEAVRLIB_HOST
+typedef HostRegister8 sfr8_t;
+#else
+typedef volatile uint8_t sfr8_t;
+#endif
+
+/**
+ * Type of a 16-Bit-Special-Function-Register (like UBRR0 or OCR1A).
+ */
+#ifdef SIMPLEAVRLIB_HOST
+typedef HostRegister16 sfr16_t;
+#else
+typedef volatile uint16_t sfr16_t;
+#endif
+
+#endif /* SFR_H_ */
@@ -0,0 +1,181 @@
+/*
+    SPIMaster.cpp - Interrupt-driven SPI-master of an AVR-Microcontroller, that
+    carries out a queue of transactions with their own chip-select-pins.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "SPIMaster.h"
+
+//The pins of the SPI-interface (all on port B)
+#if defined(__AVR_ATmega2560__)
+#define _SPI_SS     0
+#define _SPI_SCK    1
+#define _SPI_MOSI   2
+#define _SPI_MISO   3
+#else
+#define _SPI_SS     2
+#define _SPI_MOSI   3
+#define _SPI_MISO   4
+#define _SPI_SCK    5
+#endif
+
+static_assert( SPI_QUEUE_SIZE >= 2 && SPI_QUEUE_SIZE <= 128
+               && (SPI_QUEUE_SIZE & (SPI_QUEUE_SIZE-1)) == 0,
+               "SPI_QUEUE_SIZE must be a power of two between 2 and 128" );
+
+//The queue of transactions like RingBuffer: _spiQueue[_spiRead] is in
+//progress, _spiQueue[_spiWrite] is the next free place. The main-loop
+//changes it only with interrupts disabled.
+static SPITransaction* _spiQueue[SPI_QUEUE_SIZE];
+static volatile uint8_t _spiRead;
+static volatile uint8_t _spiWrite;
+
+//The transaction in progress
+static const uint8_t* _spiTxNext;
+static uint8_t* _spiRxNext;
+static uint16_t _spiRemaining;
+
+
+//////////////////////////////////////////////////////////////////////////
+// Interrupt-Service-Routine
+//////////////////////////////////////////////////////////////////////////
+
+//Selects the device of the oldest transaction, and sends its first byte.
+//Must be called with interrupts disabled, while the SPI-interface is idle.
+static void _startTransaction( void )
+{
+    SPITransaction* transaction = _spiQueue[_spiRead & (SPI_QUEUE_SIZE-1)];
+    transaction->state = SPI_TRANSACTION_ACTIVE;
+    _spiTxNext = transaction->txData;
+    _spiRxNext = transaction->rxData;
+    _spiRemaining = transaction->length;
+
+    if (transaction->csPort != SPI_NO_CS)
+    {
+        writePin( transaction->csPort, transaction->csPinNumber, LOW_LEVEL );
+    }
+    const uint8_t* txNext = _spiTxNext;
+    SPDR = txNext ? *txNext : 0xFF;
+}
+
+//Stores the received byte, and sends the next one. At the end of a
+//transaction its device is released, and the next transaction starts at
+//once.
+ISR(SPI_STC_vect)
+{
+    uint8_t received = SPDR;
+    uint8_t* rxNext = _spiRxNext;
+    if (rxNext)
+    {
+        *rxNext++ = received;
+        _spiRxNext = rxNext;
+    }
+
+    uint16_t remaining = _spiRemaining - 1;
+    _spiRemaining = remaining;
+    if (remaining)
+    {
+        const uint8_t* txNext = _spiTxNext;
+        if (txNext)
+        {
+            txNext++;
+            _spiTxNext = txNext;
+            SPDR = *txNext;
+        }
+        else
+        {
+            SPDR = 0xFF;
+        }
+        return;
+    }
+
+    uint8_t read = _spiRead;
+    SPITransaction* transaction = _spiQueue[read & (SPI_QUEUE_SIZE-1)];
+    if (transaction->csPort != SPI_NO_CS)
+    {
+        writePin( transaction->csPort, transaction->csPinNumber, HIGH_LEVEL );
+    }
+    transaction->state = SPI_TRANSACTION_DONE;
+    read++;
+    _spiRead = read;
+    if (read != _spiWrite) _startTransaction();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+void initSPIMaster( uint8_t clockDivider, uint8_t mode, uint8_t dataOrder )
+{
+    if (clockDivider > SPI_CLOCK_DIV32 || (mode & ~SPI_MODE_3)
+        || dataOrder > SPI_LSB_FIRST)
+    {
+        return;
+    }
+
+    uint8_t sreg = SREG;
+    cli();
+    SPCR = 0;       //stop the SPI-interface and its interrupt
+
+    //forget the transactions of an earlier initialization
+    for (uint8_t i = _spiRead; i != _spiWrite; i++)
+    {
+        _spiQueue[i & (SPI_QUEUE_SIZE-1)]->state = SPI_TRANSACTION_DONE;
+    }
+    _spiRead = _spiWrite;
+
+    writePin( port_B, _SPI_SS, HIGH_LEVEL );
+    setPinMode( port_B, _SPI_SS, MODE_OUTPUT );
+    setPinMode( port_B, _SPI_SCK, MODE_OUTPUT );
+    setPinMode( port_B, _SPI_MOSI, MODE_OUTPUT );
+    setPinMode( port_B, _SPI_MISO, MODE_INPUT );
+
+    SPSR = (clockDivider & 0x04) ? (1<<SPI2X) : 0;
+    SPCR = (1<<SPIE) | (1<<SPE) | (1<<MSTR) | mode
+           | (dataOrder == SPI_LSB_FIRST ? (1<<DORD) : 0)
+           | (clockDivider & 0x03);
+    SREG = sreg;
+}
+
+bool queueSPITransaction( SPITransaction* transaction )
+{
+    if (!transaction || transaction->length == 0) return false;
+
+    uint8_t sreg = SREG;
+    cli();
+    bool queued = transaction->state == SPI_TRANSACTION_DONE
+                  && (uint8_t)(_spiWrite - _spiRead) != SPI_QUEUE_SIZE;
+    if (queued)
+    {
+        transaction->state = SPI_TRANSACTION_QUEUED;
+        uint8_t write = _spiWrite;
+        _spiQueue[write & (SPI_QUEUE_SIZE-1)] = transaction;
+        _spiWrite = write + 1;
+        if (write == _spiRead) _startTransaction();    //was idle
+    }
+    SREG = sreg;
+    return queued;
+}
+
+bool isSPIIdle( void )
+{
+    return _spiRead == _spiWrite;
+}
@@ -0,0 +1,206 @@
+/*
+    SPIMaster.h - Interrupt-driven SPI-master of an AVR-Microcontroller, that
+    carries out a queue of transactions with their own chip-select-pins.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPIMASTER_H_
+#define SPIMASTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+#include "GPIO.h"
+
+/**
+ * Maximum number of transactions waiting in the queue (including the one in
+ * progress). Must be a power of two between 2 and 128. Define it with
+ * another value when compiling SPIMaster.cpp, if needed.
+ */
+#ifndef SPI_QUEUE_SIZE
+#define SPI_QUEUE_SIZE      8
+#endif
+
+/**
+ * The SPI-clock is `F_CPU` divided by 2 ... 128 (bit SPI2X of SPSR and bits
+ * SPR1:0 of SPCR).
+ *
+ * Each byte costs one run of the Interrupt-Service-Routine. Its cycles are
+ * measured by the benchmark `SPI_STC_vect` (see doc/Benchmarks.md): if they
+ * (with prologue and epilogue) exceed the cycles of a byte (8 times the
+ * divider, for example 32 with SPI_CLOCK_DIV4), the transfer is limited by
+ * the Interrupt-Service-Routine, not by the SPI-clock.
+ */
+#define SPI_CLOCK_DIV4      0x00
+#define SPI_CLOCK_DIV16     0x01
+#define SPI_CLOCK_DIV64     0x02
+#define SPI_CLOCK_DIV128    0x03
+#define SPI_CLOCK_DIV2      0x04
+#define SPI_CLOCK_DIV8      0x05
+#define SPI_CLOCK_DIV32     0x06
+
+/**
+ * The SPI-modes (clock-polarity and -phase, bits CPOL and CPHA of SPCR):
+ *  - SPI_MODE_0: SCK low when idle, data sampled at the rising edge
+ *  - SPI_MODE_1: SCK low when idle, data sampled at the falling edge
+ *  - SPI_MODE_2: SCK high when idle, data sampled at the falling edge
+ *  - SPI_MODE_3: SCK high when idle, data sampled at the rising edge
+ */
+#define SPI_MODE_0          0x00
+#define SPI_MODE_1          0x04
+#define SPI_MODE_2          0x08
+#define SPI_MODE_3          0x0C
+
+/**
+ * The order of the bits of each byte
+ */
+#define SPI_MSB_FIRST       0
+#define SPI_LSB_FIRST       1
+
+/**
+ * States of a transaction (`SPITransaction::state`)
+ */
+#define SPI_TRANSACTION_DONE    0
+#define SPI_TRANSACTION_QUEUED  1
+#define SPI_TRANSACTION_ACTIVE  2
+
+/**
+ * Port-number of a transaction without chip-select-pin (see `csPort`)
+ */
+#define SPI_NO_CS           0xFF
+
+/**
+ * A transaction: `length` bytes are sent and received at the same time,
+ * while the chip-select-pin is low.
+ *
+ * The memory of the transaction, and of the data it points to, belongs to
+ * the SPI-master from `queueSPITransaction` until `state` is
+ * SPI_TRANSACTION_DONE. Then the received bytes are in `rxData`, and the
+ * transaction can be queued again. A new transaction must start with `state`
+ * SPI_TRANSACTION_DONE (for example zero-initialized).
+ */
+typedef struct
+{
+    const uint8_t* txData;  // bytes to send, or 0 to send 0xFF
+    uint8_t* rxData;        // memory for the received bytes, or 0 to drop
+                            // them (may be the same as txData)
+    uint16_t length;        // number of bytes (at least 1)
+    uint8_t csPort;         // port and pin-number of the chip-select-pin
+    uint8_t csPinNumber;    // (port SPI_NO_CS: none)
+    volatile uint8_t state; // SPI_TRANSACTION_QUEUED, ... (set by the
+                            // SPI-master)
+} SPITransaction;
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initializes the SPI-interface as master: SCK, MOSI and SS are programmed as
+ * outputs (SS must stay an output, an input with low-level would switch the
+ * SPI-interface to slave-mode), MISO as input. The queue is emptied.
+ *
+ * The chip-select-pins of the transactions must be programmed as outputs
+ * with high-level by the program (before their first transaction).
+ * Interrupts must be globally enabled (with `sei()`).
+ *
+ * @param clockDivider SPI_CLOCK_DIV2 ... SPI_CLOCK_DIV128
+ * @param mode SPI_MODE_0 ... SPI_MODE_3
+ * @param dataOrder SPI_MSB_FIRST or SPI_LSB_FIRST
+ */
+void initSPIMaster( uint8_t clockDivider, uint8_t mode, uint8_t dataOrder );
+
+/**
+ * Appends a transaction to the queue. If the SPI-master is idle, it starts
+ * immediately. The Interrupt-Service-Routine (SPI_STC_vect, which is part of
+ * this module) pulls the chip-select-pin low, transfers the bytes, releases
+ * the pin and starts the next transaction, without the main-loop.
+ *
+ * @param transaction The transaction (all fields except `state` must be
+ *      set)
+ * @return false, if the queue is full, the transaction is invalid, or it is
+ *      still queued (then it is not queued again, and `state` is
+ *      unchanged).
+ */
+bool queueSPITransaction( SPITransaction* transaction );
+
+/**
+ * Returns true, if all queued transactions are done.
+ */
+bool isSPIIdle( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// C++ object-oriented API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+
+class SPIMaster
+{
+public:
+    /**
+     * Constructor. Initializes the SPI-interface (see `initSPIMaster`).
+     */
+    SPIMaster( uint8_t clockDivider, uint8_t mode = SPI_MODE_0,
+               uint8_t dataOrder = SPI_MSB_FIRST )
+    {
+        ::initSPIMaster( clockDivider, mode, dataOrder );
+    }
+
+    /**
+     * Fills a transaction and appends it to the queue (see
+     * `queueSPITransaction`).
+     *
+     * @param transaction The transaction. It must not be changed until its
+     *      `state` is SPI_TRANSACTION_DONE.
+     * @param cs The chip-select-pin of the device
+     * @param txData The bytes to send, or 0 to send 0xFF
+     * @param rxData Memory for the received bytes, or 0
+     * @param length The number of bytes
+     */
+    bool queue( SPITransaction& transaction, const GPIOPin& cs,
+                const void* txData, void* rxData, uint16_t length )
+    {
+        if (transaction.state != SPI_TRANSACTION_DONE) return false;
+        transaction.txData = (const uint8_t*)txData;
+        transaction.rxData = (uint8_t*)rxData;
+        transaction.length = length;
+        transaction.csPort = cs.getPort();
+        transaction.csPinNumber = cs.getPinNumber();
+        return ::queueSPITransaction( &transaction );
+    }
+
+    bool isIdle()
+    {
+        return ::isSPIIdle();
+    }
+};
+
+#endif
+
+#endif /* SPIMASTER_H_ */
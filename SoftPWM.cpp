@@ -0,0 +1,366 @@
+/*
+    SoftPWM.cpp - Software-PWM for many GPIO-Pins, driven by one
+    Timer-Interrupt-Service-Routine (Timer/Counter2).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "SoftPWM.h"
+
+
+//////////////////////////////////////////////////////////////////////////
+// Channels and tables of output-changes
+//////////////////////////////////////////////////////////////////////////
+
+//How it works: The outputs are changed by writing 1-Bits to the
+//PINx-Register of their port, which toggles the PORTx-Bits. So each change
+//of the outputs of a port is a single store, that doesn't touch the other
+//pins of the port. commitSoftPWM computes a table of these changes, sorted
+//by time. The Interrupt-Service-Routine only walks through the table: Its
+//cost depends on the number of changes at the same time, not on the number
+//of channels.
+//
+//At the start of each period the levels of all outputs are written (not
+//toggled). A toggle can be lost, if the Interrupt-Service-Routine runs in
+//the middle of a read-modify-write of PORTx by the program (writePin on
+//another pin of the port): then the output would stay inverted forever.
+//Writing the levels repairs it within one period.
+
+typedef struct
+{
+    uint8_t portIndex;      //index in _softPWMPorts
+    uint8_t mask;           //the Bit of the pin
+    uint8_t duty;
+} _SoftPWMChannel;
+
+//Toggle the pins `toggleMask` of a port at tick `time` of the period
+typedef struct
+{
+    uint8_t time;
+    uint8_t portIndex;
+    uint8_t toggleMask;
+} _SoftPWMEvent;
+
+#define _SOFTPWM_MAX_EVENTS \
+    (SOFTPWM_MAX_CHANNELS > 8*SOFTPWM_MAX_PORTS ? \
+     SOFTPWM_MAX_CHANNELS : 8*SOFTPWM_MAX_PORTS)
+
+//The output-changes of one period. At the start of a period (tick 0), the
+//outputs of each port are set to `startMasks` (the pins, that are on), then
+//the events follow.
+typedef struct
+{
+    _SoftPWMEvent events[_SOFTPWM_MAX_EVENTS];
+    uint8_t eventCount;
+    uint8_t startMasks[SOFTPWM_MAX_PORTS];
+} _SoftPWMTable;
+
+static _SoftPWMChannel _softPWMChannels[SOFTPWM_MAX_CHANNELS];
+static uint8_t _softPWMChannelCount;
+static uint8_t _softPWMPorts[SOFTPWM_MAX_PORTS];
+static sfr8_t* _softPWMPINRegisters[SOFTPWM_MAX_PORTS];
+static sfr8_t* _softPWMPORTRegisters[SOFTPWM_MAX_PORTS];
+static uint8_t _softPWMChannelMasks[SOFTPWM_MAX_PORTS]; //pins of the channels
+static uint8_t* _softPWMShadows[SOFTPWM_MAX_PORTS];  //see _getPORTShadow
+static uint8_t _softPWMPortCount;
+static uint8_t _softPWMMode;
+
+//Two tables: one used by the Interrupt-Service-Routine, one for the next
+//commit. _softPWMOffTable (all outputs off) is used after starting.
+static _SoftPWMTable _softPWMTables[2];
+static _SoftPWMTable _softPWMOffTable;
+static _SoftPWMTable* volatile _softPWMActive = &_softPWMOffTable;
+static _SoftPWMTable* volatile _softPWMPending;
+static uint8_t _softPWMNextEvent;
+
+
+//////////////////////////////////////////////////////////////////////////
+// Interrupt-Service-Routine
+//////////////////////////////////////////////////////////////////////////
+
+//The current tick of the period: TCNT2, or TCNT2+256, if it has overflowed
+//(a new period has started), but the Interrupt-Service-Routine didn't start
+//the new period yet.
+static inline uint16_t _softPWMNow()
+{
+    uint8_t tcnt = TCNT2;
+    if ((TIFR2 & (1<<TOV2)) && tcnt < 128) return tcnt + 256;
+    return tcnt;
+}
+
+//Toggles pins of a port (and their bits of the shadow-register, if GPIO.cpp
+//is compiled with GPIO_SHADOW_REGISTERS, so that writePin on another pin of
+//the port doesn't undo the change)
+static inline void _togglePins( uint8_t portIndex, uint8_t toggleMask )
+{
+    *_softPWMPINRegisters[portIndex] = toggleMask;
+    uint8_t* shadow = _softPWMShadows[portIndex];
+    if (shadow) *shadow ^= toggleMask;
+}
+
+//Sets the outputs of a port to their levels at the start of a period. The
+//read-modify-write of PORTx is atomic here, in the Interrupt-Service-Routine.
+static inline void _writeStartLevels( uint8_t portIndex, uint8_t startMask )
+{
+    uint8_t channelMask = _softPWMChannelMasks[portIndex];
+    sfr8_t* portReg = _softPWMPORTRegisters[portIndex];
+    *portReg = (*portReg & ~channelMask) | startMask;
+    uint8_t* shadow = _softPWMShadows[portIndex];
+    if (shadow) *shadow = (*shadow & ~channelMask) | startMask;
+}
+
+ISR(TIMER2_COMPA_vect)
+{
+    _SoftPWMTable* table = _softPWMActive;
+    uint8_t i = _softPWMNextEvent;
+
+    for (;;)
+    {
+        //the next output-change: an event, or the start of the next period
+        uint16_t time = (i < table->eventCount) ? table->events[i].time : 256;
+
+        //If it is more than 2 ticks away, the Compare-Match-Interrupt will
+        //come in time. Otherwise wait for it here, so that changes close to
+        //each other are not missed.
+        if (time > _softPWMNow() + 2)
+        {
+            OCR2A = (uint8_t)time;
+            break;
+        }
+        while (_softPWMNow() < time) { }
+
+        if (time == 256)
+        {
+            //start of a new period (with the table of the last commit)
+            TIFR2 = (1<<TOV2);
+            _SoftPWMTable* next = table;
+            if (_softPWMPending)
+            {
+                next = _softPWMPending;
+                _softPWMPending = 0;
+            }
+            for (uint8_t p = 0; p < _softPWMPortCount; p++)
+            {
+                _writeStartLevels( p, next->startMasks[p] );
+            }
+            table = next;
+            i = 0;
+        }
+        else
+        {
+            //all events at this time (one store for each port)
+            do
+            {
+                _SoftPWMEvent* event = &table->events[i];
+                _togglePins( event->portIndex, event->toggleMask );
+                i++;
+            } while (i < table->eventCount && table->events[i].time == time);
+        }
+    }
+
+    _softPWMActive = table;
+    _softPWMNextEvent = i;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Computing the tables
+//////////////////////////////////////////////////////////////////////////
+
+//Adds the toggling of `mask` at `time` to the (sorted) events of the table
+static void _addEvent( _SoftPWMTable* table, uint8_t time, uint8_t portIndex,
+                       uint8_t mask )
+{
+    uint8_t i = 0;
+    while (i < table->eventCount && table->events[i].time < time) i++;
+
+    //an event of the same port at the same time: one store for both
+    for (uint8_t j = i; j < table->eventCount && table->events[j].time == time;
+         j++)
+    {
+        if (table->events[j].portIndex == portIndex)
+        {
+            table->events[j].toggleMask |= mask;
+            return;
+        }
+    }
+
+    for (uint8_t j = table->eventCount; j > i; j--)
+    {
+        table->events[j] = table->events[j-1];
+    }
+    table->events[i].time = time;
+    table->events[i].portIndex = portIndex;
+    table->events[i].toggleMask = mask;
+    table->eventCount++;
+}
+
+static void _computePWMTable( _SoftPWMTable* table )
+{
+    for (uint8_t c = 0; c < _softPWMChannelCount; c++)
+    {
+        _SoftPWMChannel* channel = &_softPWMChannels[c];
+        if (channel->duty == 0) continue;
+
+        table->startMasks[channel->portIndex] |= channel->mask;
+        if (channel->duty != 255)
+        {
+            _addEvent( table, channel->duty, channel->portIndex, channel->mask );
+        }
+    }
+}
+
+static void _computeBAMTable( _SoftPWMTable* table )
+{
+    //Tick 0 is a slot with all outputs off, slot n (with 2^n ticks) starts
+    //at tick 2^n. Each slot toggles the outputs, whose bit changes.
+    for (uint8_t p = 0; p < _softPWMPortCount; p++)
+    {
+        uint8_t lastPattern = 0;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            uint8_t pattern = 0;
+            for (uint8_t c = 0; c < _softPWMChannelCount; c++)
+            {
+                _SoftPWMChannel* channel = &_softPWMChannels[c];
+                if (channel->portIndex == p && (channel->duty & (0x01<<bit)))
+                {
+                    pattern |= channel->mask;
+                }
+            }
+            if (pattern != lastPattern)
+            {
+                _addEvent( table, (uint8_t)(0x01<<bit), p,
+                           pattern ^ lastPattern );
+            }
+            lastPattern = pattern;
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+uint8_t addSoftPWMChannel( uint8_t port, uint8_t pinNumber )
+{
+    sfr8_t* pinRegister = _getPINRegister( port );
+    if (!pinRegister || pinNumber > 7) return 0xFF;
+    if (_softPWMChannelCount >= SOFTPWM_MAX_CHANNELS) return 0xFF;
+
+    uint8_t portIndex = 0;
+    while (portIndex < _softPWMPortCount && _softPWMPorts[portIndex] != port)
+    {
+        portIndex++;
+    }
+    if (portIndex == _softPWMPortCount)
+    {
+        if (_softPWMPortCount >= SOFTPWM_MAX_PORTS) return 0xFF;
+        _softPWMPorts[portIndex] = port;
+        _softPWMPINRegisters[portIndex] = pinRegister;
+        _softPWMPORTRegisters[portIndex] = _getPORTRegister( port );
+        _softPWMChannelMasks[portIndex] = 0;
+        _softPWMShadows[portIndex] = _getPORTShadow( port );
+        _softPWMPortCount++;
+    }
+
+    writePin( port, pinNumber, LOW_LEVEL );
+    setPinMode( port, pinNumber, MODE_OUTPUT );
+
+    uint8_t channel = _softPWMChannelCount;
+    _softPWMChannels[channel].portIndex = portIndex;
+    _softPWMChannels[channel].mask = (0x01<<pinNumber);
+    _softPWMChannels[channel].duty = 0;
+    _softPWMChannelCount++;
+    _softPWMChannelMasks[portIndex] |= (0x01<<pinNumber);
+    return channel;
+}
+
+void setSoftPWMDuty( uint8_t channel, uint8_t duty )
+{
+    if (channel >= _softPWMChannelCount) return;
+    _softPWMChannels[channel].duty = duty;
+}
+
+void commitSoftPWM( void )
+{
+    //Withdraw a pending table (it may be in use, as long as it is pending)
+    //and find the table, that the Interrupt-Service-Routine doesn't use.
+    uint8_t sreg = SREG;
+    cli();
+    _softPWMPending = 0;
+    _SoftPWMTable* table = (_softPWMActive == &_softPWMTables[0]) ?
+                           &_softPWMTables[1] : &_softPWMTables[0];
+    SREG = sreg;
+
+    table->eventCount = 0;
+    for (uint8_t p = 0; p < SOFTPWM_MAX_PORTS; p++)
+    {
+        table->startMasks[p] = 0;
+    }
+    if (_softPWMMode == SOFTPWM_MODE_BAM) _computeBAMTable( table );
+    else                                  _computePWMTable( table );
+
+    sreg = SREG;
+    cli();
+    _softPWMPending = table;
+    SREG = sreg;
+}
+
+bool isSoftPWMCommitPending( void )
+{
+    return _softPWMPending != 0;
+}
+
+void startSoftPWM( uint8_t mode, uint8_t prescaler )
+{
+    stopSoftPWM();
+    _softPWMMode = mode;
+    commitSoftPWM();
+
+    uint8_t sreg = SREG;
+    cli();
+    //the first period starts immediately after the (all off) _softPWMOffTable
+    _softPWMNextEvent = 0;
+    TCCR2A = 0;             //Normal-mode
+    TCNT2 = 0;
+    OCR2A = 0;
+    TIFR2 = (1<<OCF2A) | (1<<TOV2);
+    TIMSK2 |= (1<<OCIE2A);
+    TCCR2B = prescaler & 0x07;
+    SREG = sreg;
+}
+
+void stopSoftPWM( void )
+{
+    uint8_t sreg = SREG;
+    cli();
+    TCCR2B = 0;
+    TIMSK2 &= ~(1<<OCIE2A);
+    _softPWMActive = &_softPWMOffTable;
+    _softPWMPending = 0;
+    SREG = sreg;
+
+    for (uint8_t c = 0; c < _softPWMChannelCount; c++)
+    {
+        _SoftPWMChannel* channel = &_softPWMChannels[c];
+        writePort( _softPWMPorts[channel->portIndex], 0x00, channel->mask );
+    }
+}
@@ -0,0 +1,186 @@
+/*
+    SoftPWM.h - Software-PWM for many GPIO-Pins, driven by one
+    Timer-Interrupt-Service-Routine (Timer/Counter2).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOFTPWM_H_
+#define SOFTPWM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GPIO.h"
+
+/**
+ * Maximum number of channels (GPIO-Pins) and of different ports used by
+ * them. Define them with other values when compiling SoftPWM.cpp, if
+ * needed. The RAM needed grows with both values.
+ */
+#ifndef SOFTPWM_MAX_CHANNELS
+#define SOFTPWM_MAX_CHANNELS    32
+#endif
+
+#ifndef SOFTPWM_MAX_PORTS
+#define SOFTPWM_MAX_PORTS       4
+#endif
+
+/**
+ * Possible values of parameter `mode` of `startSoftPWM`:
+ *  - SOFTPWM_MODE_PWM: Each output is on at the start of the period and
+ *    turned off after `duty` ticks. Duty 255 keeps the output on.
+ *  - SOFTPWM_MODE_BAM: Bit-Angle-Modulation. The period is divided into 8
+ *    slots with 1, 2, 4, ... 128 ticks, and during slot n the output is on,
+ *    if bit n of `duty` is 1. The outputs change at 9 fixed times per period,
+ *    whatever the duties are (fewer interrupts, if many channels have
+ *    different duties, but a more uneven signal).
+ */
+#define SOFTPWM_MODE_PWM        0
+#define SOFTPWM_MODE_BAM        1
+
+/**
+ * Possible values of parameter `prescaler` of `startSoftPWM`: The clock of
+ * the Timer/Counter2 is F_CPU divided by 32, 64, ... 1024. A period has 256
+ * ticks, so at 16MHz and prescaler 64 the PWM-frequency is 976Hz.
+ * Prescalers below 32 leave too little time for the
+ * Interrupt-Service-Routine between two ticks.
+ */
+#define SOFTPWM_PRESCALER_32    0x03
+#define SOFTPWM_PRESCALER_64    0x04
+#define SOFTPWM_PRESCALER_128   0x05
+#define SOFTPWM_PRESCALER_256   0x06
+#define SOFTPWM_PRESCALER_1024  0x07
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Adds a GPIO-Pin as channel of the Software-PWM. The pin is programmed to
+ * be an output with Low-Voltage-Level. Its duty is 0, until it is changed
+ * with `setSoftPWMDuty` and `commitSoftPWM`.
+ *
+ * While the Software-PWM is running, the pin belongs to it: The PORTx-Bit of
+ * the pin must not be changed by the program. Other pins of the same port
+ * can be used freely: if a read-modify-write of the port by the program
+ * (for example `writePin`) is interrupted by the Interrupt-Service-Routine
+ * and undoes a change of an output, the output is corrected at the start of
+ * the next period.
+ *
+ * @param port The port, for example port_A.
+ * @param pinNumber The number of the pin (0...7)
+ * @return The channel-number (0, 1, 2, ... in the order of the calls), or
+ *      0xFF if the pin doesn't exist, or if there are already
+ *      `SOFTPWM_MAX_CHANNELS` channels or `SOFTPWM_MAX_PORTS` ports.
+ */
+uint8_t addSoftPWMChannel( uint8_t port, uint8_t pinNumber );
+
+/**
+ * Sets the duty of a channel. The change takes effect with `commitSoftPWM`,
+ * so the duties of several channels change at the same time.
+ *
+ * @param channel The channel-number returned by `addSoftPWMChannel`
+ * @param duty 0 (always off) ... 255: The output is on for `duty` of the
+ *      256 ticks of a period (255 keeps the output on in SOFTPWM_MODE_PWM).
+ */
+void setSoftPWMDuty( uint8_t channel, uint8_t duty );
+
+/**
+ * Computes the list of output-changes for the duties set with
+ * `setSoftPWMDuty`. The Interrupt-Service-Routine starts using it at the
+ * start of the next period. Runs in the main-loop (not in an
+ * Interrupt-Service-Routine), and needs a time proportional to the square
+ * of the number of channels.
+ */
+void commitSoftPWM( void );
+
+/**
+ * Returns true, while the list computed by the last `commitSoftPWM` is not
+ * used yet (it is used from the start of the next period).
+ */
+bool isSoftPWMCommitPending( void );
+
+/**
+ * Starts the Software-PWM with the Timer/Counter2 and its Compare-Match-A-
+ * Interrupt. The Timer/Counter2 can't be used for other purposes.
+ * Interrupts must be globally enabled (with `sei()`).
+ *
+ * @param mode SOFTPWM_MODE_PWM or SOFTPWM_MODE_BAM
+ * @param prescaler SOFTPWM_PRESCALER_32 ... SOFTPWM_PRESCALER_1024
+ */
+void startSoftPWM( uint8_t mode, uint8_t prescaler );
+
+/**
+ * Stops the Timer/Counter2 and puts out a Low-Voltage-Level on all channels.
+ */
+void stopSoftPWM( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// C++ object-oriented API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+
+/**
+ * Class for a channel of the Software-PWM. See the C-functions.
+ *
+ * For example 24 LEDs on the ports A, C and K:
+ * {@code
+ *     SoftPWMChannel leds[24] = { SoftPWMChannel(port_A,0), ... };
+ *     startSoftPWM( SOFTPWM_MODE_PWM, SOFTPWM_PRESCALER_64 );
+ *     sei();
+ *     for (uint8_t i = 0; i < 24; i++) leds[i].setDuty( i * 10 );
+ *     commitSoftPWM();
+ * }
+ */
+class SoftPWMChannel
+{
+public:
+    /**
+     * Constructor. Adds the pin as channel (see `addSoftPWMChannel`). If
+     * that fails, the object is invalid and `setDuty` does nothing.
+     */
+    SoftPWMChannel( uint8_t port, uint8_t pinNumber )
+        : _channel( ::addSoftPWMChannel( port, pinNumber ) ) { }
+
+    /**
+     * Sets the duty (0...255). It takes effect with `commitSoftPWM`.
+     */
+    void setDuty( uint8_t duty ) { ::setSoftPWMDuty( _channel, duty ); }
+
+    /**
+     * Returns the channel-number, or 0xFF for an invalid object.
+     */
+    uint8_t getChannel() { return _channel; }
+
+private:
+    uint8_t _channel;
+};
+
+#endif
+
+#endif /* SOFTPWM_H_ */
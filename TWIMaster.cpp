@@ -0,0 +1,356 @@
+/*
+    TWIMaster.cpp - Interrupt-driven TWI- (I2C-) master of an
+    AVR-Microcontroller, that carries out a queue of transactions.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+
+#include "TWIMaster.h"
+#include "GPIO.h"
+
+#ifndef F_CPU
+#error "F_CPU (the clock-frequency in Hz) must be defined for TWIMaster.cpp"
+#endif
+
+//The pins of the TWI-interface
+#if defined(__AVR_ATmega2560__)
+#define _TWI_PORT   port_D
+#define _TWI_SCL    0
+#define _TWI_SDA    1
+#else
+#define _TWI_PORT   port_C
+#define _TWI_SCL    5
+#define _TWI_SDA    4
+#endif
+
+static_assert( TWI_QUEUE_SIZE >= 2 && TWI_QUEUE_SIZE <= 128
+               && (TWI_QUEUE_SIZE & (TWI_QUEUE_SIZE-1)) == 0,
+               "TWI_QUEUE_SIZE must be a power of two between 2 and 128" );
+
+//The queue of transactions like RingBuffer: _twiQueue[_twiRead] is in
+//progress, _twiQueue[_twiWrite] is the next free place. The main-loop
+//changes it only with interrupts disabled.
+static TWITransaction* _twiQueue[TWI_QUEUE_SIZE];
+static volatile uint8_t _twiRead;
+static volatile uint8_t _twiWrite;
+
+//recoverTWIBus is clocking SCL: queueTWITransaction doesn't start a
+//transaction
+static volatile bool _twiRecovering;
+
+//The transaction in progress: in the read-phase (after SLA+R), and the
+//number of bytes transferred in the current phase
+static bool _twiReading;
+static uint8_t _twiIndex;
+
+//TWCR: continue with the next step, interrupt at its end
+#define _TWCR_NEXT  ((1<<TWINT) | (1<<TWEN) | (1<<TWIE))
+
+//Status-codes of the master (TWSR without the prescaler-bits)
+#define _TW_START           0x08
+#define _TW_REP_START       0x10
+#define _TW_MT_SLA_ACK      0x18
+#define _TW_MT_SLA_NACK     0x20
+#define _TW_MT_DATA_ACK     0x28
+#define _TW_MT_DATA_NACK    0x30
+#define _TW_MR_SLA_ACK      0x40
+#define _TW_MR_SLA_NACK     0x48
+#define _TW_MR_DATA_ACK     0x50
+#define _TW_MR_DATA_NACK    0x58
+#define _TW_BUS_ERROR       0x00
+
+
+//////////////////////////////////////////////////////////////////////////
+// Interrupt-Service-Routine
+//////////////////////////////////////////////////////////////////////////
+
+static inline TWITransaction* _currentTransaction( void )
+{
+    return _twiQueue[_twiRead & (TWI_QUEUE_SIZE-1)];
+}
+
+//Finishes the oldest transaction, and returns it. Must be called with
+//interrupts disabled.
+static TWITransaction* _finishTransaction( uint8_t state )
+{
+    TWITransaction* transaction = _currentTransaction();
+    transaction->state = state;
+    _twiRead = _twiRead + 1;
+    _twiReading = false;
+    return transaction;
+}
+
+//Finishes the oldest transaction: the bus is released with `twcr` (a STOP-
+//condition, for example), followed by a START-condition, if there is
+//another transaction.
+static void _finish( uint8_t state, uint8_t twcr )
+{
+    TWITransaction* transaction = _finishTransaction( state );
+    if (_twiRead != _twiWrite)
+    {
+        _currentTransaction()->state = TWI_TRANSACTION_ACTIVE;
+        twcr |= (1<<TWSTA);
+    }
+    TWCR = twcr;
+    TWICompleteHandler handler = transaction->handler;
+    if (handler) handler( transaction );
+}
+
+//Starts the oldest transaction with a START-condition. Must be called with
+//interrupts disabled. A STOP-condition, that has not been sent yet, is
+//sent before.
+static void _startTransaction( void )
+{
+    _currentTransaction()->state = TWI_TRANSACTION_ACTIVE;
+    _twiReading = false;
+    TWCR = (TWCR & (1<<TWSTO)) | _TWCR_NEXT | (1<<TWSTA);
+}
+
+ISR(TWI_vect)
+{
+    TWITransaction* transaction = _currentTransaction();
+    uint8_t status = TWSR & 0xF8;
+
+    switch (status)
+    {
+        case _TW_START:
+        case _TW_REP_START:
+            if (transaction->writeLength && !_twiReading)
+            {
+                TWDR = transaction->address << 1;           //SLA+W
+            }
+            else
+            {
+                _twiReading = true;
+                TWDR = (transaction->address << 1) | 0x01;  //SLA+R
+            }
+            _twiIndex = 0;
+            TWCR = _TWCR_NEXT;
+            break;
+
+        case _TW_MT_SLA_ACK:
+        case _TW_MT_DATA_ACK:
+            if (_twiIndex < transaction->writeLength)
+            {
+                TWDR = transaction->writeData[_twiIndex++];
+                TWCR = _TWCR_NEXT;
+            }
+            else if (transaction->readLength)
+            {
+                //repeated START for the read-phase
+                _twiReading = true;
+                TWCR = _TWCR_NEXT | (1<<TWSTA);
+            }
+            else
+            {
+                _finish( TWI_TRANSACTION_DONE, _TWCR_NEXT | (1<<TWSTO) );
+            }
+            break;
+
+        case _TW_MR_DATA_ACK:
+            transaction->readData[_twiIndex++] = TWDR;
+            //fall through - acknowledge the next byte, unless it is the last
+        case _TW_MR_SLA_ACK:
+            TWCR = _TWCR_NEXT
+                   | ((_twiIndex + 1 < transaction->readLength) ? (1<<TWEA) : 0);
+            break;
+
+        case _TW_MR_DATA_NACK:
+            transaction->readData[_twiIndex] = TWDR;
+            _finish( TWI_TRANSACTION_DONE, _TWCR_NEXT | (1<<TWSTO) );
+            break;
+
+        case _TW_MT_SLA_NACK:
+        case _TW_MT_DATA_NACK:
+        case _TW_MR_SLA_NACK:
+            _finish( TWI_TRANSACTION_NACK, _TWCR_NEXT | (1<<TWSTO) );
+            break;
+
+        case _TW_BUS_ERROR:
+            //TWSTO resets the TWI-interface (no STOP-condition is sent)
+            _finish( TWI_TRANSACTION_BUS_ERROR, _TWCR_NEXT | (1<<TWSTO) );
+            break;
+
+        default:
+            //arbitration lost: the bus is released
+            _finish( TWI_TRANSACTION_BUS_ERROR, _TWCR_NEXT );
+            break;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+void initTWIMaster( uint32_t frequency )
+{
+    if (frequency == 0) return;
+
+    //SCL-frequency = F_CPU / (16 + 2 * TWBR * prescaler), prescaler 1 ... 64
+    uint32_t twbr = F_CPU / frequency;
+    twbr = twbr > 16 ? (twbr - 16) / 2 : 0;
+    uint8_t prescalerBits = 0;
+    while (twbr > 255 && prescalerBits < 3)
+    {
+        twbr /= 4;
+        prescalerBits++;
+    }
+    if (twbr > 255) twbr = 255;
+
+    uint8_t sreg = SREG;
+    cli();
+    TWCR = 0;       //stop the TWI-interface and its interrupt
+
+    //forget the transactions of an earlier initialization
+    for (uint8_t i = _twiRead; i != _twiWrite; i++)
+    {
+        _twiQueue[i & (TWI_QUEUE_SIZE-1)]->state = TWI_TRANSACTION_BUS_ERROR;
+    }
+    _twiRead = _twiWrite;
+
+    setPinPullup( _TWI_PORT, _TWI_SCL, PULLUP_ON );
+    setPinPullup( _TWI_PORT, _TWI_SDA, PULLUP_ON );
+
+    TWSR = prescalerBits;
+    TWBR = (uint8_t)twbr;
+    TWCR = (1<<TWEN) | (1<<TWIE);
+    SREG = sreg;
+}
+
+bool queueTWITransaction( TWITransaction* transaction )
+{
+    if (!transaction) return false;
+    if (transaction->writeLength == 0 && transaction->readLength == 0)
+    {
+        return false;
+    }
+    if ((transaction->writeLength && !transaction->writeData)
+        || (transaction->readLength && !transaction->readData)
+        || transaction->address > 0x7F)
+    {
+        return false;
+    }
+
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t state = transaction->state;
+    bool queued = state != TWI_TRANSACTION_QUEUED
+                  && state != TWI_TRANSACTION_ACTIVE
+                  && (uint8_t)(_twiWrite - _twiRead) != TWI_QUEUE_SIZE;
+    if (queued)
+    {
+        transaction->state = TWI_TRANSACTION_QUEUED;
+        uint8_t write = _twiWrite;
+        _twiQueue[write & (TWI_QUEUE_SIZE-1)] = transaction;
+        _twiWrite = write + 1;
+        if (write == _twiRead && !_twiRecovering)
+        {
+            _startTransaction();    //was idle
+        }
+    }
+    SREG = sreg;
+    return queued;
+}
+
+bool isTWIIdle( void )
+{
+    return _twiRead == _twiWrite;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Recovery of the bus
+//////////////////////////////////////////////////////////////////////////
+
+//SCL and SDA are open-drain: a line is either pulled low (output low), or
+//released (input with pullup)
+static void _pullLow( GPIOPin& line )
+{
+    line.setPinPullup( PULLUP_OFF );
+    line.setPinMode( MODE_OUTPUT );
+}
+
+static void _release( GPIOPin& line )
+{
+    line.setPinMode( MODE_INPUT );
+    line.setPinPullup( PULLUP_ON );
+}
+
+//half a period of SCL at 100kHz
+#define _HALF_PERIOD_US     5
+
+bool recoverTWIBus( void )
+{
+    //The transaction in progress is aborted. Its handler is called at the
+    //end, when the TWI-interface works again (it may queue a transaction).
+    uint8_t sreg = SREG;
+    cli();
+    TWCR = 0;       //SCL and SDA are GPIO-Pins now
+    _twiRecovering = true;
+    TWITransaction* transaction = 0;
+    if (_twiRead != _twiWrite)
+    {
+        transaction = _finishTransaction( TWI_TRANSACTION_BUS_ERROR );
+    }
+    SREG = sreg;
+
+    GPIOPin scl( _TWI_PORT, _TWI_SCL );
+    GPIOPin sda( _TWI_PORT, _TWI_SDA );
+    _release( sda );
+    _release( scl );
+    _delay_us( _HALF_PERIOD_US );
+
+    //A slave in the middle of sending a byte releases SDA after at most 9
+    //clocks (8 bits and the acknowledge)
+    for (uint8_t i = 0; i < 9 && sda.readPin() == LOW_LEVEL; i++)
+    {
+        _pullLow( scl );
+        _delay_us( _HALF_PERIOD_US );
+        _release( scl );
+        _delay_us( _HALF_PERIOD_US );
+    }
+
+    //STOP-condition: SDA rises while SCL is high
+    _pullLow( scl );
+    _delay_us( _HALF_PERIOD_US );
+    _pullLow( sda );
+    _delay_us( _HALF_PERIOD_US );
+    _release( scl );
+    _delay_us( _HALF_PERIOD_US );
+    _release( sda );
+    _delay_us( _HALF_PERIOD_US );
+
+    bool free = scl.readPin() == HIGH_LEVEL && sda.readPin() == HIGH_LEVEL;
+
+    //with interrupts disabled, like in the Interrupt-Service-Routine
+    sreg = SREG;
+    cli();
+    _twiRecovering = false;
+    TWCR = (1<<TWEN) | (1<<TWIE);
+    if (_twiRead != _twiWrite) _startTransaction();
+    if (transaction)
+    {
+        TWICompleteHandler handler = transaction->handler;
+        if (handler) handler( transaction );
+    }
+    SREG = sreg;
+    return free;
+}
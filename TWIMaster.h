@@ -0,0 +1,219 @@
+/*
+    TWIMaster.h - Interrupt-driven TWI- (I2C-) master of an
+    AVR-Microcontroller, that carries out a queue of transactions.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TWIMASTER_H_
+#define TWIMASTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+/**
+ * Maximum number of transactions waiting in the queue (including the one in
+ * progress). Must be a power of two between 2 and 128. Define it with
+ * another value when compiling TWIMaster.cpp, if needed.
+ */
+#ifndef TWI_QUEUE_SIZE
+#define TWI_QUEUE_SIZE      8
+#endif
+
+/**
+ * States of a transaction (`TWITransaction::state`):
+ *  - TWI_TRANSACTION_QUEUED, TWI_TRANSACTION_ACTIVE: waiting in the queue,
+ *    in progress
+ *  - TWI_TRANSACTION_DONE: finished, all bytes have been transferred
+ *  - TWI_TRANSACTION_NACK: finished, the slave has not acknowledged its
+ *    address (it doesn't exist or is busy) or a byte written to it
+ *  - TWI_TRANSACTION_BUS_ERROR: finished because of an illegal START- or
+ *    STOP-condition or lost arbitration, or aborted by `recoverTWIBus`
+ */
+#define TWI_TRANSACTION_DONE        0
+#define TWI_TRANSACTION_QUEUED      1
+#define TWI_TRANSACTION_ACTIVE      2
+#define TWI_TRANSACTION_NACK        3
+#define TWI_TRANSACTION_BUS_ERROR   4
+
+struct TWITransaction;
+
+/**
+ * Called from the Interrupt-Service-Routine, when a transaction is finished
+ * (successfully or not, see `state`). It may queue the transaction again.
+ * For a transaction aborted by `recoverTWIBus`, it is called at the end of
+ * `recoverTWIBus` (with interrupts disabled, as in the
+ * Interrupt-Service-Routine), after the bus has been freed.
+ */
+typedef void (*TWICompleteHandler)( struct TWITransaction* transaction );
+
+/**
+ * A transaction with a slave:
+ *  - Write: `writeLength` bytes are sent (readLength 0).
+ *  - Read: `readLength` bytes are received (writeLength 0).
+ *  - Write, then read: the bytes are sent (for example the number of a
+ *    register of the slave), then a repeated START-condition follows, and
+ *    the bytes are received, without releasing the bus in between.
+ *
+ * The memory of the transaction, and of the data it points to, belongs to
+ * the TWI-master from `queueTWITransaction` until it is finished (see
+ * TWI_TRANSACTION_DONE). A new transaction must start with a finished
+ * `state` (for example zero-initialized).
+ */
+typedef struct TWITransaction
+{
+    uint8_t address;            // 7-bit-address of the slave
+    const uint8_t* writeData;   // bytes to send
+    uint8_t writeLength;
+    uint8_t* readData;          // memory for the received bytes
+    uint8_t readLength;
+    TWICompleteHandler handler; // called at the end, or 0
+    volatile uint8_t state;     // TWI_TRANSACTION_QUEUED, ... (set by the
+                                // TWI-master)
+} TWITransaction;
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initializes the TWI-interface as master. The internal pullup-resistors of
+ * SCL and SDA are turned on (at 400kHz external pullup-resistors of a few
+ * kOhm are needed). The queue is emptied. Interrupts must be globally
+ * enabled (with `sei()`).
+ *
+ * @param frequency The SCL-frequency in Hz (for example 100000 or 400000)
+ */
+void initTWIMaster( uint32_t frequency );
+
+/**
+ * Appends a transaction to the queue. If the TWI-master is idle, it starts
+ * immediately. The Interrupt-Service-Routine (TWI_vect, which is part of
+ * this module) carries out the transactions one after the other, without
+ * the main-loop.
+ *
+ * @param transaction The transaction (all fields except `state` must be
+ *      set)
+ * @return false, if the queue is full, the transaction is invalid, or it is
+ *      not finished yet (then it is not queued, and `state` is unchanged).
+ */
+bool queueTWITransaction( TWITransaction* transaction );
+
+/**
+ * Returns true, if all queued transactions are finished.
+ */
+bool isTWIIdle( void );
+
+/**
+ * Frees the bus, if a slave holds SDA low (for example because the master
+ * was reset in the middle of a read): The TWI-interface is disabled, the
+ * transaction in progress is finished with TWI_TRANSACTION_BUS_ERROR, and
+ * SCL is clocked (up to 9 times, as GPIO-Pin) until the slave releases SDA.
+ * Then a STOP-condition is generated, and the TWI-interface continues with
+ * the next transaction of the queue.
+ *
+ * Call it, when a transaction has finished with TWI_TRANSACTION_BUS_ERROR,
+ * or doesn't finish in time. It waits (about 100 microseconds), so it must
+ * not be called from an Interrupt-Service-Routine.
+ *
+ * @return true, if SCL and SDA are free (high) afterwards.
+ */
+bool recoverTWIBus( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// C++ object-oriented API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+
+class TWIMaster
+{
+public:
+    /**
+     * Constructor. Initializes the TWI-interface (see `initTWIMaster`).
+     */
+    TWIMaster( uint32_t frequency )
+    {
+        ::initTWIMaster( frequency );
+    }
+
+    /**
+     * Fills a write-transaction and appends it to the queue.
+     */
+    bool write( TWITransaction& transaction, uint8_t address,
+                const void* data, uint8_t length,
+                TWICompleteHandler handler = 0 )
+    {
+        return writeRead( transaction, address, data, length, 0, 0, handler );
+    }
+
+    /**
+     * Fills a read-transaction and appends it to the queue.
+     */
+    bool read( TWITransaction& transaction, uint8_t address,
+               void* data, uint8_t length, TWICompleteHandler handler = 0 )
+    {
+        return writeRead( transaction, address, 0, 0, data, length, handler );
+    }
+
+    /**
+     * Fills a write-then-read-transaction (with a repeated START-condition)
+     * and appends it to the queue.
+     */
+    bool writeRead( TWITransaction& transaction, uint8_t address,
+                    const void* writeData, uint8_t writeLength,
+                    void* readData, uint8_t readLength,
+                    TWICompleteHandler handler = 0 )
+    {
+        uint8_t state = transaction.state;
+        if (state == TWI_TRANSACTION_QUEUED || state == TWI_TRANSACTION_ACTIVE)
+        {
+            return false;
+        }
+        transaction.address = address;
+        transaction.writeData = (const uint8_t*)writeData;
+        transaction.writeLength = writeLength;
+        transaction.readData = (uint8_t*)readData;
+        transaction.readLength = readLength;
+        transaction.handler = handler;
+        return ::queueTWITransaction( &transaction );
+    }
+
+    bool isIdle()
+    {
+        return ::isTWIIdle();
+    }
+
+    bool recoverBus()
+    {
+        return ::recoverTWIBus();
+    }
+};
+
+#endif
+
+#endif /* TWIMASTER_H_ */
@@ -0,0 +1,139 @@
+/*
+    Timebase.cpp - A free-running microsecond-timebase, that uses a 16-bit
+    Timer/Counter of an AVR-Microcontroller.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "Timebase.h"
+
+#ifndef F_CPU
+#error "F_CPU (the clock-frequency in Hz) must be defined for Timebase.cpp"
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Registers of the Timer/Counter
+//////////////////////////////////////////////////////////////////////////
+
+#if TIMEBASE_TIMER == 1
+    #define _TB_TCCRA           TCCR1A
+    #define _TB_TCCRB           TCCR1B
+    #define _TB_TCNT            TCNT1
+    #define _TB_TIMSK           TIMSK1
+    #define _TB_TIFR            TIFR1
+    #define _TB_TOIE            TOIE1
+    #define _TB_TOV             TOV1
+    #define _TB_CS1             CS11
+    #define _TB_OVF_vect        TIMER1_OVF_vect
+#elif TIMEBASE_TIMER == 3
+    #ifndef TCNT3
+    #error "Timer/Counter3 doesn't exist on this microcontroller"
+    #endif
+    #define _TB_TCCRA           TCCR3A
+    #define _TB_TCCRB           TCCR3B
+    #define _TB_TCNT            TCNT3
+    #define _TB_TIMSK           TIMSK3
+    #define _TB_TIFR            TIFR3
+    #define _TB_TOIE            TOIE3
+    #define _TB_TOV             TOV3
+    #define _TB_CS1             CS31
+    #define _TB_OVF_vect        TIMER3_OVF_vect
+#else
+    #error "TIMEBASE_TIMER must be 1 or 3"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// Overflow-Interrupt
+//////////////////////////////////////////////////////////////////////////
+
+//The upper 16 bits of the tick-counter
+static volatile uint16_t _timebaseOverflows;
+
+ISR(_TB_OVF_vect)
+{
+    _timebaseOverflows++;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+void initTimebase( void )
+{
+    uint8_t sreg = SREG;
+    cli();
+    _TB_TCCRB = 0;                  //stop the Timer/Counter
+    _TB_TCCRA = 0;                  //Normal-mode, no compare-outputs
+    _TB_TCNT = 0;
+    _timebaseOverflows = 0;
+    _TB_TIFR = (1<<_TB_TOV);        //clear a pending overflow
+    _TB_TIMSK |= (1<<_TB_TOIE);
+    _TB_TCCRB = (1<<_TB_CS1);       //start with prescaler 8
+    SREG = sreg;
+}
+
+uint32_t readTimebaseTicks( void )
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t low = _TB_TCNT;
+    uint16_t high = _timebaseOverflows;
+    //The Timer/Counter has overflowed, but the Interrupt-Service-Routine
+    //hasn't counted it yet. If TCNT has been read before the overflow, it is
+    //still near 0xFFFF, then the overflow doesn't belong to `low` yet.
+    if ((_TB_TIFR & (1<<_TB_TOV)) && low < 0x8000)
+    {
+        high++;
+    }
+    SREG = sreg;
+    return ((uint32_t)high << 16) | low;
+}
+
+uint32_t timebaseTicksToMicros( uint32_t ticks )
+{
+#if (TIMEBASE_TICKS_PER_SECOND % 1000000) == 0
+    //whole number of ticks per microsecond (8MHz: 1, 16MHz: 2): a division
+    //by a constant (a shift for powers of two)
+    return ticks / (TIMEBASE_TICKS_PER_SECOND / 1000000);
+#else
+    return (uint32_t)( (uint64_t)ticks * 1000000 / TIMEBASE_TICKS_PER_SECOND );
+#endif
+}
+
+uint32_t readTimebaseMicros( void )
+{
+    return timebaseTicksToMicros( readTimebaseTicks() );
+}
+
+//Replaces the weak version of ExternalInterrupts.cpp (which returns 0)
+uint32_t _extIntTimestamp( void )
+{
+    return readTimebaseTicks();
+}
+
+//Replaces the weak version of EventLoop.cpp (which returns false)
+bool _eventLoopTimestamp( uint32_t* ticks )
+{
+    //stopped, if no clock is selected (initTimebase has not been called)
+    if (!(_TB_TCCRB & 0x07)) return false;
+    *ticks = readTimebaseTicks();
+    return true;
+}
@@ -0,0 +1,111 @@
+/*
+    Timebase.h - A free-running microsecond-timebase, that uses a 16-bit
+    Timer/Counter of an AVR-Microcontroller.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+
+/**
+ * The 16-bit Timer/Counter used for the timebase: 1 (Timer/Counter1, the
+ * default) or 3 (Timer/Counter3, only on the ATmega2560). Define it with 3
+ * when compiling Timebase.cpp, if Timer/Counter1 is needed for something else
+ * (for example for Hardware-PWM).
+ *
+ * The timebase uses the Timer/Counter completely: It runs in Normal-mode, and
+ * the Overflow-Interrupt-Service-Routine (TIMER1_OVF_vect or TIMER3_OVF_vect)
+ * is part of this module.
+ */
+#ifndef TIMEBASE_TIMER
+#define TIMEBASE_TIMER      1
+#endif
+
+/**
+ * The Timer/Counter runs with the clock-frequency `F_CPU` divided by 8. So at
+ * 16MHz one tick is 0.5 microseconds, and the 32-bit tick-counter overflows
+ * after about 35 minutes.
+ */
+#define TIMEBASE_PRESCALER          8
+#ifdef F_CPU
+#define TIMEBASE_TICKS_PER_SECOND   (F_CPU / TIMEBASE_PRESCALER)
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Starts the timebase: The Timer/Counter is reset to 0 and starts counting,
+ * and its Overflow-Interrupt is enabled. Interrupts must be globally enabled
+ * (with `sei()`), otherwise the upper 16 bits of the tick-counter don't
+ * count.
+ */
+void initTimebase( void );
+
+/**
+ * Returns the number of ticks (1/`TIMEBASE_TICKS_PER_SECOND` seconds) since
+ * `initTimebase` has been called. The lower 16 bits are the Timer/Counter,
+ * the upper 16 bits count its overflows.
+ *
+ * It can be called from the main-loop and from Interrupt-Service-Routines.
+ * An overflow, whose Interrupt-Service-Routine has not run yet (because
+ * interrupts are disabled), is taken into account, so the returned value
+ * never jumps back. Interrupts are disabled for a few instructions only.
+ *
+ * To measure a time-interval, subtract two tick-values (as `uint32_t`, then
+ * the result is correct even across an overflow of the tick-counter).
+ */
+uint32_t readTimebaseTicks( void );
+
+/**
+ * Returns the number of microseconds since `initTimebase` has been called.
+ * Same as `timebaseTicksToMicros( readTimebaseTicks() )`, so the result
+ * overflows together with the tick-counter, not after 2^32 microseconds.
+ */
+uint32_t readTimebaseMicros( void );
+
+/**
+ * Converts a number of ticks (for example a difference of two values of
+ * `readTimebaseTicks`) to microseconds.
+ */
+uint32_t timebaseTicksToMicros( uint32_t ticks );
+
+//The timestamp of an event of an external Interrupt (see
+//`setExtIntTimestamping`): the ticks of the timebase. Only used by
+//ExternalInterrupts.cpp.
+uint32_t _extIntTimestamp( void );
+
+//The time of a wake-up of the event-loop (see `markEventLoopWake`): the
+//ticks of the timebase, or false, if it isn't running. Only used by
+//EventLoop.cpp.
+bool _eventLoopTimestamp( uint32_t* ticks );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMEBASE_H_ */
@@ -0,0 +1,384 @@
+/*
+    USART.cpp - An interrupt-driven, buffered driver for the USART-interfaces
+    of AVR-Microcontrollers (asynchronous mode).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "USART.h"
+#include "RingBuffer.h"
+#include "SFR.h"
+
+#ifndef F_CPU
+#error "F_CPU (the clock-frequency in Hz) must be defined for USART.cpp"
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// Registers of the USART-interfaces
+//////////////////////////////////////////////////////////////////////////
+
+//The Special-Function-Registers of one USART-interface
+typedef struct
+{
+    sfr8_t* ucsra;
+    sfr8_t* ucsrb;
+    sfr8_t* ucsrc;
+    sfr16_t* ubrr;
+    sfr8_t* udr;
+} _USARTRegisters;
+
+static const _USARTRegisters _usartRegisters[USART_COUNT] PROGMEM =
+{
+    { &UCSR0A, &UCSR0B, &UCSR0C, &UBRR0, &UDR0 },
+#if USART_COUNT > 1
+    { &UCSR1A, &UCSR1B, &UCSR1C, &UBRR1, &UDR1 },
+#endif
+#if USART_COUNT > 2
+    { &UCSR2A, &UCSR2B, &UCSR2C, &UBRR2, &UDR2 },
+#endif
+#if USART_COUNT > 3
+    { &UCSR3A, &UCSR3B, &UCSR3C, &UBRR3, &UDR3 },
+#endif
+};
+
+static inline sfr8_t* _getUCSRBRegister( uint8_t usartNumber )
+{
+    return (sfr8_t*) pgm_read_ptr( &_usartRegisters[usartNumber].ucsrb );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Buffers and transmit-queue
+//////////////////////////////////////////////////////////////////////////
+
+//Where the bytes of a queued block come from
+#define _TX_FROM_BUFFER     0   //the transmit-buffer (bytes of writeUSART)
+#define _TX_FROM_RAM        1
+#define _TX_FROM_PROGMEM    2
+
+//A block of bytes queued for transmission
+typedef struct
+{
+    const uint8_t* start;   //first byte (to find the block again)
+    const uint8_t* next;    //next byte to send (not used for _TX_FROM_BUFFER)
+    uint16_t length;        //bytes not sent yet
+    uint8_t source;
+} _TxBlock;
+
+//All data of one USART-interface. The blocks are a queue like RingBuffer:
+//blocks[blockRead] is being sent, blocks[blockWrite] is the next free one.
+//The main-loop changes blocks only with interrupts disabled.
+typedef struct
+{
+    RingBuffer<uint8_t, USART_RX_BUFFER_SIZE> rxBuffer;
+    RingBuffer<uint8_t, USART_TX_BUFFER_SIZE> txBuffer;
+    _TxBlock blocks[USART_TX_QUEUE_SIZE];
+    volatile uint8_t blockRead;
+    volatile uint8_t blockWrite;
+} _USARTState;
+
+static_assert( USART_TX_QUEUE_SIZE >= 2 && USART_TX_QUEUE_SIZE <= 128
+               && (USART_TX_QUEUE_SIZE & (USART_TX_QUEUE_SIZE-1)) == 0,
+               "USART_TX_QUEUE_SIZE must be a power of two between 2 and 128" );
+
+static _USARTState _usartStates[USART_COUNT];
+
+static inline _TxBlock& _getBlock( _USARTState& state, uint8_t index )
+{
+    return state.blocks[index & (USART_TX_QUEUE_SIZE-1)];
+}
+
+static inline bool _isQueueFull( _USARTState& state )
+{
+    return (uint8_t)(state.blockWrite - state.blockRead) == USART_TX_QUEUE_SIZE;
+}
+
+//Must be called with interrupts disabled
+static inline bool _isNewestBlockFromBuffer( _USARTState& state )
+{
+    uint8_t blockWrite = state.blockWrite;
+    return blockWrite != state.blockRead
+           && _getBlock(state, blockWrite-1).source == _TX_FROM_BUFFER;
+}
+
+//Starts the Data-Register-Empty-Interrupt, which sends the queued blocks.
+//Must be called with interrupts disabled.
+static inline void _startTransmit( uint8_t usartNumber )
+{
+    *_getUCSRBRegister(usartNumber) |= (1<<UDRIE0);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Interrupt-Service-Routines
+//////////////////////////////////////////////////////////////////////////
+
+static inline void _receive( _USARTState& state, sfr8_t& udr )
+{
+    //a full buffer is counted by the drop-count of rxBuffer
+    state.rxBuffer.push( udr );
+}
+
+//Sends the next byte of the oldest block
+static inline void _transmit( _USARTState& state, sfr8_t& ucsrb, sfr8_t& udr )
+{
+    uint8_t blockRead = state.blockRead;
+    if (blockRead == state.blockWrite)
+    {
+        //nothing more to send
+        ucsrb &= ~(1<<UDRIE0);
+        return;
+    }
+
+    _TxBlock& block = _getBlock( state, blockRead );
+    uint8_t byte;
+    if (block.source == _TX_FROM_BUFFER)
+    {
+        state.txBuffer.pop( byte );
+    }
+    else if (block.source == _TX_FROM_RAM)
+    {
+        byte = *block.next++;
+    }
+    else
+    {
+        byte = pgm_read_byte( block.next++ );
+    }
+    udr = byte;
+
+    if (--block.length == 0)
+    {
+        state.blockRead = blockRead + 1;
+    }
+}
+
+#if defined(USART0_RX_vect)
+ISR(USART0_RX_vect) { _receive( _usartStates[0], UDR0 ); }
+ISR(USART0_UDRE_vect) { _transmit( _usartStates[0], UCSR0B, UDR0 ); }
+#else
+//ATmega328p
+ISR(USART_RX_vect) { _receive( _usartStates[0], UDR0 ); }
+ISR(USART_UDRE_vect) { _transmit( _usartStates[0], UCSR0B, UDR0 ); }
+#endif
+#if USART_COUNT > 1
+ISR(USART1_RX_vect) { _receive( _usartStates[1], UDR1 ); }
+ISR(USART1_UDRE_vect) { _transmit( _usartStates[1], UCSR1B, UDR1 ); }
+#endif
+#if USART_COUNT > 2
+ISR(USART2_RX_vect) { _receive( _usartStates[2], UDR2 ); }
+ISR(USART2_UDRE_vect) { _transmit( _usartStates[2], UCSR2B, UDR2 ); }
+#endif
+#if USART_COUNT > 3
+ISR(USART3_RX_vect) { _receive( _usartStates[3], UDR3 ); }
+ISR(USART3_UDRE_vect) { _transmit( _usartStates[3], UCSR3B, UDR3 ); }
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+void initUSART( uint8_t usartNumber, uint32_t baudrate )
+{
+    if (usartNumber >= USART_COUNT || baudrate == 0) return;
+
+    const _USARTRegisters* regs = &_usartRegisters[usartNumber];
+    sfr8_t* ucsra = (sfr8_t*) pgm_read_ptr( &regs->ucsra );
+    sfr8_t* ucsrb = (sfr8_t*) pgm_read_ptr( &regs->ucsrb );
+    sfr8_t* ucsrc = (sfr8_t*) pgm_read_ptr( &regs->ucsrc );
+    sfr16_t* ubrr = (sfr16_t*) pgm_read_ptr( &regs->ubrr );
+    _USARTState& state = _usartStates[usartNumber];
+
+    uint8_t sreg = SREG;
+    cli();
+    *ucsrb = 0;     //stop receiver, transmitter and their interrupts
+
+    //forget everything of an earlier initialization
+    uint8_t byte;
+    while (state.rxBuffer.pop( byte )) { }
+    while (state.txBuffer.pop( byte )) { }
+    state.blockRead = state.blockWrite;
+
+    //double-speed-mode: baudrate = F_CPU / (8 * (UBRR+1)), rounded
+    *ubrr = (uint16_t)( (F_CPU / 4 / baudrate - 1) / 2 );
+    *ucsra = (1<<U2X0);
+    *ucsrc = (1<<UCSZ01) | (1<<UCSZ00);
+    *ucsrb = (1<<RXCIE0) | (1<<RXEN0) | (1<<TXEN0);
+    SREG = sreg;
+}
+
+uint8_t writeUSART( uint8_t usartNumber, const uint8_t* data, uint8_t length )
+{
+    if (usartNumber >= USART_COUNT || length == 0) return 0;
+    _USARTState& state = _usartStates[usartNumber];
+
+    //The bytes need a block of the queue, unless they can be appended to the
+    //newest block. (If that block is finished meanwhile, its place is free.)
+    if (_isQueueFull(state) && !_isNewestBlockFromBuffer(state)) return 0;
+
+    uint8_t count = 0;
+    while (count < length && state.txBuffer.push( data[count] ))
+    {
+        count++;
+    }
+    if (count == 0) return 0;
+
+    uint8_t sreg = SREG;
+    cli();
+    if (_isNewestBlockFromBuffer(state))
+    {
+        _getBlock(state, state.blockWrite-1).length += count;
+    }
+    else
+    {
+        _TxBlock& block = _getBlock(state, state.blockWrite);
+        block.start = 0;
+        block.next = 0;
+        block.length = count;
+        block.source = _TX_FROM_BUFFER;
+        state.blockWrite = state.blockWrite + 1;
+    }
+    _startTransmit( usartNumber );
+    SREG = sreg;
+    return count;
+}
+
+bool writeUSARTByte( uint8_t usartNumber, uint8_t byte )
+{
+    return writeUSART( usartNumber, &byte, 1 ) == 1;
+}
+
+static bool _queueBlock( uint8_t usartNumber, const void* data,
+                         uint16_t length, uint8_t source )
+{
+    if (usartNumber >= USART_COUNT || length == 0) return false;
+    _USARTState& state = _usartStates[usartNumber];
+
+    uint8_t sreg = SREG;
+    cli();
+    bool queued = !_isQueueFull(state);
+    if (queued)
+    {
+        _TxBlock& block = _getBlock(state, state.blockWrite);
+        block.start = (const uint8_t*)data;
+        block.next = (const uint8_t*)data;
+        block.length = length;
+        block.source = source;
+        state.blockWrite = state.blockWrite + 1;
+        _startTransmit( usartNumber );
+    }
+    SREG = sreg;
+    return queued;
+}
+
+bool queueUSARTBlock( uint8_t usartNumber, const void* data, uint16_t length )
+{
+    return _queueBlock( usartNumber, data, length, _TX_FROM_RAM );
+}
+
+bool queueUSARTBlock_P( uint8_t usartNumber, const void* data,
+                        uint16_t length )
+{
+    return _queueBlock( usartNumber, data, length, _TX_FROM_PROGMEM );
+}
+
+bool queueUSARTString_P( uint8_t usartNumber, PGM_P string )
+{
+    return _queueBlock( usartNumber, string, strlen_P(string),
+                        _TX_FROM_PROGMEM );
+}
+
+bool isUSARTBlockQueued( uint8_t usartNumber, const void* data )
+{
+    if (usartNumber >= USART_COUNT) return false;
+    _USARTState& state = _usartStates[usartNumber];
+
+    bool found = false;
+    uint8_t sreg = SREG;
+    cli();
+    for (uint8_t i = state.blockRead; i != state.blockWrite; i++)
+    {
+        _TxBlock& block = _getBlock(state, i);
+        if (block.source != _TX_FROM_BUFFER && block.start == data)
+        {
+            found = true;
+            break;
+        }
+    }
+    SREG = sreg;
+    return found;
+}
+
+bool isUSARTTransmitIdle( uint8_t usartNumber )
+{
+    if (usartNumber >= USART_COUNT) return true;
+    _USARTState& state = _usartStates[usartNumber];
+    return state.blockRead == state.blockWrite;
+}
+
+bool readUSARTByte( uint8_t usartNumber, uint8_t* byte )
+{
+    if (usartNumber >= USART_COUNT) return false;
+    return _usartStates[usartNumber].rxBuffer.pop( *byte );
+}
+
+uint8_t readUSART( uint8_t usartNumber, uint8_t* buffer, uint8_t maxLength )
+{
+    if (usartNumber >= USART_COUNT) return 0;
+    _USARTState& state = _usartStates[usartNumber];
+
+    uint8_t count = 0;
+    while (count < maxLength && state.rxBuffer.pop( buffer[count] ))
+    {
+        count++;
+    }
+    return count;
+}
+
+uint8_t getUSARTReceivedCount( uint8_t usartNumber )
+{
+    if (usartNumber >= USART_COUNT) return 0;
+    return _usartStates[usartNumber].rxBuffer.getCount();
+}
+
+uint8_t getUSARTReceiveDropCount( uint8_t usartNumber )
+{
+    if (usartNumber >= USART_COUNT) return 0;
+    return _usartStates[usartNumber].rxBuffer.getDropCount();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// C++ object-oriented API
+//////////////////////////////////////////////////////////////////////////
+
+USART::USART( uint8_t usartNumber, uint32_t baudrate )
+{
+    if (usartNumber >= USART_COUNT)
+    {
+        //This is an invalid object (No USART-interface with this number).
+        //All methods do nothing.
+        _usartNumber = 0xFF;
+        return;
+    }
+    _usartNumber = usartNumber;
+    initUSART( usartNumber, baudrate );
+}
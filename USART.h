@@ -0,0 +1,291 @@
+/*
+    USART.h - An interrupt-driven, buffered driver for the USART-interfaces
+    of AVR-Microcontrollers (asynchronous mode).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef USART_H_
+#define USART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+/**
+ * Number of USART-interfaces: 4 on the ATmega2560 (USART0...USART3), 1 on
+ * the ATmega328p (USART0).
+ */
+#if defined(UDR3)
+#define USART_COUNT     4
+#elif defined(UDR1)
+#define USART_COUNT     2
+#else
+#define USART_COUNT     1
+#endif
+
+/**
+ * Sizes (in bytes, a power of two between 2 and 128) of the receive- and
+ * transmit-buffers of each USART-interface. Define them with other values
+ * when compiling USART.cpp, if needed.
+ */
+#ifndef USART_RX_BUFFER_SIZE
+#define USART_RX_BUFFER_SIZE    32
+#endif
+
+#ifndef USART_TX_BUFFER_SIZE
+#define USART_TX_BUFFER_SIZE    32
+#endif
+
+/**
+ * Maximum number of blocks (a power of two between 2 and 128), that can be
+ * queued for transmission on each USART-interface (see `queueUSARTBlock`).
+ * Bytes written with `writeUSART` use one block together, as long as no
+ * other block is queued between them.
+ */
+#ifndef USART_TX_QUEUE_SIZE
+#define USART_TX_QUEUE_SIZE     4
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// C-Function-API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initializes a USART-interface for asynchronous transmission with 8 data-
+ * bits, no parity and 1 stop-bit (8N1), and enables the receiver and the
+ * transmitter. The pins RXDn and TXDn are taken over by the USART-interface.
+ * Received bytes are put into the receive-buffer by an Interrupt-Service-
+ * Routine, so interrupts must be globally enabled (with `sei()`).
+ *
+ * @param usartNumber The Number of the USART-interface (0...3 on the
+ *      ATmega2560, 0 on the ATmega328p).
+ * @param baudrate The baudrate in bits per second, for example 9600 or
+ *      115200. The next possible baudrate (in double-speed-mode) is used.
+ */
+void initUSART( uint8_t usartNumber, uint32_t baudrate );
+
+/**
+ * Copies bytes into the transmit-buffer and returns immediately. The bytes
+ * are sent by the Interrupt-Service-Routine in the background.
+ *
+ * @param usartNumber The Number of the USART-interface
+ * @param data The bytes to send
+ * @param length The number of bytes to send
+ * @return The number of bytes copied into the transmit-buffer. Less than
+ *      `length`, if the buffer is full (the remaining bytes are not sent).
+ */
+uint8_t writeUSART( uint8_t usartNumber, const uint8_t* data, uint8_t length );
+
+/**
+ * Copies one byte into the transmit-buffer.
+ *
+ * @param usartNumber The Number of the USART-interface
+ * @param byte The byte to send
+ * @return true, if the byte has been copied, false if the buffer is full.
+ */
+bool writeUSARTByte( uint8_t usartNumber, uint8_t byte );
+
+/**
+ * Queues a block of memory (RAM) for transmission, without copying it. The
+ * Interrupt-Service-Routine sends the bytes directly from the block, in the
+ * order in which blocks and bytes (see `writeUSART`) have been queued.
+ * The block must not be changed, until `isUSARTBlockQueued` returns false.
+ *
+ * @param usartNumber The Number of the USART-interface
+ * @param data The block to send
+ * @param length The number of bytes to send (1...65535)
+ * @return true, if the block has been queued, false if the queue is full
+ *      (`USART_TX_QUEUE_SIZE` blocks) or `length` is 0.
+ */
+bool queueUSARTBlock( uint8_t usartNumber, const void* data, uint16_t length );
+
+/**
+ * Queues a block in the program-memory (FLASH, for example a string defined
+ * with `PSTR` or `PROGMEM`) for transmission, without copying it.
+ * See `queueUSARTBlock`.
+ *
+ * @param usartNumber The Number of the USART-interface
+ * @param data The block in the program-memory to send
+ * @param length The number of bytes to send (1...65535)
+ * @return true, if the block has been queued, false if the queue is full or
+ *      `length` is 0.
+ */
+bool queueUSARTBlock_P( uint8_t usartNumber, const void* data,
+                        uint16_t length );
+
+/**
+ * Queues a 0-terminated string in the program-memory for transmission (the
+ * terminating 0 is not sent). For example:
+ * {@code
+ *     queueUSARTString_P( 0, PSTR("Hello World\r\n") );
+ * }
+ *
+ * @return true, if the string has been queued, false if the queue is full
+ *      or the string is empty.
+ */
+bool queueUSARTString_P( uint8_t usartNumber, PGM_P string );
+
+/**
+ * Returns true, if the block starting at `data` (queued with
+ * `queueUSARTBlock` or `queueUSARTBlock_P`) has not been sent completely.
+ * As long as this is the case, the block must not be changed.
+ */
+bool isUSARTBlockQueued( uint8_t usartNumber, const void* data );
+
+/**
+ * Returns true, if all queued bytes and blocks have been handed over to the
+ * USART-interface (the last byte may still be shifted out).
+ */
+bool isUSARTTransmitIdle( uint8_t usartNumber );
+
+/**
+ * Takes one received byte out of the receive-buffer.
+ *
+ * @param usartNumber The Number of the USART-interface
+ * @param byte Receives the byte
+ * @return true, if a byte has been taken, false if no byte has been received.
+ */
+bool readUSARTByte( uint8_t usartNumber, uint8_t* byte );
+
+/**
+ * Takes received bytes out of the receive-buffer.
+ *
+ * @param usartNumber The Number of the USART-interface
+ * @param buffer Receives the bytes
+ * @param maxLength The size of `buffer`
+ * @return The number of bytes taken (0, if no byte has been received).
+ */
+uint8_t readUSART( uint8_t usartNumber, uint8_t* buffer, uint8_t maxLength );
+
+/**
+ * Returns the number of received bytes in the receive-buffer.
+ */
+uint8_t getUSARTReceivedCount( uint8_t usartNumber );
+
+/**
+ * Returns the number of received bytes, that have been lost, because the
+ * receive-buffer was full (counts up to 255).
+ */
+uint8_t getUSARTReceiveDropCount( uint8_t usartNumber );
+
+#ifdef __cplusplus
+}
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// C++ object-oriented API
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+
+/**
+ * Class for a USART-interface. See the C-functions for a description of the
+ * methods.
+ *
+ * For example:
+ * {@code
+ *     USART serial = USART( 0, 115200 );
+ *     sei();
+ *     serial.queueString_P( PSTR("Hello World\r\n") );
+ *     uint8_t byte;
+ *     while (1) {
+ *         if (serial.readByte( &byte )) serial.writeByte( byte );
+ *         //... other things, the main-loop never waits for the USART
+ *     }
+ * }
+ */
+class USART
+{
+public:
+    /**
+     * Constructor. Initializes the USART-interface (see `initUSART`).
+     *
+     * @param usartNumber The Number of the USART-interface. If it doesn't
+     *      exist, the object is invalid and all methods do nothing.
+     * @param baudrate The baudrate in bits per second
+     */
+    USART( uint8_t usartNumber, uint32_t baudrate );
+
+    uint8_t write( const uint8_t* data, uint8_t length )
+    {
+        return ::writeUSART(_usartNumber, data, length);
+    }
+
+    bool writeByte( uint8_t byte )
+    {
+        return ::writeUSARTByte(_usartNumber, byte);
+    }
+
+    bool queueBlock( const void* data, uint16_t length )
+    {
+        return ::queueUSARTBlock(_usartNumber, data, length);
+    }
+
+    bool queueBlock_P( const void* data, uint16_t length )
+    {
+        return ::queueUSARTBlock_P(_usartNumber, data, length);
+    }
+
+    bool queueString_P( PGM_P string )
+    {
+        return ::queueUSARTString_P(_usartNumber, string);
+    }
+
+    bool isBlockQueued( const void* data )
+    {
+        return ::isUSARTBlockQueued(_usartNumber, data);
+    }
+
+    bool isTransmitIdle()
+    {
+        return ::isUSARTTransmitIdle(_usartNumber);
+    }
+
+    bool readByte( uint8_t* byte )
+    {
+        return ::readUSARTByte(_usartNumber, byte);
+    }
+
+    uint8_t read( uint8_t* buffer, uint8_t maxLength )
+    {
+        return ::readUSART(_usartNumber, buffer, maxLength);
+    }
+
+    uint8_t getReceivedCount()
+    {
+        return ::getUSARTReceivedCount(_usartNumber);
+    }
+
+    uint8_t getReceiveDropCount()
+    {
+        return ::getUSARTReceiveDropCount(_usartNumber);
+    }
+
+private:
+    uint8_t _usartNumber;
+};
+
+#endif
+
+#endif /* USART_H_ */
@@ -0,0 +1,552 @@
+/*
+    Benchmarks.cpp - One small function for each function and method of
+    GPIO.h and ExternalInterrupts.h, whose cost is measured by
+    run_benchmarks.py (see doc/Benchmarks.md).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "GPIO.h"
+#include "GPIOTransaction.h"
+#include "EventLoop.h"
+#include "ExternalInterrupts.h"
+#include "PinChangeInterrupts.h"
+#include "AnalogInput.h"
+#include "AnalogFilter.h"
+#include "SPIMaster.h"
+#include "TWIMaster.h"
+#include "QuadratureEncoder.h"
+#include "HardwarePWM.h"
+#include "SoftPWM.h"
+#include "USART.h"
+#include "Debounce.h"
+
+//Each benchmark is a function `bench_<name>`, that makes exactly one call
+//of the library with typical (constant) arguments. The function is never
+//inlined, so on the microcontroller it can be found in the disassembly by
+//its name. Everything it calls (also code of the library in other files)
+//belongs to its cost.
+#define BENCHMARK(name) \
+    extern "C" __attribute__((noinline, used)) void bench_ ## name (void)
+
+static GPIOPin _benchPin = GPIOPin( port_B, 3, MODE_OUTPUT );
+static GPIOPort _benchPort = GPIOPort( port_B );
+static ExtInt _benchExtInt = ExtInt( 2, EXTINT_FALLING_EDGE, false );
+static ExtIntEvent _benchEvent;
+static volatile uint8_t _benchResult;
+static volatile uint32_t _benchResult32;
+
+static void _benchHandler( void ) { }
+static void _benchPinChangeHandler( uint8_t voltageLevel )
+{
+    (void)voltageLevel;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// GPIO.h, C-Functions
+//////////////////////////////////////////////////////////////////////////
+
+BENCHMARK(setPinMode)       { setPinMode( port_B, 3, MODE_OUTPUT ); }
+BENCHMARK(setPinPullup)     { setPinPullup( port_B, 3, PULLUP_ON ); }
+BENCHMARK(writePin)         { writePin( port_B, 3, HIGH_LEVEL ); }
+BENCHMARK(writePin_portL)   { writePin( port_L, 3, HIGH_LEVEL ); }
+BENCHMARK(readPin)          { _benchResult = readPin( port_B, 3 ); }
+BENCHMARK(togglePin)        { togglePin( port_B, 3 ); }
+BENCHMARK(setPortMode)      { setPortMode( port_B, 0xFF, 0x0F ); }
+BENCHMARK(setPortPullup)    { setPortPullup( port_B, 0xFF, 0x0F ); }
+BENCHMARK(writePort)        { writePort( port_B, 0x05, 0x0F ); }
+BENCHMARK(readPort)         { _benchResult = readPort( port_B, 0x0F ); }
+BENCHMARK(togglePort)       { togglePort( port_B, 0x0F ); }
+
+
+//////////////////////////////////////////////////////////////////////////
+// GPIO.h, C++-Classes
+//////////////////////////////////////////////////////////////////////////
+
+BENCHMARK(GPIOPin_GPIOPin)
+{
+    GPIOPin pin = GPIOPin( port_B, 3, MODE_OUTPUT );
+    (void)pin;
+}
+BENCHMARK(GPIOPin_setPinMode)   { _benchPin.setPinMode( MODE_OUTPUT ); }
+BENCHMARK(GPIOPin_setPinPullup) { _benchPin.setPinPullup( PULLUP_ON ); }
+BENCHMARK(GPIOPin_writePin)     { _benchPin.writePin( HIGH_LEVEL ); }
+BENCHMARK(GPIOPin_readPin)      { _benchResult = _benchPin.readPin(); }
+BENCHMARK(GPIOPin_togglePin)    { _benchPin.togglePin(); }
+
+BENCHMARK(FastPin_setPinMode)   { FastPin<port_B,3>::setPinMode( MODE_OUTPUT ); }
+BENCHMARK(FastPin_setPinPullup) { FastPin<port_B,3>::setPinPullup( PULLUP_ON ); }
+BENCHMARK(FastPin_writePin)     { FastPin<port_B,3>::writePin( HIGH_LEVEL ); }
+#ifdef PORTL
+BENCHMARK(FastPin_writePin_portL) { FastPin<port_L,3>::writePin( HIGH_LEVEL ); }
+#endif
+BENCHMARK(FastPin_readPin)      { _benchResult = FastPin<port_B,3>::readPin(); }
+BENCHMARK(FastPin_togglePin)    { FastPin<port_B,3>::togglePin(); }
+
+BENCHMARK(GPIOPort_setPortMode)   { _benchPort.setPortMode( 0xFF, 0x0F ); }
+BENCHMARK(GPIOPort_setPortPullup) { _benchPort.setPortPullup( 0xFF, 0x0F ); }
+BENCHMARK(GPIOPort_writePort)     { _benchPort.writePort( 0x05, 0x0F ); }
+BENCHMARK(GPIOPort_readPort)      { _benchResult = _benchPort.readPort( 0x0F ); }
+BENCHMARK(GPIOPort_togglePort)    { _benchPort.togglePort( 0x0F ); }
+
+//Six pin-changes on two ports: one after the other, and as transaction
+BENCHMARK(writePin_6pins)
+{
+    writePin( port_B, 0, HIGH_LEVEL );
+    writePin( port_B, 1, LOW_LEVEL );
+    writePin( port_B, 2, HIGH_LEVEL );
+    writePin( port_B, 3, HIGH_LEVEL );
+    writePin( port_C, 0, LOW_LEVEL );
+    writePin( port_C, 1, HIGH_LEVEL );
+}
+BENCHMARK(GPIOTransaction_6pins)
+{
+    GPIOTransaction transaction;
+    transaction.writePin( port_B, 0, HIGH_LEVEL );
+    transaction.writePin( port_B, 1, LOW_LEVEL );
+    transaction.writePin( port_B, 2, HIGH_LEVEL );
+    transaction.writePin( port_B, 3, HIGH_LEVEL );
+    transaction.writePin( port_C, 0, LOW_LEVEL );
+    transaction.writePin( port_C, 1, HIGH_LEVEL );
+    transaction.commit();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// ExternalInterrupts.h, C-Functions
+//////////////////////////////////////////////////////////////////////////
+
+BENCHMARK(setExtIntEventType)   { setExtIntEventType( 2, EXTINT_FALLING_EDGE ); }
+BENCHMARK(enableExtInt)         { enableExtInt( 2 ); }
+BENCHMARK(disableExtInt)        { disableExtInt( 2 ); }
+BENCHMARK(clearPendingExtIntEvent) { clearPendingExtIntEvent( 2 ); }
+BENCHMARK(setExtIntHandler)     { setExtIntHandler( 2, _benchHandler ); }
+BENCHMARK(setExtIntQueueing)    { setExtIntQueueing( 2, true ); }
+BENCHMARK(setExtIntTimestamping) { setExtIntTimestamping( 2, true ); }
+BENCHMARK(getExtIntTimestamp)   { _benchResult32 = getExtIntTimestamp( 2 ); }
+BENCHMARK(setExtIntLockout)     { setExtIntLockout( 2, 20 ); }
+BENCHMARK(tickExtIntLockouts)   { tickExtIntLockouts(); }
+BENCHMARK(readExtIntEvent)      { _benchResult = readExtIntEvent( &_benchEvent ); }
+BENCHMARK(getExtIntEventDropCount) { _benchResult = getExtIntEventDropCount(); }
+
+
+//////////////////////////////////////////////////////////////////////////
+// ExternalInterrupts.h, C++-Classes
+//////////////////////////////////////////////////////////////////////////
+
+BENCHMARK(ExtInt_ExtInt)
+{
+    ExtInt extInt = ExtInt( 2, EXTINT_FALLING_EDGE, true );
+    (void)extInt;
+}
+BENCHMARK(ExtInt_setExtIntEventType) { _benchExtInt.setExtIntEventType( EXTINT_RISING_EDGE ); }
+BENCHMARK(ExtInt_enableExtInt)      { _benchExtInt.enableExtInt(); }
+BENCHMARK(ExtInt_disableExtInt)     { _benchExtInt.disableExtInt(); }
+BENCHMARK(ExtInt_clearPendingExtIntEvent) { _benchExtInt.clearPendingExtIntEvent(); }
+BENCHMARK(ExtInt_setExtIntHandler)  { _benchExtInt.setExtIntHandler( _benchHandler ); }
+BENCHMARK(ExtInt_setExtIntQueueing) { _benchExtInt.setExtIntQueueing( true ); }
+BENCHMARK(ExtInt_setExtIntTimestamping) { _benchExtInt.setExtIntTimestamping( true ); }
+BENCHMARK(ExtInt_getExtIntTimestamp) { _benchResult32 = _benchExtInt.getExtIntTimestamp(); }
+BENCHMARK(ExtInt_setExtIntLockout) { _benchExtInt.setExtIntLockout( 20 ); }
+
+BENCHMARK(FastExtInt_setExtIntEventType) { FastExtInt<1>::setExtIntEventType( EXTINT_RISING_EDGE ); }
+BENCHMARK(FastExtInt_enableExtInt)  { FastExtInt<1>::enableExtInt(); }
+BENCHMARK(FastExtInt_disableExtInt) { FastExtInt<1>::disableExtInt(); }
+BENCHMARK(FastExtInt_clearPendingExtIntEvent) { FastExtInt<1>::clearPendingExtIntEvent(); }
+
+
+//////////////////////////////////////////////////////////////////////////
+// PinChangeInterrupts.h
+//////////////////////////////////////////////////////////////////////////
+
+BENCHMARK(setPinChangeIntHandler) { setPinChangeIntHandler( 1, _benchPinChangeHandler ); }
+BENCHMARK(enablePinChangeInt)   { enablePinChangeInt( 1 ); }
+BENCHMARK(disablePinChangeInt)  { disablePinChangeInt( 1 ); }
+
+//The Interrupt-Service-Routine of bank 0 (PCINT0 ... PCINT7), with a
+//handler for PCINT0, whose pin has changed. It is analyzed on the
+//microcontroller by its vector-name. On the host the pin is toggled before
+//each call, so the handler is called.
+#ifdef SIMPLEAVRLIB_HOST
+extern "C" void PCINT0_vect( void );
+BENCHMARK(PCINT0_vect)
+{
+    PINB.value ^= 0x01;
+    PCINT0_vect();
+}
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// EventLoop.h
+//////////////////////////////////////////////////////////////////////////
+
+BENCHMARK(getEventLoopSleepMode) { _benchResult = getEventLoopSleepMode(); }
+BENCHMARK(runEventLoopOnce)     { _benchResult = runEventLoopOnce(); }
+BENCHMARK(markEventLoopWake)    { markEventLoopWake(); }
+
+//The Interrupt-Service-Routine of INT0 (with handler, queueing and
+//timestamping turned on) is analyzed on the microcontroller by its
+//vector-name __vector_1. On the host it is called by bench_INT0_vect.
+#ifdef SIMPLEAVRLIB_HOST
+extern "C" void INT0_vect( void );
+BENCHMARK(INT0_vect)        { INT0_vect(); }
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// AnalogInput.h
+//////////////////////////////////////////////////////////////////////////
+
+static const uint8_t _benchChannels[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3 };
+static uint16_t _benchSamples[ANALOG_SCAN_BUFFER_LENGTH( 12, 4 )];
+
+BENCHMARK(startAnalogScan)
+{
+    _benchResult = startAnalogScan( _benchChannels, 12, _benchSamples, 4,
+                                    ANALOG_REFERENCE_AVCC,
+                                    ANALOG_TRIGGER_FREE_RUNNING );
+}
+BENCHMARK(takeAnalogScanBlock)  { _benchResult = takeAnalogScanBlock() != 0; }
+BENCHMARK(releaseAnalogScanBlock) { releaseAnalogScanBlock(); }
+
+//The Interrupt-Service-Routine of the ADC: one sample of a scan of 12
+//channels (on the microcontroller the longest path, a complete block).
+#ifdef SIMPLEAVRLIB_HOST
+extern "C" void ADC_vect( void );
+BENCHMARK(ADC_vect)         { ADC_vect(); }
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// AnalogFilter.h (cost per sample)
+//////////////////////////////////////////////////////////////////////////
+
+static OversampleFilter<2> _benchOversample;
+static MovingAverageFilter<4> _benchMovingAverage;
+static MedianFilter<5> _benchMedian;
+static uint16_t _benchSample = 512;
+
+BENCHMARK(OversampleFilter_addSample)
+{
+    _benchResult = _benchOversample.addSample( _benchSample );
+}
+BENCHMARK(MovingAverageFilter_addSample)
+{
+    _benchResult = _benchMovingAverage.addSample( _benchSample );
+}
+BENCHMARK(MedianFilter_addSample)
+{
+    _benchResult = _benchMedian.addSample( _benchSample );
+}
+BENCHMARK(AnalogFilterBank_filterSample)
+{
+    _benchResult = AnalogFilterBank< OversampleFilter<2>, 12 >::filterSample(
+                       3, &_benchSample );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// SPIMaster.h
+//////////////////////////////////////////////////////////////////////////
+
+static SPITransaction _benchTransaction;
+static uint8_t _benchSPIData[64];
+
+BENCHMARK(initSPIMaster)
+{
+    initSPIMaster( SPI_CLOCK_DIV8, SPI_MODE_0, SPI_MSB_FIRST );
+}
+BENCHMARK(queueSPITransaction)
+{
+    _benchTransaction.txData = _benchSPIData;
+    _benchTransaction.rxData = _benchSPIData;
+    _benchTransaction.length = sizeof(_benchSPIData);
+    _benchTransaction.csPort = port_B;
+    _benchTransaction.csPinNumber = 4;
+    _benchResult = queueSPITransaction( &_benchTransaction );
+}
+
+//The Interrupt-Service-Routine of the SPI-interface: one byte in the middle
+//of a transaction (the end of a transaction costs two calls of writePin
+//more).
+#ifdef SIMPLEAVRLIB_HOST
+extern "C" void SPI_STC_vect( void );
+BENCHMARK(SPI_STC_vect)     { SPI_STC_vect(); }
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// TWIMaster.h
+//////////////////////////////////////////////////////////////////////////
+
+static TWITransaction _benchTWITransaction;
+
+BENCHMARK(initTWIMaster)        { initTWIMaster( 400000 ); }
+BENCHMARK(queueTWITransaction)
+{
+    _benchTWITransaction.address = 0x68;
+    _benchTWITransaction.writeData = _benchSPIData;
+    _benchTWITransaction.writeLength = sizeof(_benchSPIData);
+    _benchTWITransaction.readData = 0;
+    _benchTWITransaction.readLength = 0;
+    _benchTWITransaction.handler = 0;
+    _benchResult = queueTWITransaction( &_benchTWITransaction );
+}
+
+//The Interrupt-Service-Routine of the TWI-interface: a byte written within
+//a transaction (on the host the status is set to "data acknowledged").
+#ifdef SIMPLEAVRLIB_HOST
+extern "C" void TWI_vect( void );
+BENCHMARK(TWI_vect)
+{
+    TWSR.value = 0x28;
+    TWI_vect();
+}
+#endif
+
+
+
+//////////////////////////////////////////////////////////////////////////
+// QuadratureEncoder.h
+//////////////////////////////////////////////////////////////////////////
+
+typedef QuadratureEncoder<0, 1> _BenchEncoder;
+
+BENCHMARK(QuadratureEncoder_start)  { _BenchEncoder::start( PULLUP_ON ); }
+BENCHMARK(QuadratureEncoder_getPosition)
+{
+    _benchResult32 = _BenchEncoder::getPosition();
+}
+
+//The body of the Interrupt-Service-Routines of INT0 and INT1 (without
+//prologue and epilogue): one legal step.
+BENCHMARK(QuadratureEncoder_update) { _BenchEncoder::update(); }
+
+
+
+//////////////////////////////////////////////////////////////////////////
+// HardwarePWM.h
+//////////////////////////////////////////////////////////////////////////
+
+//An 8-Bit-Timer/Counter (prescaler and TOP 255 chosen at compile-time) and
+//a 16-Bit-Timer/Counter (TOP in ICR1)
+typedef HardwarePWM<0, 1000, PWM_MODE_FAST> _BenchPWM8;
+typedef HardwarePWM<1, 20000, PWM_MODE_PHASE_CORRECT> _BenchPWM16;
+
+BENCHMARK(HardwarePWM8_init)        { _BenchPWM8::init(); }
+BENCHMARK(HardwarePWM8_enableChannel) { _BenchPWM8::enableChannel( PWM_CHANNEL_A ); }
+BENCHMARK(HardwarePWM8_setDuty)     { _BenchPWM8::setDuty( PWM_CHANNEL_A, 100 ); }
+BENCHMARK(HardwarePWM8_setDuties)   { _BenchPWM8::setDuties( 100, 200 ); }
+BENCHMARK(HardwarePWM16_init)       { _BenchPWM16::init(); }
+BENCHMARK(HardwarePWM16_enableChannel) { _BenchPWM16::enableChannel( PWM_CHANNEL_A ); }
+BENCHMARK(HardwarePWM16_setDuty)    { _BenchPWM16::setDuty( PWM_CHANNEL_A, 100 ); }
+BENCHMARK(HardwarePWM16_setDuties)  { _BenchPWM16::setDuties( 100, 200 ); }
+
+//The writes of setDuties after waiting for the safe window (the cycles, that
+//HARDWAREPWM_WRITE_CYCLES must cover), with duties from variables, as in a
+//real program. The 16-Bit-Timer/Counter has three channels on the
+//ATmega2560.
+static volatile uint16_t _benchDuty = 100;
+BENCHMARK(HardwarePWM8_writeDuties)
+{
+    _BenchPWM8::_writeDuties( _benchDuty, _benchDuty );
+}
+BENCHMARK(HardwarePWM16_writeDuties)
+{
+#ifdef OCR1C
+    _BenchPWM16::_writeDuties( _benchDuty, _benchDuty, _benchDuty );
+#else
+    _BenchPWM16::_writeDuties( _benchDuty, _benchDuty );
+#endif
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// SoftPWM.h
+//////////////////////////////////////////////////////////////////////////
+
+//One channel (commitSoftPWM needs a time proportional to the square of the
+//number of channels)
+BENCHMARK(addSoftPWMChannel)    { _benchResult = addSoftPWMChannel( port_B, 0 ); }
+BENCHMARK(setSoftPWMDuty)       { setSoftPWMDuty( 0, 100 ); }
+BENCHMARK(commitSoftPWM)        { commitSoftPWM(); }
+
+//The Interrupt-Service-Routine of the Timer/Counter2 is analyzed on the
+//microcontroller by its vector-name (the longest path waits for close
+//output-changes). On the host it is called (with the Timer/Counter stopped)
+//by bench_TIMER2_COMPA_vect.
+#ifdef SIMPLEAVRLIB_HOST
+extern "C" void TIMER2_COMPA_vect( void );
+BENCHMARK(TIMER2_COMPA_vect)    { TIMER2_COMPA_vect(); }
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// USART.h
+//////////////////////////////////////////////////////////////////////////
+
+static uint8_t _benchByte;
+
+BENCHMARK(initUSART)            { initUSART( 0, 115200 ); }
+BENCHMARK(writeUSARTByte)       { _benchResult = writeUSARTByte( 0, 'a' ); }
+BENCHMARK(readUSARTByte)        { _benchResult = readUSARTByte( 0, &_benchByte ); }
+
+//The Interrupt-Service-Routines of USART0 (the ATmega328p calls them
+//USART_RX_vect and USART_UDRE_vect): a received byte, and a byte sent from
+//the transmit-buffer.
+#ifdef SIMPLEAVRLIB_HOST
+#ifdef USART0_RX_vect
+extern "C" void USART0_RX_vect( void );
+extern "C" void USART0_UDRE_vect( void );
+BENCHMARK(USART0_RX_vect)       { USART0_RX_vect(); }
+BENCHMARK(USART0_UDRE_vect)     { USART0_UDRE_vect(); }
+#else
+extern "C" void USART_RX_vect( void );
+extern "C" void USART_UDRE_vect( void );
+BENCHMARK(USART0_RX_vect)       { USART_RX_vect(); }
+BENCHMARK(USART0_UDRE_vect)     { USART_UDRE_vect(); }
+#endif
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// Debounce.h
+//////////////////////////////////////////////////////////////////////////
+
+static DebouncedPort _benchDebouncedPort;
+
+BENCHMARK(initDebouncedPort)
+{
+    initDebouncedPort( &_benchDebouncedPort, port_B, 0xFF, 0xFF );
+}
+BENCHMARK(debouncePort)     { _benchResult = debouncePort( &_benchDebouncedPort ); }
+BENCHMARK(getDebouncedPressed)
+{
+    _benchResult = getDebouncedPressed( &_benchDebouncedPort );
+}
+
+#ifdef SIMPLEAVRLIB_HOST
+
+//////////////////////////////////////////////////////////////////////////
+// Host: Count the register-accesses of each benchmark
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+
+typedef struct
+{
+    const char* name;
+    void (*function)( void );
+} _Benchmark;
+
+#define _BENCH(name) { #name, bench_ ## name }
+
+static const _Benchmark _benchmarks[] =
+{
+    _BENCH(setPinMode), _BENCH(setPinPullup), _BENCH(writePin),
+    _BENCH(writePin_portL), _BENCH(readPin), _BENCH(togglePin),
+    _BENCH(setPortMode), _BENCH(setPortPullup), _BENCH(writePort),
+    _BENCH(readPort), _BENCH(togglePort),
+    _BENCH(GPIOPin_GPIOPin), _BENCH(GPIOPin_setPinMode),
+    _BENCH(GPIOPin_setPinPullup), _BENCH(GPIOPin_writePin),
+    _BENCH(GPIOPin_readPin), _BENCH(GPIOPin_togglePin),
+    _BENCH(FastPin_setPinMode), _BENCH(FastPin_setPinPullup),
+    _BENCH(FastPin_writePin),
+#ifdef PORTL
+    _BENCH(FastPin_writePin_portL),
+#endif
+    _BENCH(FastPin_readPin), _BENCH(FastPin_togglePin),
+    _BENCH(GPIOPort_setPortMode), _BENCH(GPIOPort_setPortPullup),
+    _BENCH(GPIOPort_writePort), _BENCH(GPIOPort_readPort),
+    _BENCH(GPIOPort_togglePort),
+    _BENCH(writePin_6pins), _BENCH(GPIOTransaction_6pins),
+    _BENCH(setExtIntEventType), _BENCH(enableExtInt), _BENCH(disableExtInt),
+    _BENCH(clearPendingExtIntEvent), _BENCH(setExtIntHandler),
+    _BENCH(setExtIntQueueing), _BENCH(setExtIntTimestamping),
+    _BENCH(getExtIntTimestamp), _BENCH(setExtIntLockout),
+    _BENCH(tickExtIntLockouts), _BENCH(readExtIntEvent),
+    _BENCH(getExtIntEventDropCount),
+    _BENCH(ExtInt_ExtInt), _BENCH(ExtInt_setExtIntEventType),
+    _BENCH(ExtInt_enableExtInt), _BENCH(ExtInt_disableExtInt),
+    _BENCH(ExtInt_clearPendingExtIntEvent), _BENCH(ExtInt_setExtIntHandler),
+    _BENCH(ExtInt_setExtIntQueueing), _BENCH(ExtInt_setExtIntTimestamping),
+    _BENCH(ExtInt_getExtIntTimestamp), _BENCH(ExtInt_setExtIntLockout),
+    _BENCH(FastExtInt_setExtIntEventType), _BENCH(FastExtInt_enableExtInt),
+    _BENCH(FastExtInt_disableExtInt), _BENCH(FastExtInt_clearPendingExtIntEvent),
+    _BENCH(setPinChangeIntHandler), _BENCH(enablePinChangeInt),
+    _BENCH(disablePinChangeInt), _BENCH(PCINT0_vect),
+    _BENCH(getEventLoopSleepMode), _BENCH(runEventLoopOnce),
+    _BENCH(markEventLoopWake),
+    _BENCH(INT0_vect),
+    _BENCH(startAnalogScan), _BENCH(takeAnalogScanBlock),
+    _BENCH(releaseAnalogScanBlock), _BENCH(ADC_vect),
+    _BENCH(OversampleFilter_addSample), _BENCH(MovingAverageFilter_addSample),
+    _BENCH(MedianFilter_addSample), _BENCH(AnalogFilterBank_filterSample),
+    _BENCH(initSPIMaster), _BENCH(queueSPITransaction), _BENCH(SPI_STC_vect),
+    _BENCH(initTWIMaster), _BENCH(queueTWITransaction), _BENCH(TWI_vect),
+    _BENCH(QuadratureEncoder_start), _BENCH(QuadratureEncoder_getPosition),
+    _BENCH(QuadratureEncoder_update),
+    _BENCH(HardwarePWM8_init), _BENCH(HardwarePWM8_enableChannel),
+    _BENCH(HardwarePWM8_setDuty), _BENCH(HardwarePWM8_setDuties),
+    _BENCH(HardwarePWM16_init), _BENCH(HardwarePWM16_enableChannel),
+    _BENCH(HardwarePWM16_setDuty), _BENCH(HardwarePWM16_setDuties),
+    _BENCH(HardwarePWM8_writeDuties), _BENCH(HardwarePWM16_writeDuties),
+    _BENCH(addSoftPWMChannel), _BENCH(setSoftPWMDuty), _BENCH(commitSoftPWM),
+    _BENCH(TIMER2_COMPA_vect),
+    _BENCH(initUSART), _BENCH(writeUSARTByte), _BENCH(readUSARTByte),
+    _BENCH(USART0_RX_vect), _BENCH(USART0_UDRE_vect),
+    _BENCH(initDebouncedPort), _BENCH(debouncePort),
+    _BENCH(getDebouncedPressed),
+};
+
+//Prints one line "name,reads,writes" per benchmark (CSV with header)
+int main()
+{
+    //the Interrupt-Service-Routine takes its longest path
+    setExtIntHandler( 0, _benchHandler );
+    setExtIntQueueing( 0, true );
+    setExtIntTimestamping( 0, true );
+    setPinChangeIntHandler( 0, _benchPinChangeHandler );
+    enablePinChangeInt( 0 );
+
+    printf( "name,register_reads,register_writes\n" );
+    for (uint8_t i = 0; i < sizeof(_benchmarks)/sizeof(_benchmarks[0]); i++)
+    {
+        hostResetAccessCount();
+        _benchmarks[i].function();
+        HostAccessCount count = hostGetAccessCount();
+        printf( "%s,%u,%u\n", _benchmarks[i].name,
+                (unsigned)count.reads, (unsigned)count.writes );
+    }
+    return 0;
+}
+
+#else
+
+//On the microcontroller the benchmarks are only compiled and analyzed,
+//never executed.
+int main( void )
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,482 @@
+#!/usr/bin/env python3
+#
+#   run_benchmarks.py - Measures the cost of each function and method of
+#   GPIO.h and ExternalInterrupts.h (see doc/Benchmarks.md).
+#   This is part of the simpleAVRLib-Library.
+#   Copyright (c) 2018 Wolfgang Zukrigl
+#
+#   This program is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#   Usage:
+#       python3 benchmarks/run_benchmarks.py [-o results.json]
+#                                            [--compare old-results.json]
+#       python3 benchmarks/run_benchmarks.py --analyze listing.txt...
+#                                            [--mcu atmega328p]
+#
+#   For each microcontroller the benchmark-program (Benchmarks.cpp) is
+#   - compiled for the host and executed: counts of register-accesses
+#   - compiled with avr-gcc (if it is installed) and disassembled: number of
+#     instructions, worst-case number of cycles, stack-depth and flash-bytes.
+#     avr-size gives the size of the whole program (also the tables in
+#     PROGMEM, which belong to no function).
+#   With --analyze only the given listings of avr-objdump (for example of
+#   object-files) are analyzed, and the results of each function printed.
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+MCUS = {
+    # name: (macro for the host-build, bytes of a return-address)
+    "atmega2560": ("__AVR_ATmega2560__", 3),
+    "atmega328p": ("__AVR_ATmega328P__", 2),
+}
+
+LIBRARY_SOURCES = ["GPIO.cpp", "GPIOTransaction.cpp", "ExternalInterrupts.cpp",
+                   "PinChangeInterrupts.cpp", "Timebase.cpp", "EventLoop.cpp",
+                   "AnalogInput.cpp", "SPIMaster.cpp", "TWIMaster.cpp",
+                   "SoftPWM.cpp", "USART.cpp",
+                   "Debounce.cpp"]
+BENCHMARK_SOURCE = os.path.join("benchmarks", "Benchmarks.cpp")
+
+# The Interrupt-Service-Routines analyzed on the microcontroller, by the
+# name of the benchmark (as on the host) and the symbol of the vector on each
+# microcontroller.
+VECTORS = {
+    "INT0_vect": {"atmega2560": "__vector_1", "atmega328p": "__vector_1"},
+    "PCINT0_vect": {"atmega2560": "__vector_9", "atmega328p": "__vector_3"},
+    "ADC_vect": {"atmega2560": "__vector_29", "atmega328p": "__vector_21"},
+    "SPI_STC_vect": {"atmega2560": "__vector_24", "atmega328p": "__vector_17"},
+    "TWI_vect": {"atmega2560": "__vector_39", "atmega328p": "__vector_24"},
+    "TIMER2_COMPA_vect": {"atmega2560": "__vector_13",
+                          "atmega328p": "__vector_7"},
+    "USART0_RX_vect": {"atmega2560": "__vector_25", "atmega328p": "__vector_18"},
+    "USART0_UDRE_vect": {"atmega2560": "__vector_26",
+                         "atmega328p": "__vector_19"},
+}
+
+
+##########################################################################
+# Host: register-accesses
+##########################################################################
+
+def run_host(mcu, cxx, f_cpu, workdir):
+    macro = MCUS[mcu][0]
+    exe = os.path.join(workdir, "bench_host_" + mcu)
+    sources = [os.path.join(ROOT, s) for s in
+               [BENCHMARK_SOURCE] + LIBRARY_SOURCES +
+               [os.path.join("host", "HostRegisters.cpp")]]
+    subprocess.check_call([cxx, "-std=c++11", "-Os", "-D" + macro,
+                           "-DF_CPU=%dUL" % f_cpu,
+                           "-I" + os.path.join(ROOT, "host"), "-I" + ROOT]
+                          + sources + ["-o", exe])
+    output = subprocess.check_output([exe]).decode()
+
+    results = {}
+    for line in output.splitlines()[1:]:
+        name, reads, writes = line.split(",")
+        results[name] = {"register_reads": int(reads),
+                         "register_writes": int(writes)}
+    return results
+
+
+##########################################################################
+# Microcontroller: static analysis of the disassembly
+##########################################################################
+
+# Worst-case cycles of the instructions, that don't need 1 cycle
+# (ATmega-core, see "Instruction Set Summary" of the datasheets). The
+# values for call/ret depend on the size of the program-counter.
+def cycle_table(return_address_bytes):
+    big = return_address_bytes == 3
+    table = dict.fromkeys(
+        ["adiw", "sbiw", "mul", "muls", "mulsu", "fmul", "fmuls", "fmulsu",
+         "ld", "ldd", "st", "std", "lds", "sts", "push", "pop", "sbi", "cbi",
+         "rjmp", "ijmp", "eijmp"], 2)
+    table.update(dict.fromkeys(["jmp", "lpm", "elpm"], 3))
+    table.update({"call": 5 if big else 4, "rcall": 4 if big else 3,
+                  "icall": 4 if big else 3, "eicall": 4,
+                  "ret": 5 if big else 4, "reti": 5 if big else 4})
+    return table
+
+BRANCHES = {"breq", "brne", "brcs", "brcc", "brsh", "brlo", "brmi", "brpl",
+            "brge", "brlt", "brhs", "brhc", "brts", "brtc", "brvs", "brvc",
+            "brie", "brid", "brbs", "brbc"}
+SKIPS = {"cpse", "sbrc", "sbrs", "sbic", "sbis"}
+JUMPS = {"jmp", "rjmp"}
+CALLS = {"call", "rcall"}
+RETURNS = {"ret", "reti"}
+
+HEADER_RE = re.compile(r"^([0-9a-f]+) <(.+)>:$")
+INSN_RE = re.compile(r"^\s*([0-9a-f]+):\t((?:[0-9a-f]{2} )+)\s*\t(\S+)\s*(.*)$")
+TARGET_RE = re.compile(r";\s*0x([0-9a-f]+)")
+# Relocation of an object-file (avr-objdump -r): the target of a call or
+# jump is not known before linking, the listing shows it as 0.
+RELOC_RE = re.compile(r"^\s+([0-9a-f]+): (R_AVR_\w+)\t(.+?)\s*$")
+SECTION_RE = re.compile(r"^\.text(?:\+0x([0-9a-f]+))?$")
+
+
+class Insn:
+    def __init__(self, address, size, mnemonic, operands):
+        self.address = address
+        self.size = size
+        self.mnemonic = mnemonic
+        self.operands = operands
+        self.target = None
+        self.symbol = None      # target-symbol of a relocation
+        match = TARGET_RE.search(operands)
+        if match and (mnemonic in BRANCHES or mnemonic in JUMPS
+                      or mnemonic in CALLS):
+            self.target = int(match.group(1), 16)
+
+
+def parse_disassembly(text):
+    """Returns {function-name: [Insn, ...]} and {address: function-name}.
+    The text is the output of `avr-objdump -d` of a program, or of
+    `avr-objdump -d -r` of an object-file (relocations of calls and jumps
+    give their targets: a function of the listing, an address in .text, or
+    a symbol of another file, which becomes an unknown call)."""
+    functions = {}
+    addresses = {}
+    current = None
+    for line in text.splitlines():
+        header = HEADER_RE.match(line)
+        if header:
+            current = header.group(2)
+            functions[current] = []
+            addresses[int(header.group(1), 16)] = current
+            continue
+        insn = INSN_RE.match(line)
+        if insn and current is not None:
+            size = len(insn.group(2).split())
+            functions[current].append(Insn(int(insn.group(1), 16), size,
+                                           insn.group(3), insn.group(4)))
+            continue
+        reloc = RELOC_RE.match(line)
+        if reloc and current is not None and functions[current]:
+            last = functions[current][-1]
+            if last.mnemonic in JUMPS or last.mnemonic in CALLS:
+                last.symbol = reloc.group(3)
+
+    starts = {name: address for address, name in addresses.items()}
+    for insns in functions.values():
+        for insn in insns:
+            if insn.symbol is None:
+                continue
+            section = SECTION_RE.match(insn.symbol)
+            if section:
+                insn.target = int(section.group(1) or "0", 16)
+            else:
+                insn.target = starts.get(insn.symbol)
+    return functions, addresses
+
+
+def _is_frame_rcall(insn):
+    """Returns true for "rcall .+0", that allocates a stack-frame (of the size
+    of a return-address), and is not a relocated call of another function."""
+    return insn.mnemonic == "rcall" and insn.operands.startswith(".+0") \
+        and insn.symbol is None
+
+
+class Analyzer:
+    def __init__(self, functions, addresses, return_address_bytes):
+        self.functions = functions
+        self.addresses = addresses
+        self.return_address_bytes = return_address_bytes
+        self.cycles = cycle_table(return_address_bytes)
+        self._cache = {}
+
+    def analyze(self, name):
+        """Returns a dict with the cost of the function `name` including
+        everything it calls."""
+        if name in self._cache:
+            return self._cache[name]
+        self._cache[name] = None  # recursion is treated as unknown
+        insns = self.functions[name]
+        index = {insn.address: i for i, insn in enumerate(insns)}
+        notes = set()
+        callees = set()
+        stack_own = 0
+        stack_callees = 0
+
+        # Own stack-frame: pushed registers and the frame allocated by the
+        # prologue (sbiw/subi on the Y-pointer, or "rcall .+0").
+        for i, insn in enumerate(insns):
+            if insn.mnemonic == "push":
+                stack_own += 1
+            elif _is_frame_rcall(insn):
+                stack_own += self.return_address_bytes
+            elif insn.mnemonic in ("sbiw", "subi") and \
+                    insn.operands.startswith("r28,") and \
+                    any(x.mnemonic == "in" and x.operands.startswith("r28")
+                        for x in insns[max(0, i-3):i]):
+                stack_own += int(insn.operands.split(",")[1].split()[0], 0)
+
+        # Longest path (in cycles) from each instruction to the end of the
+        # function. Only forward-edges are allowed (no loops), so the
+        # instructions are processed from the last to the first.
+        longest = [0] * len(insns)
+        for i in range(len(insns) - 1, -1, -1):
+            insn = insns[i]
+            m = insn.mnemonic
+            cost = self.cycles.get(m, 1)
+            nxt = longest[i+1] if i + 1 < len(insns) else 0
+
+            def local(target):
+                if target is None or target not in index:
+                    return None
+                if target <= insn.address:
+                    notes.add("loop")
+                    return 0
+                return longest[index[target]]
+
+            if m in RETURNS:
+                longest[i] = cost
+            elif m in BRANCHES:
+                taken = local(insn.target)
+                longest[i] = max(1 + nxt, 2 + (taken or 0))
+            elif m in SKIPS:
+                skip = 1
+                if i + 1 < len(insns):
+                    skip += insns[i+1].size // 2
+                after = longest[i+2] if i + 2 < len(insns) else 0
+                longest[i] = max(1 + nxt, skip + after)
+            elif m in JUMPS:
+                taken = local(insn.target)
+                if taken is None:
+                    # tail-call of another function
+                    callee = self._call(insn.target, notes, callees)
+                    longest[i] = cost + (callee["cycles_max"] or 0) if callee else cost
+                    if callee:
+                        stack_callees = max(stack_callees, callee["stack_bytes"])
+                else:
+                    longest[i] = cost + taken
+            elif m in CALLS:
+                if _is_frame_rcall(insn):
+                    longest[i] = cost + nxt
+                    continue
+                callee = self._call(insn.target, notes, callees)
+                extra = 0
+                if callee:
+                    extra = callee["cycles_max"] or 0
+                    stack_callees = max(stack_callees,
+                                        self.return_address_bytes + callee["stack_bytes"])
+                longest[i] = cost + extra + nxt
+            elif m in ("icall", "eicall"):
+                notes.add("indirect_call")
+                longest[i] = cost + nxt
+            elif m in ("ijmp", "eijmp"):
+                notes.add("indirect_jump")
+                longest[i] = cost
+            else:
+                longest[i] = cost + nxt
+
+        own_flash = sum(insn.size for insn in insns)
+        flash = own_flash + sum(sum(x.size for x in self.functions[c])
+                                for c in callees if c != name)
+        count = len(insns) + sum(len(self.functions[c])
+                                 for c in callees if c != name)
+        result = {
+            "instructions": count,
+            "cycles_max": None if "loop" in notes or not insns else longest[0],
+            "stack_bytes": stack_own + stack_callees,
+            "flash_bytes": flash,
+            "notes": sorted(notes),
+        }
+        self._cache[name] = result
+        return result
+
+    def _call(self, target, notes, callees):
+        name = self.addresses.get(target)
+        if name is None:
+            notes.add("unknown_call")
+            return None
+        callee = self.analyze(name)
+        if callee is None:
+            notes.add("recursion")
+            return None
+        callees.add(name)
+        callees.update(self._callees(name))
+        notes.update(callee["notes"])
+        return callee
+
+    def _callees(self, name):
+        result = set()
+        for insn in self.functions[name]:
+            if insn.target in self.addresses and \
+                    self.addresses[insn.target] != name and \
+                    (insn.mnemonic in CALLS or insn.mnemonic in JUMPS):
+                callee = self.addresses[insn.target]
+                if callee not in result:
+                    result.add(callee)
+                    result.update(self._callees(callee))
+        return result
+
+
+def parse_size(text):
+    """Returns the sections of the program in bytes from the output of
+    avr-size (text includes the tables in PROGMEM)."""
+    lines = text.splitlines()
+    text, data, bss = [int(v) for v in lines[1].split()[:3]]
+    return {"text": text, "data": data, "bss": bss}
+
+
+def program_size(avr_size, elf):
+    """Returns the sections of the program in bytes (see parse_size)."""
+    return parse_size(subprocess.check_output([avr_size, elf]).decode())
+
+
+def run_avr(mcu, avr_gcc, avr_objdump, avr_size, f_cpu, workdir, names):
+    """Returns the results of the benchmarks, and the size of the program
+    (None, if avr-size isn't installed)."""
+    elf = os.path.join(workdir, "bench_" + mcu + ".elf")
+    sources = [os.path.join(ROOT, s) for s in [BENCHMARK_SOURCE] + LIBRARY_SOURCES]
+    subprocess.check_call([avr_gcc, "-mmcu=" + mcu, "-Os", "-std=gnu++11",
+                           "-DF_CPU=%dUL" % f_cpu, "-I" + ROOT]
+                          + sources + ["-o", elf])
+    text = subprocess.check_output([avr_objdump, "-d", elf]).decode()
+    functions, addresses = parse_disassembly(text)
+    analyzer = Analyzer(functions, addresses, MCUS[mcu][1])
+
+    results = {}
+    for name in names:
+        symbol = VECTORS[name][mcu] if name in VECTORS else "bench_" + name
+        if symbol in functions:
+            results[name] = analyzer.analyze(symbol)
+    size = program_size(avr_size, elf) if shutil.which(avr_size) else None
+    return results, size
+
+
+##########################################################################
+# Main
+##########################################################################
+
+def check_pwm_write_cycles(results):
+    """Warns, if the writes of HardwarePWM::setDuties take more cycles than
+    HARDWAREPWM_WRITE_CYCLES (HardwarePWM.h) allows for."""
+    with open(os.path.join(ROOT, "HardwarePWM.h")) as f:
+        match = re.search(r"#define\s+HARDWAREPWM_WRITE_CYCLES\s+(\d+)",
+                          f.read())
+    limit = int(match.group(1))
+    for mcu in sorted(results["mcus"]):
+        for name in ("HardwarePWM8_writeDuties", "HardwarePWM16_writeDuties"):
+            cycles = results["mcus"][mcu].get(name, {}).get("cycles_max")
+            if cycles is not None and cycles > limit:
+                print("warning: %s %s takes %d cycles, more than "
+                      "HARDWAREPWM_WRITE_CYCLES (%d)" % (mcu, name, cycles,
+                                                         limit),
+                      file=sys.stderr)
+
+
+def compare(old, new):
+    """Prints the values, that have changed between two result-files."""
+    for mcu in sorted(new["mcus"]):
+        for name in sorted(new["mcus"][mcu]):
+            before = old.get("mcus", {}).get(mcu, {}).get(name, {})
+            after = new["mcus"][mcu][name]
+            for key in sorted(after):
+                if key != "notes" and before.get(key) != after[key]:
+                    print("%s %s %s: %s -> %s" % (mcu, name, key,
+                                                  before.get(key), after[key]))
+    for mcu in sorted(new.get("program_bytes", {})):
+        before = old.get("program_bytes", {}).get(mcu) or {}
+        after = new["program_bytes"][mcu] or {}
+        for key in sorted(after):
+            if before.get(key) != after[key]:
+                print("%s program %s: %s -> %s" % (mcu, key, before.get(key),
+                                                   after[key]))
+
+
+def analyze_listings(paths, mcu):
+    """Prints the results of each function of the listings of avr-objdump."""
+    for path in paths:
+        with open(path) as f:
+            functions, addresses = parse_disassembly(f.read())
+        analyzer = Analyzer(functions, addresses, MCUS[mcu][1])
+        print("%s (%s):" % (path, mcu))
+        print("  %-32s %12s %10s %11s %11s  %s" % (
+            "function", "instructions", "cycles_max", "stack_bytes",
+            "flash_bytes", "notes"))
+        for address in sorted(addresses):
+            name = addresses[address]
+            result = analyzer.analyze(name)
+            if result is None:
+                continue
+            line = "  %-32s %12d %10s %11d %11d  %s" % (
+                name, result["instructions"], result["cycles_max"],
+                result["stack_bytes"], result["flash_bytes"],
+                " ".join(result["notes"]))
+            print(line.rstrip())
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Measures the cost of the API-calls of simpleAVRLib")
+    parser.add_argument("-o", "--output", default="benchmark-results.json")
+    parser.add_argument("--compare", help="earlier result-file")
+    parser.add_argument("--f-cpu", type=int, default=16000000)
+    parser.add_argument("--cxx", default="g++")
+    parser.add_argument("--avr-gcc", default="avr-gcc")
+    parser.add_argument("--avr-objdump", default="avr-objdump")
+    parser.add_argument("--avr-size", default="avr-size")
+    parser.add_argument("--analyze", nargs="+", metavar="LISTING",
+                        help="only analyze these outputs of avr-objdump -d")
+    parser.add_argument("--mcu", choices=sorted(MCUS), default="atmega2560",
+                        help="microcontroller of the listings of --analyze")
+    args = parser.parse_args()
+
+    if args.analyze:
+        analyze_listings(args.analyze, args.mcu)
+        return
+
+    have_avr = shutil.which(args.avr_gcc) and shutil.which(args.avr_objdump)
+    if not have_avr:
+        print("avr-gcc/avr-objdump not found: only register-accesses are "
+              "measured", file=sys.stderr)
+
+    results = {"f_cpu": args.f_cpu, "mcus": {}, "program_bytes": {}}
+    with tempfile.TemporaryDirectory() as workdir:
+        for mcu in sorted(MCUS):
+            host = run_host(mcu, args.cxx, args.f_cpu, workdir)
+            avr, size = {}, None
+            if have_avr:
+                avr, size = run_avr(mcu, args.avr_gcc, args.avr_objdump,
+                                    args.avr_size, args.f_cpu, workdir,
+                                    host.keys())
+            for name in host:
+                host[name].update(avr.get(name, {
+                    "instructions": None, "cycles_max": None,
+                    "stack_bytes": None, "flash_bytes": None, "notes": []}))
+            results["mcus"][mcu] = host
+            results["program_bytes"][mcu] = size
+    check_pwm_write_cycles(results)
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+        f.write("\n")
+
+    if args.compare:
+        with open(args.compare) as f:
+            compare(json.load(f), results)
+
+
+if __name__ == "__main__":
+    main()
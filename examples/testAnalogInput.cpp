@@ -0,0 +1,77 @@
+/*
+    testAnalogInput.cpp - Example for AnalogInput.h: A bar-graph of an
+    analog voltage, averaged over a block of samples.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+Four potentiometers are connected to ADC0 ... ADC3 (between GND and AVCC),
+eight LEDs on port B (low-level turns on an LED). The LEDs show the voltage
+of the potentiometer chosen by PD2 and PD3 (buttons to GND) as a bar-graph.
+
+The four channels are scanned by the Interrupt-Service-Routine of the ADC,
+16 scans per block. While the event-loop averages a block, the next one is
+filled. Between the blocks the microcontroller sleeps.
+*/
+
+#include <stdint.h>
+#include <avr/interrupt.h>
+
+#include "GPIO.h"
+#include "AnalogInput.h"
+#include "EventLoop.h"
+
+#define CHANNELS    4
+#define SCANS       16
+
+static const uint8_t channels[CHANNELS] = { 0, 1, 2, 3 };
+static uint16_t samples[ANALOG_SCAN_BUFFER_LENGTH( CHANNELS, SCANS )];
+
+static GPIOPort ledPort = GPIOPort(port_B);
+static GPIOPort selectPort = GPIOPort(port_D);
+
+static void handleBlock( void )
+{
+    const uint16_t* block = takeAnalogScanBlock();
+    if (!block) return;
+
+    uint8_t index = (~selectPort.readPort( 0x0C ) >> 2) & 0x03;
+    uint16_t sum = 0;
+    for (uint8_t s = 0; s < SCANS; s++)
+    {
+        sum += block[s * CHANNELS + index];
+    }
+    releaseAnalogScanBlock();
+
+    //0 ... 1023 to 0 ... 8 LEDs
+    uint8_t leds = (uint8_t)((sum / SCANS + 64) >> 7);
+    ledPort.writePort( ~(uint8_t)((1 << leds) - 1) );
+}
+
+int main(void)
+{
+    ledPort.setPortMode(0xFF);
+    ledPort.writePort(0xFF);
+    selectPort.setPortPullup(0xFF, 0x0C);
+
+    startAnalogScan( channels, CHANNELS, samples, SCANS,
+                     ANALOG_REFERENCE_AVCC, ANALOG_TRIGGER_FREE_RUNNING );
+    addEventSource( hasAnalogScanBlock, handleBlock );
+
+    sei();
+    runEventLoop();
+}
@@ -0,0 +1,98 @@
+/*
+    testEventLoop.cpp - Example for EventLoop.h: A button-counter, that
+    sleeps in Power-down-mode between the button-presses.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+/*
+A button is connected between PD2 (INT2 on the ATmega2560, INT0 on the
+ATmega328p) and GND, eight LEDs on port B (low-level turns on an LED).
+Each push of the button increases a counter, displayed on the LEDs.
+
+Instead of polling the button with _delay_ms, the main-loop is the
+event-loop: The external Interrupt puts an event into its queue, the
+event-loop calls `handleButton` for it, and in between the microcontroller
+sleeps. The external Interrupt is low-level-active, so it can wake up the
+microcontroller from Power-down (on the ATmega328p and for INT7:4 of the
+ATmega2560, edges only wake it up from Idle). As long as the button is
+held down, a low-level-active interrupt would happen again and again, so
+it is disabled in the handler, and enabled again after the button has been
+released.
+*/
+
+#include <stdint.h>
+#include <avr/interrupt.h>
+
+#include "GPIO.h"
+#include "ExternalInterrupts.h"
+#include "EventLoop.h"
+
+static GPIOPort ledPort = GPIOPort(port_B);
+static GPIOPin buttonPin = GPIOPin(port_D, 2);
+static ExtInt button = ExtInt( buttonPin, EXTINT_LOW_LEVEL_ACTIVE, PULLUP_ON,
+                               false );
+static uint8_t counter = 0;
+static volatile bool waitForRelease = false;
+
+static void handleButton( void )
+{
+    ExtIntEvent event;
+    while (readExtIntEvent( &event ))
+    {
+        counter++;
+        ledPort.writePort( ~counter );
+    }
+}
+
+//pending while the button is held down (after an event)
+static bool isButtonReleased( void )
+{
+    return waitForRelease && buttonPin.readPin() == HIGH_LEVEL;
+}
+
+static void enableButton( void )
+{
+    waitForRelease = false;
+    button.clearPendingExtIntEvent();
+    button.enableExtInt();
+}
+
+//called from the Interrupt-Service-Routine
+static void onButton( void )
+{
+    button.disableExtInt();
+    waitForRelease = true;
+}
+
+int main(void)
+{
+    ledPort.setPortMode(0xFF);
+    ledPort.writePort(0xFF);
+
+    button.setExtIntQueueing( true );
+    button.setExtIntHandler( onButton );
+    button.enableExtInt();
+
+    addEventSource( hasExtIntEvent, handleButton );
+    //While waiting for the release the external Interrupt is disabled, so
+    //nothing would wake up the microcontroller: the event-loop doesn't
+    //sleep then (no wake-source), and checks the pin in each round.
+    addEventSource( isButtonReleased, enableButton );
+
+    sei();
+    runEventLoop();
+}
@@ -32,6 +32,8 @@ But the interrupt is only enabled, while the button at pin PD3 is not
 pressed.
 Since buttons are bouncing, pushing the button at pin PD2 may
 increase `counter` more than once.
+(See `setExtIntLockout` in ExternalInterrupts.h for a way to get a single
+Interrupt-event per push).
 */
 
 #include <avr/interrupt.h>
@@ -59,11 +61,7 @@ ISR(INT2_vect)
 int main()
 {
     
-    //make Pins PD3 and PD2 inputs with activated internal pullup-resistors
-	//Pins uses as external Interrupts, still must be programmed to be
-	//inputs first!
-    GPIOPin pd2 = GPIOPin(port_D, 2, MODE_INPUT);
-    pd2.setPinPullup(PULLUP_ON);
+    //make Pin PD3 an input with activated internal pullup-resistor
     GPIOPin pd3 = GPIOPin(port_D, 3, MODE_INPUT);
     pd3.setPinPullup(PULLUP_ON);
     
@@ -74,7 +72,9 @@ int main()
 
     //Falling edges occur on pushing the button (rising edges occur on 
     //releasing it).
-    ExtInt int2 = ExtInt( 2, EXTINT_FALLING_EDGE);
+    //The external Interrupt is found from the pin (INT2 for PD2), and the
+    //pin is made an input with activated pullup-resistor.
+    ExtInt int2 = ExtInt( GPIOPin(port_D, 2), EXTINT_FALLING_EDGE, PULLUP_ON );
     
     //globally enable interrupts
     sei();
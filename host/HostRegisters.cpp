@@ -0,0 +1,373 @@
+/*
+    HostRegisters.cpp - In-memory Special-Function-Registers, that replace the
+    registers of <avr/io.h>, when the simpleAVRLib-Library is compiled and
+    tested on a PC (the "host") instead of an AVR-Microcontroller.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <avr/io.h>
+#include "HostRegisters.h"
+
+//All registers in a single linked list (built by the constructors)
+static HostRegister8* _firstRegister = 0;
+static HostRegister16* _firstRegister16 = 0;
+
+static HostAccessCount _totalAccessCount = { 0, 0 };
+
+
+//////////////////////////////////////////////////////////////////////////
+// HostRegister8
+//////////////////////////////////////////////////////////////////////////
+
+HostRegister8::HostRegister8( const char* name, uint16_t address,
+                              uint8_t kind, HostRegister8* target )
+    : value(0), reads(0), writes(0), onRead(0), name(name), address(address),
+      next(_firstRegister), _kind(kind), _target(target)
+{
+    _firstRegister = this;
+}
+
+void HostRegister8::_countRead() const
+{
+    reads++;
+    _totalAccessCount.reads++;
+    if (onRead) onRead( const_cast<HostRegister8*>(this) );
+}
+
+void HostRegister8::_write( uint8_t newValue )
+{
+    writes++;
+    _totalAccessCount.writes++;
+
+    switch (_kind)
+    {
+        case HOST_REG_PIN:
+            //write 1 to toggle the corresponding PORTx-Bit (not counted as
+            //access to PORTx, the CPU doesn't access it)
+            if (_target) _target->value ^= newValue;
+            return;
+
+        case HOST_REG_W1C:
+            value &= ~newValue;
+            return;
+
+        default:
+            value = newValue;
+            return;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// HostRegister16
+//////////////////////////////////////////////////////////////////////////
+
+HostRegister16::HostRegister16( const char* name, uint16_t address )
+    : value(0), reads(0), writes(0), name(name), address(address),
+      next(_firstRegister16)
+{
+    _firstRegister16 = this;
+}
+
+void HostRegister16::_countRead() const
+{
+    reads += 2;
+    _totalAccessCount.reads += 2;
+}
+
+void HostRegister16::_write( uint16_t newValue )
+{
+    writes += 2;
+    _totalAccessCount.writes += 2;
+    value = newValue;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Functions for test-programs
+//////////////////////////////////////////////////////////////////////////
+
+void hostResetRegisters()
+{
+    for (HostRegister8* reg = _firstRegister; reg; reg = reg->next)
+    {
+        reg->value = 0;
+    }
+    for (HostRegister16* reg = _firstRegister16; reg; reg = reg->next)
+    {
+        reg->value = 0;
+    }
+    hostSleepCount = 0;
+    hostResetAccessCount();
+}
+
+void (*hostSleepHandler)( void ) = 0;
+uint32_t hostSleepCount = 0;
+
+void hostSleep()
+{
+    hostSleepCount++;
+    if (hostSleepHandler) hostSleepHandler();
+}
+
+HostAccessCount hostGetAccessCount()
+{
+    return _totalAccessCount;
+}
+
+void hostResetAccessCount()
+{
+    for (HostRegister8* reg = _firstRegister; reg; reg = reg->next)
+    {
+        reg->reads = 0;
+        reg->writes = 0;
+    }
+    for (HostRegister16* reg = _firstRegister16; reg; reg = reg->next)
+    {
+        reg->reads = 0;
+        reg->writes = 0;
+    }
+    _totalAccessCount.reads = 0;
+    _totalAccessCount.writes = 0;
+}
+
+HostRegister8* hostFindRegister( const char* name )
+{
+    for (HostRegister8* reg = _firstRegister; reg; reg = reg->next)
+    {
+        if (strcmp(reg->name, name) == 0) return reg;
+    }
+    return 0;
+}
+
+HostRegister16* hostFindRegister16( const char* name )
+{
+    for (HostRegister16* reg = _firstRegister16; reg; reg = reg->next)
+    {
+        if (strcmp(reg->name, name) == 0) return reg;
+    }
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// The register-file of the microcontroller
+//////////////////////////////////////////////////////////////////////////
+
+#if defined(__AVR_ATmega2560__)
+
+HostRegister8 hostPINA( "PINA", 0x20, HOST_REG_PIN, &hostPORTA );
+HostRegister8 hostDDRA( "DDRA", 0x21 );
+HostRegister8 hostPORTA( "PORTA", 0x22 );
+HostRegister8 hostPINB( "PINB", 0x23, HOST_REG_PIN, &hostPORTB );
+HostRegister8 hostDDRB( "DDRB", 0x24 );
+HostRegister8 hostPORTB( "PORTB", 0x25 );
+HostRegister8 hostPINC( "PINC", 0x26, HOST_REG_PIN, &hostPORTC );
+HostRegister8 hostDDRC( "DDRC", 0x27 );
+HostRegister8 hostPORTC( "PORTC", 0x28 );
+HostRegister8 hostPIND( "PIND", 0x29, HOST_REG_PIN, &hostPORTD );
+HostRegister8 hostDDRD( "DDRD", 0x2A );
+HostRegister8 hostPORTD( "PORTD", 0x2B );
+HostRegister8 hostPINE( "PINE", 0x2C, HOST_REG_PIN, &hostPORTE );
+HostRegister8 hostDDRE( "DDRE", 0x2D );
+HostRegister8 hostPORTE( "PORTE", 0x2E );
+HostRegister8 hostPINF( "PINF", 0x2F, HOST_REG_PIN, &hostPORTF );
+HostRegister8 hostDDRF( "DDRF", 0x30 );
+HostRegister8 hostPORTF( "PORTF", 0x31 );
+HostRegister8 hostPING( "PING", 0x32, HOST_REG_PIN, &hostPORTG );
+HostRegister8 hostDDRG( "DDRG", 0x33 );
+HostRegister8 hostPORTG( "PORTG", 0x34 );
+HostRegister8 hostPINH( "PINH", 0x100, HOST_REG_PIN, &hostPORTH );
+HostRegister8 hostDDRH( "DDRH", 0x101 );
+HostRegister8 hostPORTH( "PORTH", 0x102 );
+HostRegister8 hostPINJ( "PINJ", 0x103, HOST_REG_PIN, &hostPORTJ );
+HostRegister8 hostDDRJ( "DDRJ", 0x104 );
+HostRegister8 hostPORTJ( "PORTJ", 0x105 );
+HostRegister8 hostPINK( "PINK", 0x106, HOST_REG_PIN, &hostPORTK );
+HostRegister8 hostDDRK( "DDRK", 0x107 );
+HostRegister8 hostPORTK( "PORTK", 0x108 );
+HostRegister8 hostPINL( "PINL", 0x109, HOST_REG_PIN, &hostPORTL );
+HostRegister8 hostDDRL( "DDRL", 0x10A );
+HostRegister8 hostPORTL( "PORTL", 0x10B );
+HostRegister8 hostSREG( "SREG", 0x5F );
+HostRegister8 hostEICRB( "EICRB", 0x6A );
+HostRegister8 hostEICRA( "EICRA", 0x69 );
+HostRegister8 hostEIMSK( "EIMSK", 0x3D );
+HostRegister8 hostEIFR( "EIFR", 0x3C, HOST_REG_W1C );
+HostRegister8 hostPCICR( "PCICR", 0x68 );
+HostRegister8 hostPCIFR( "PCIFR", 0x3B, HOST_REG_W1C );
+HostRegister8 hostPCMSK0( "PCMSK0", 0x6B );
+HostRegister8 hostPCMSK1( "PCMSK1", 0x6C );
+HostRegister8 hostPCMSK2( "PCMSK2", 0x6D );
+HostRegister8 hostTCCR1A( "TCCR1A", 0x80 );
+HostRegister8 hostTCCR1B( "TCCR1B", 0x81 );
+HostRegister8 hostTCCR1C( "TCCR1C", 0x82 );
+HostRegister16 hostTCNT1( "TCNT1", 0x84 );
+HostRegister16 hostICR1( "ICR1", 0x86 );
+HostRegister16 hostOCR1A( "OCR1A", 0x88 );
+HostRegister16 hostOCR1B( "OCR1B", 0x8A );
+HostRegister8 hostTIMSK1( "TIMSK1", 0x6F );
+HostRegister8 hostTIFR1( "TIFR1", 0x36, HOST_REG_W1C );
+HostRegister16 hostOCR1C( "OCR1C", 0x8C );
+HostRegister8 hostTCCR3A( "TCCR3A", 0x90 );
+HostRegister8 hostTCCR3B( "TCCR3B", 0x91 );
+HostRegister8 hostTCCR3C( "TCCR3C", 0x92 );
+HostRegister16 hostTCNT3( "TCNT3", 0x94 );
+HostRegister16 hostICR3( "ICR3", 0x96 );
+HostRegister16 hostOCR3A( "OCR3A", 0x98 );
+HostRegister16 hostOCR3B( "OCR3B", 0x9A );
+HostRegister16 hostOCR3C( "OCR3C", 0x9C );
+HostRegister8 hostTIMSK3( "TIMSK3", 0x71 );
+HostRegister8 hostTIFR3( "TIFR3", 0x38, HOST_REG_W1C );
+HostRegister8 hostUCSR0A( "UCSR0A", 0xC0 );
+HostRegister8 hostUCSR0B( "UCSR0B", 0xC1 );
+HostRegister8 hostUCSR0C( "UCSR0C", 0xC2 );
+HostRegister16 hostUBRR0( "UBRR0", 0xC4 );
+HostRegister8 hostUDR0( "UDR0", 0xC6 );
+HostRegister8 hostUCSR1A( "UCSR1A", 0xC8 );
+HostRegister8 hostUCSR1B( "UCSR1B", 0xC9 );
+HostRegister8 hostUCSR1C( "UCSR1C", 0xCA );
+HostRegister16 hostUBRR1( "UBRR1", 0xCC );
+HostRegister8 hostUDR1( "UDR1", 0xCE );
+HostRegister8 hostUCSR2A( "UCSR2A", 0xD0 );
+HostRegister8 hostUCSR2B( "UCSR2B", 0xD1 );
+HostRegister8 hostUCSR2C( "UCSR2C", 0xD2 );
+HostRegister16 hostUBRR2( "UBRR2", 0xD4 );
+HostRegister8 hostUDR2( "UDR2", 0xD6 );
+HostRegister8 hostUCSR3A( "UCSR3A", 0x130 );
+HostRegister8 hostUCSR3B( "UCSR3B", 0x131 );
+HostRegister8 hostUCSR3C( "UCSR3C", 0x132 );
+HostRegister16 hostUBRR3( "UBRR3", 0x134 );
+HostRegister8 hostUDR3( "UDR3", 0x136 );
+HostRegister8 hostTCCR2A( "TCCR2A", 0xB0 );
+HostRegister8 hostTCCR2B( "TCCR2B", 0xB1 );
+HostRegister8 hostTCNT2( "TCNT2", 0xB2 );
+HostRegister8 hostOCR2A( "OCR2A", 0xB3 );
+HostRegister8 hostOCR2B( "OCR2B", 0xB4 );
+HostRegister8 hostTIMSK2( "TIMSK2", 0x70 );
+HostRegister8 hostTIFR2( "TIFR2", 0x37, HOST_REG_W1C );
+HostRegister8 hostTCCR0A( "TCCR0A", 0x44 );
+HostRegister8 hostTCCR0B( "TCCR0B", 0x45 );
+HostRegister8 hostTCNT0( "TCNT0", 0x46 );
+HostRegister8 hostOCR0A( "OCR0A", 0x47 );
+HostRegister8 hostOCR0B( "OCR0B", 0x48 );
+HostRegister8 hostTCCR4A( "TCCR4A", 0xA0 );
+HostRegister8 hostTCCR4B( "TCCR4B", 0xA1 );
+HostRegister8 hostTCCR4C( "TCCR4C", 0xA2 );
+HostRegister16 hostTCNT4( "TCNT4", 0xA4 );
+HostRegister16 hostICR4( "ICR4", 0xA6 );
+HostRegister16 hostOCR4A( "OCR4A", 0xA8 );
+HostRegister16 hostOCR4B( "OCR4B", 0xAA );
+HostRegister16 hostOCR4C( "OCR4C", 0xAC );
+HostRegister8 hostTCCR5A( "TCCR5A", 0x120 );
+HostRegister8 hostTCCR5B( "TCCR5B", 0x121 );
+HostRegister8 hostTCCR5C( "TCCR5C", 0x122 );
+HostRegister16 hostTCNT5( "TCNT5", 0x124 );
+HostRegister16 hostICR5( "ICR5", 0x126 );
+HostRegister16 hostOCR5A( "OCR5A", 0x128 );
+HostRegister16 hostOCR5B( "OCR5B", 0x12A );
+HostRegister16 hostOCR5C( "OCR5C", 0x12C );
+HostRegister8 hostSMCR( "SMCR", 0x53 );
+HostRegister8 hostWDTCSR( "WDTCSR", 0x60 );
+HostRegister8 hostTIMSK0( "TIMSK0", 0x6E );
+HostRegister8 hostADCSRA( "ADCSRA", 0x7A );
+HostRegister8 hostASSR( "ASSR", 0xB6 );
+HostRegister8 hostTIMSK4( "TIMSK4", 0x72 );
+HostRegister8 hostTIMSK5( "TIMSK5", 0x73 );
+HostRegister8 hostTIFR0( "TIFR0", 0x35, HOST_REG_W1C );
+HostRegister16 hostADC( "ADC", 0x78 );
+HostRegister8 hostADCSRB( "ADCSRB", 0x7B );
+HostRegister8 hostADMUX( "ADMUX", 0x7C );
+HostRegister8 hostDIDR0( "DIDR0", 0x7E );
+HostRegister8 hostDIDR2( "DIDR2", 0x7D );
+HostRegister8 hostSPCR( "SPCR", 0x4C );
+HostRegister8 hostSPSR( "SPSR", 0x4D );
+HostRegister8 hostSPDR( "SPDR", 0x4E );
+HostRegister8 hostTWBR( "TWBR", 0xB8 );
+HostRegister8 hostTWSR( "TWSR", 0xB9 );
+HostRegister8 hostTWAR( "TWAR", 0xBA );
+HostRegister8 hostTWDR( "TWDR", 0xBB );
+HostRegister8 hostTWCR( "TWCR", 0xBC );
+
+#elif defined(__AVR_ATmega328P__)
+
+HostRegister8 hostPINB( "PINB", 0x23, HOST_REG_PIN, &hostPORTB );
+HostRegister8 hostDDRB( "DDRB", 0x24 );
+HostRegister8 hostPORTB( "PORTB", 0x25 );
+HostRegister8 hostPINC( "PINC", 0x26, HOST_REG_PIN, &hostPORTC );
+HostRegister8 hostDDRC( "DDRC", 0x27 );
+HostRegister8 hostPORTC( "PORTC", 0x28 );
+HostRegister8 hostPIND( "PIND", 0x29, HOST_REG_PIN, &hostPORTD );
+HostRegister8 hostDDRD( "DDRD", 0x2A );
+HostRegister8 hostPORTD( "PORTD", 0x2B );
+HostRegister8 hostSREG( "SREG", 0x5F );
+HostRegister8 hostEICRA( "EICRA", 0x69 );
+HostRegister8 hostEIMSK( "EIMSK", 0x3D );
+HostRegister8 hostEIFR( "EIFR", 0x3C, HOST_REG_W1C );
+HostRegister8 hostPCICR( "PCICR", 0x68 );
+HostRegister8 hostPCIFR( "PCIFR", 0x3B, HOST_REG_W1C );
+HostRegister8 hostPCMSK0( "PCMSK0", 0x6B );
+HostRegister8 hostPCMSK1( "PCMSK1", 0x6C );
+HostRegister8 hostPCMSK2( "PCMSK2", 0x6D );
+HostRegister8 hostTCCR1A( "TCCR1A", 0x80 );
+HostRegister8 hostTCCR1B( "TCCR1B", 0x81 );
+HostRegister8 hostTCCR1C( "TCCR1C", 0x82 );
+HostRegister16 hostTCNT1( "TCNT1", 0x84 );
+HostRegister16 hostICR1( "ICR1", 0x86 );
+HostRegister16 hostOCR1A( "OCR1A", 0x88 );
+HostRegister16 hostOCR1B( "OCR1B", 0x8A );
+HostRegister8 hostTIMSK1( "TIMSK1", 0x6F );
+HostRegister8 hostTIFR1( "TIFR1", 0x36, HOST_REG_W1C );
+HostRegister8 hostUCSR0A( "UCSR0A", 0xC0 );
+HostRegister8 hostUCSR0B( "UCSR0B", 0xC1 );
+HostRegister8 hostUCSR0C( "UCSR0C", 0xC2 );
+HostRegister16 hostUBRR0( "UBRR0", 0xC4 );
+HostRegister8 hostUDR0( "UDR0", 0xC6 );
+HostRegister8 hostTCCR2A( "TCCR2A", 0xB0 );
+HostRegister8 hostTCCR2B( "TCCR2B", 0xB1 );
+HostRegister8 hostTCNT2( "TCNT2", 0xB2 );
+HostRegister8 hostOCR2A( "OCR2A", 0xB3 );
+HostRegister8 hostOCR2B( "OCR2B", 0xB4 );
+HostRegister8 hostTIMSK2( "TIMSK2", 0x70 );
+HostRegister8 hostTIFR2( "TIFR2", 0x37, HOST_REG_W1C );
+HostRegister8 hostTCCR0A( "TCCR0A", 0x44 );
+HostRegister8 hostTCCR0B( "TCCR0B", 0x45 );
+HostRegister8 hostTCNT0( "TCNT0", 0x46 );
+HostRegister8 hostOCR0A( "OCR0A", 0x47 );
+HostRegister8 hostOCR0B( "OCR0B", 0x48 );
+HostRegister8 hostSMCR( "SMCR", 0x53 );
+HostRegister8 hostWDTCSR( "WDTCSR", 0x60 );
+HostRegister8 hostTIMSK0( "TIMSK0", 0x6E );
+HostRegister8 hostADCSRA( "ADCSRA", 0x7A );
+HostRegister8 hostASSR( "ASSR", 0xB6 );
+HostRegister8 hostTIFR0( "TIFR0", 0x35, HOST_REG_W1C );
+HostRegister16 hostADC( "ADC", 0x78 );
+HostRegister8 hostADCSRB( "ADCSRB", 0x7B );
+HostRegister8 hostADMUX( "ADMUX", 0x7C );
+HostRegister8 hostDIDR0( "DIDR0", 0x7E );
+HostRegister8 hostSPCR( "SPCR", 0x4C );
+HostRegister8 hostSPSR( "SPSR", 0x4D );
+HostRegister8 hostSPDR( "SPDR", 0x4E );
+HostRegister8 hostTWBR( "TWBR", 0xB8 );
+HostRegister8 hostTWSR( "TWSR", 0xB9 );
+HostRegister8 hostTWAR( "TWAR", 0xBA );
+HostRegister8 hostTWDR( "TWDR", 0xBB );
+HostRegister8 hostTWCR( "TWCR", 0xBC );
+
+#endif
@@ -0,0 +1,248 @@
+/*
+    HostRegisters.h - In-memory Special-Function-Registers, that replace the
+    registers of <avr/io.h>, when the simpleAVRLib-Library is compiled and
+    tested on a PC (the "host") instead of an AVR-Microcontroller.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOSTREGISTERS_H_
+#define HOSTREGISTERS_H_
+
+#include <stdint.h>
+
+#ifndef __cplusplus
+#error "The host-backend of simpleAVRLib needs a C++-Compiler"
+#endif
+
+/**
+ * Argument for parameter `kind` of the constructor of `HostRegister8`. It
+ * defines, what happens, when the register is written.
+ *  - HOST_REG_PLAIN: The written value is stored.
+ *  - HOST_REG_PIN: A PINx-Register. Writing a 1-Bit toggles the
+ *    corresponding Bit of the PORTx-Register given as `target`. The value
+ *    of the PINx-Register itself (the voltage-levels fed into the pins) is
+ *    only changed by the test-program (by assigning to member `value`).
+ *  - HOST_REG_W1C: An Interrupt-Flag-Register (like EIFR). Writing a 1-Bit
+ *    clears the corresponding Bit ("write 1 to clear").
+ */
+#define HOST_REG_PLAIN      0
+#define HOST_REG_PIN        1
+#define HOST_REG_W1C        2
+
+/**
+ * Counts of accesses to Special-Function-Registers.
+ */
+struct HostAccessCount
+{
+    uint32_t reads;
+    uint32_t writes;
+};
+
+/**
+ * An 8-Bit-Special-Function-Register in memory. It behaves like the
+ * `volatile uint8_t`, that <avr/io.h> uses for a register, but counts each
+ * read- and write-access (per register and in total). A compound-assignment
+ * like `PORTB |= 0x01` counts as one read and one write, as it does on the
+ * microcontroller (`in`/`out` or `lds`/`sts`).
+ */
+class HostRegister8
+{
+public:
+    HostRegister8( const char* name, uint16_t address,
+                   uint8_t kind = HOST_REG_PLAIN, HostRegister8* target = 0 );
+
+    operator uint8_t() const
+    {
+        _countRead();
+        return value;
+    }
+
+    HostRegister8& operator=( uint8_t newValue )
+    {
+        _write( newValue );
+        return *this;
+    }
+
+    HostRegister8& operator=( const HostRegister8& other )
+    {
+        _write( (uint8_t)other );
+        return *this;
+    }
+
+    HostRegister8& operator|=( uint8_t bits )
+    {
+        _write( (uint8_t)*this | bits );
+        return *this;
+    }
+
+    HostRegister8& operator&=( uint8_t bits )
+    {
+        _write( (uint8_t)*this & bits );
+        return *this;
+    }
+
+    HostRegister8& operator^=( uint8_t bits )
+    {
+        _write( (uint8_t)*this ^ bits );
+        return *this;
+    }
+
+    /** Content of the register. Changing it directly is not counted. */
+    uint8_t value;
+
+    /** Number of read-accesses to this register */
+    mutable uint32_t reads;
+
+    /** Number of write-accesses to this register */
+    uint32_t writes;
+
+    /**
+     * Function called by each read-access before the value is returned, or
+     * 0. A test-program can use it to simulate hardware, that changes the
+     * register by itself (for example a running Timer/Counter, whose
+     * TCNTn-Register counts up each time it is read).
+     */
+    void (*onRead)( HostRegister8* reg );
+
+    /** Name of the register as in <avr/io.h>, for example "PORTB" */
+    const char* const name;
+
+    /** Data-memory-address of the register on the microcontroller */
+    const uint16_t address;
+
+    /** Next register in the list of all registers (see hostFindRegister) */
+    HostRegister8* const next;
+
+private:
+    void _countRead() const;
+    void _write( uint8_t newValue );
+
+    const uint8_t _kind;
+    HostRegister8* const _target;
+};
+
+/**
+ * A 16-Bit-Special-Function-Register in memory (like TCNT1 or OCR1A). The
+ * AVR accesses it as two bytes, so each read counts as two reads and each
+ * write as two writes.
+ */
+class HostRegister16
+{
+public:
+    HostRegister16( const char* name, uint16_t address );
+
+    operator uint16_t() const
+    {
+        _countRead();
+        return value;
+    }
+
+    HostRegister16& operator=( uint16_t newValue )
+    {
+        _write( newValue );
+        return *this;
+    }
+
+    HostRegister16& operator=( const HostRegister16& other )
+    {
+        _write( (uint16_t)other );
+        return *this;
+    }
+
+    HostRegister16& operator|=( uint16_t bits )
+    {
+        _write( (uint16_t)*this | bits );
+        return *this;
+    }
+
+    HostRegister16& operator&=( uint16_t bits )
+    {
+        _write( (uint16_t)*this & bits );
+        return *this;
+    }
+
+    /** Content of the register. Changing it directly is not counted. */
+    uint16_t value;
+
+    /** Number of read-accesses (bytes) to this register */
+    mutable uint32_t reads;
+
+    /** Number of write-accesses (bytes) to this register */
+    uint32_t writes;
+
+    /** Name of the register as in <avr/io.h>, for example "TCNT1" */
+    const char* const name;
+
+    /** Data-memory-address of the low-byte of the register */
+    const uint16_t address;
+
+    /** Next register in the list of all 16-Bit-registers */
+    HostRegister16* const next;
+
+private:
+    void _countRead() const;
+    void _write( uint16_t newValue );
+};
+
+
+/**
+ * Sets the value of all registers to 0 and clears all access-counters.
+ */
+void hostResetRegisters();
+
+/**
+ * Returns the total number of register-accesses since the last call of
+ * `hostResetAccessCount` or `hostResetRegisters`.
+ */
+HostAccessCount hostGetAccessCount();
+
+/**
+ * Clears the total and the per-register access-counters. Call it before an
+ * API-call, and `hostGetAccessCount` after it, to get the cost of the call.
+ */
+void hostResetAccessCount();
+
+/**
+ * Returns the register with the given name (for example "DDRB") or 0, if no
+ * such register exists on the microcontroller chosen for the host-build.
+ */
+HostRegister8* hostFindRegister( const char* name );
+
+/**
+ * Returns the 16-Bit-register with the given name (for example "TCNT1") or 0.
+ */
+HostRegister16* hostFindRegister16( const char* name );
+
+/**
+ * Called by `sleep_cpu()` of host/avr/sleep.h instead of the
+ * sleep-instruction. The test-program can set it to a function, that
+ * simulates the interrupt waking up the microcontroller (for example by
+ * calling `INT0_vect()`). 0 (default): `sleep_cpu()` returns immediately.
+ */
+extern void (*hostSleepHandler)( void );
+
+/**
+ * Number of calls of `sleep_cpu()` since the last `hostResetRegisters`.
+ */
+extern uint32_t hostSleepCount;
+
+/**
+ * Replacement for the sleep-instruction (see `hostSleepHandler`).
+ */
+void hostSleep();
+
+#endif /* HOSTREGISTERS_H_ */
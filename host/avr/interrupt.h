@@ -0,0 +1,42 @@
+/*
+    avr/interrupt.h (host-version) - Replaces <avr/interrupt.h> of avr-libc,
+    when the simpleAVRLib-Library is compiled for the host (see doc/Host.md).
+    An Interrupt-Service-Routine becomes an ordinary function, that the
+    test-program can call to simulate an Interrupt-event.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+//The test-program calls an Interrupt-Service-Routine like a function, for
+//example `INT2_vect();` (after declaring it with `extern "C" void INT2_vect();`)
+#define ISR(vector, ...)    extern "C" void vector (void) __VA_ARGS__; \
+                            extern "C" void vector (void)
+
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+
+//sei and cli are instructions, not register-accesses. So they change the
+//I-Bit in SREG without counting an access.
+#define sei()   (hostSREG.value |= 0x80)
+#define cli()   (hostSREG.value &= (uint8_t)~0x80)
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
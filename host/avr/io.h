@@ -0,0 +1,545 @@
+/*
+    avr/io.h (host-version) - Replaces <avr/io.h> of avr-libc, when the
+    simpleAVRLib-Library is compiled for the host (see doc/Host.md). The
+    Special-Function-Registers are `HostRegister8`-objects in memory.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+#include "../HostRegisters.h"
+
+#define SIMPLEAVRLIB_HOST
+
+//Without -mmcu the host-compiler doesn't know the microcontroller. Pass
+//-D__AVR_ATmega2560__ or -D__AVR_ATmega328P__ (default: ATmega2560)
+#if !defined(__AVR_ATmega2560__) && !defined(__AVR_ATmega328P__)
+#define __AVR_ATmega2560__
+#endif
+
+#define _VECTOR(N) __vector_ ## N
+
+#if defined(__AVR_ATmega2560__)
+
+extern HostRegister8 hostPINA;
+extern HostRegister8 hostDDRA;
+extern HostRegister8 hostPORTA;
+extern HostRegister8 hostPINB;
+extern HostRegister8 hostDDRB;
+extern HostRegister8 hostPORTB;
+extern HostRegister8 hostPINC;
+extern HostRegister8 hostDDRC;
+extern HostRegister8 hostPORTC;
+extern HostRegister8 hostPIND;
+extern HostRegister8 hostDDRD;
+extern HostRegister8 hostPORTD;
+extern HostRegister8 hostPINE;
+extern HostRegister8 hostDDRE;
+extern HostRegister8 hostPORTE;
+extern HostRegister8 hostPINF;
+extern HostRegister8 hostDDRF;
+extern HostRegister8 hostPORTF;
+extern HostRegister8 hostPING;
+extern HostRegister8 hostDDRG;
+extern HostRegister8 hostPORTG;
+extern HostRegister8 hostPINH;
+extern HostRegister8 hostDDRH;
+extern HostRegister8 hostPORTH;
+extern HostRegister8 hostPINJ;
+extern HostRegister8 hostDDRJ;
+extern HostRegister8 hostPORTJ;
+extern HostRegister8 hostPINK;
+extern HostRegister8 hostDDRK;
+extern HostRegister8 hostPORTK;
+extern HostRegister8 hostPINL;
+extern HostRegister8 hostDDRL;
+extern HostRegister8 hostPORTL;
+extern HostRegister8 hostSREG;
+extern HostRegister8 hostEICRB;
+extern HostRegister8 hostEICRA;
+extern HostRegister8 hostEIMSK;
+extern HostRegister8 hostEIFR;
+extern HostRegister8 hostPCICR;
+extern HostRegister8 hostPCIFR;
+extern HostRegister8 hostPCMSK0;
+extern HostRegister8 hostPCMSK1;
+extern HostRegister8 hostPCMSK2;
+extern HostRegister8 hostTCCR1A;
+extern HostRegister8 hostTCCR1B;
+extern HostRegister8 hostTCCR1C;
+extern HostRegister16 hostTCNT1;
+extern HostRegister16 hostICR1;
+extern HostRegister16 hostOCR1A;
+extern HostRegister16 hostOCR1B;
+extern HostRegister8 hostTIMSK1;
+extern HostRegister8 hostTIFR1;
+extern HostRegister16 hostOCR1C;
+extern HostRegister8 hostTCCR3A;
+extern HostRegister8 hostTCCR3B;
+extern HostRegister8 hostTCCR3C;
+extern HostRegister16 hostTCNT3;
+extern HostRegister16 hostICR3;
+extern HostRegister16 hostOCR3A;
+extern HostRegister16 hostOCR3B;
+extern HostRegister16 hostOCR3C;
+extern HostRegister8 hostTIMSK3;
+extern HostRegister8 hostTIFR3;
+extern HostRegister8 hostUCSR0A;
+extern HostRegister8 hostUCSR0B;
+extern HostRegister8 hostUCSR0C;
+extern HostRegister16 hostUBRR0;
+extern HostRegister8 hostUDR0;
+extern HostRegister8 hostUCSR1A;
+extern HostRegister8 hostUCSR1B;
+extern HostRegister8 hostUCSR1C;
+extern HostRegister16 hostUBRR1;
+extern HostRegister8 hostUDR1;
+extern HostRegister8 hostUCSR2A;
+extern HostRegister8 hostUCSR2B;
+extern HostRegister8 hostUCSR2C;
+extern HostRegister16 hostUBRR2;
+extern HostRegister8 hostUDR2;
+extern HostRegister8 hostUCSR3A;
+extern HostRegister8 hostUCSR3B;
+extern HostRegister8 hostUCSR3C;
+extern HostRegister16 hostUBRR3;
+extern HostRegister8 hostUDR3;
+extern HostRegister8 hostTCCR2A;
+extern HostRegister8 hostTCCR2B;
+extern HostRegister8 hostTCNT2;
+extern HostRegister8 hostOCR2A;
+extern HostRegister8 hostOCR2B;
+extern HostRegister8 hostTIMSK2;
+extern HostRegister8 hostTIFR2;
+extern HostRegister8 hostTCCR0A;
+extern HostRegister8 hostTCCR0B;
+extern HostRegister8 hostTCNT0;
+extern HostRegister8 hostOCR0A;
+extern HostRegister8 hostOCR0B;
+extern HostRegister8 hostTCCR4A;
+extern HostRegister8 hostTCCR4B;
+extern HostRegister8 hostTCCR4C;
+extern HostRegister16 hostTCNT4;
+extern HostRegister16 hostICR4;
+extern HostRegister16 hostOCR4A;
+extern HostRegister16 hostOCR4B;
+extern HostRegister16 hostOCR4C;
+extern HostRegister8 hostTCCR5A;
+extern HostRegister8 hostTCCR5B;
+extern HostRegister8 hostTCCR5C;
+extern HostRegister16 hostTCNT5;
+extern HostRegister16 hostICR5;
+extern HostRegister16 hostOCR5A;
+extern HostRegister16 hostOCR5B;
+extern HostRegister16 hostOCR5C;
+extern HostRegister8 hostSMCR;
+extern HostRegister8 hostWDTCSR;
+extern HostRegister8 hostTIMSK0;
+extern HostRegister8 hostADCSRA;
+extern HostRegister8 hostASSR;
+extern HostRegister8 hostTIMSK4;
+extern HostRegister8 hostTIMSK5;
+extern HostRegister8 hostTIFR0;
+extern HostRegister16 hostADC;
+extern HostRegister8 hostADCSRB;
+extern HostRegister8 hostADMUX;
+extern HostRegister8 hostDIDR0;
+extern HostRegister8 hostDIDR2;
+extern HostRegister8 hostSPCR;
+extern HostRegister8 hostSPSR;
+extern HostRegister8 hostSPDR;
+extern HostRegister8 hostTWBR;
+extern HostRegister8 hostTWSR;
+extern HostRegister8 hostTWAR;
+extern HostRegister8 hostTWDR;
+extern HostRegister8 hostTWCR;
+
+#define PINA         hostPINA
+#define DDRA         hostDDRA
+#define PORTA        hostPORTA
+#define PINB         hostPINB
+#define DDRB         hostDDRB
+#define PORTB        hostPORTB
+#define PINC         hostPINC
+#define DDRC         hostDDRC
+#define PORTC        hostPORTC
+#define PIND         hostPIND
+#define DDRD         hostDDRD
+#define PORTD        hostPORTD
+#define PINE         hostPINE
+#define DDRE         hostDDRE
+#define PORTE        hostPORTE
+#define PINF         hostPINF
+#define DDRF         hostDDRF
+#define PORTF        hostPORTF
+#define PING         hostPING
+#define DDRG         hostDDRG
+#define PORTG        hostPORTG
+#define PINH         hostPINH
+#define DDRH         hostDDRH
+#define PORTH        hostPORTH
+#define PINJ         hostPINJ
+#define DDRJ         hostDDRJ
+#define PORTJ        hostPORTJ
+#define PINK         hostPINK
+#define DDRK         hostDDRK
+#define PORTK        hostPORTK
+#define PINL         hostPINL
+#define DDRL         hostDDRL
+#define PORTL        hostPORTL
+#define SREG         hostSREG
+#define EICRB        hostEICRB
+#define EICRA        hostEICRA
+#define EIMSK        hostEIMSK
+#define EIFR         hostEIFR
+#define PCICR        hostPCICR
+#define PCIFR        hostPCIFR
+#define PCMSK0       hostPCMSK0
+#define PCMSK1       hostPCMSK1
+#define PCMSK2       hostPCMSK2
+#define TCCR1A       hostTCCR1A
+#define TCCR1B       hostTCCR1B
+#define TCCR1C       hostTCCR1C
+#define TCNT1        hostTCNT1
+#define ICR1         hostICR1
+#define OCR1A        hostOCR1A
+#define OCR1B        hostOCR1B
+#define TIMSK1       hostTIMSK1
+#define TIFR1        hostTIFR1
+#define OCR1C        hostOCR1C
+#define TCCR3A       hostTCCR3A
+#define TCCR3B       hostTCCR3B
+#define TCCR3C       hostTCCR3C
+#define TCNT3        hostTCNT3
+#define ICR3         hostICR3
+#define OCR3A        hostOCR3A
+#define OCR3B        hostOCR3B
+#define OCR3C        hostOCR3C
+#define TIMSK3       hostTIMSK3
+#define TIFR3        hostTIFR3
+#define UCSR0A       hostUCSR0A
+#define UCSR0B       hostUCSR0B
+#define UCSR0C       hostUCSR0C
+#define UBRR0        hostUBRR0
+#define UDR0         hostUDR0
+#define UCSR1A       hostUCSR1A
+#define UCSR1B       hostUCSR1B
+#define UCSR1C       hostUCSR1C
+#define UBRR1        hostUBRR1
+#define UDR1         hostUDR1
+#define UCSR2A       hostUCSR2A
+#define UCSR2B       hostUCSR2B
+#define UCSR2C       hostUCSR2C
+#define UBRR2        hostUBRR2
+#define UDR2         hostUDR2
+#define UCSR3A       hostUCSR3A
+#define UCSR3B       hostUCSR3B
+#define UCSR3C       hostUCSR3C
+#define UBRR3        hostUBRR3
+#define UDR3         hostUDR3
+#define TCCR2A       hostTCCR2A
+#define TCCR2B       hostTCCR2B
+#define TCNT2        hostTCNT2
+#define OCR2A        hostOCR2A
+#define OCR2B        hostOCR2B
+#define TIMSK2       hostTIMSK2
+#define TIFR2        hostTIFR2
+#define TCCR0A       hostTCCR0A
+#define TCCR0B       hostTCCR0B
+#define TCNT0        hostTCNT0
+#define OCR0A        hostOCR0A
+#define OCR0B        hostOCR0B
+#define TCCR4A       hostTCCR4A
+#define TCCR4B       hostTCCR4B
+#define TCCR4C       hostTCCR4C
+#define TCNT4        hostTCNT4
+#define ICR4         hostICR4
+#define OCR4A        hostOCR4A
+#define OCR4B        hostOCR4B
+#define OCR4C        hostOCR4C
+#define TCCR5A       hostTCCR5A
+#define TCCR5B       hostTCCR5B
+#define TCCR5C       hostTCCR5C
+#define TCNT5        hostTCNT5
+#define ICR5         hostICR5
+#define OCR5A        hostOCR5A
+#define OCR5B        hostOCR5B
+#define OCR5C        hostOCR5C
+#define SMCR         hostSMCR
+#define WDTCSR       hostWDTCSR
+#define TIMSK0       hostTIMSK0
+#define ADCSRA       hostADCSRA
+#define ASSR         hostASSR
+#define TIMSK4       hostTIMSK4
+#define TIMSK5       hostTIMSK5
+#define TIFR0        hostTIFR0
+#define ADC          hostADC
+#define ADCSRB       hostADCSRB
+#define ADMUX        hostADMUX
+#define DIDR0        hostDIDR0
+#define DIDR2        hostDIDR2
+#define SPCR         hostSPCR
+#define SPSR         hostSPSR
+#define SPDR         hostSPDR
+#define TWBR         hostTWBR
+#define TWSR         hostTWSR
+#define TWAR         hostTWAR
+#define TWDR         hostTWDR
+#define TWCR         hostTWCR
+
+#define INT0_vect       _VECTOR(1)
+#define INT1_vect       _VECTOR(2)
+#define INT2_vect       _VECTOR(3)
+#define INT3_vect       _VECTOR(4)
+#define INT4_vect       _VECTOR(5)
+#define INT5_vect       _VECTOR(6)
+#define INT6_vect       _VECTOR(7)
+#define INT7_vect       _VECTOR(8)
+#define PCINT0_vect     _VECTOR(9)
+#define PCINT1_vect     _VECTOR(10)
+#define PCINT2_vect     _VECTOR(11)
+#define TIMER1_OVF_vect _VECTOR(20)
+#define TIMER3_OVF_vect _VECTOR(35)
+#define USART0_RX_vect  _VECTOR(25)
+#define USART0_UDRE_vect _VECTOR(26)
+#define USART1_RX_vect  _VECTOR(36)
+#define USART1_UDRE_vect _VECTOR(37)
+#define USART2_RX_vect  _VECTOR(51)
+#define USART2_UDRE_vect _VECTOR(52)
+#define USART3_RX_vect  _VECTOR(54)
+#define USART3_UDRE_vect _VECTOR(55)
+#define TIMER2_COMPA_vect _VECTOR(13)
+#define ADC_vect        _VECTOR(29)
+#define SPI_STC_vect    _VECTOR(24)
+#define TWI_vect        _VECTOR(39)
+
+#define MUX5    3       //in ADCSRB, only on the ATmega2560
+
+#elif defined(__AVR_ATmega328P__)
+
+extern HostRegister8 hostPINB;
+extern HostRegister8 hostDDRB;
+extern HostRegister8 hostPORTB;
+extern HostRegister8 hostPINC;
+extern HostRegister8 hostDDRC;
+extern HostRegister8 hostPORTC;
+extern HostRegister8 hostPIND;
+extern HostRegister8 hostDDRD;
+extern HostRegister8 hostPORTD;
+extern HostRegister8 hostSREG;
+extern HostRegister8 hostEICRA;
+extern HostRegister8 hostEIMSK;
+extern HostRegister8 hostEIFR;
+extern HostRegister8 hostPCICR;
+extern HostRegister8 hostPCIFR;
+extern HostRegister8 hostPCMSK0;
+extern HostRegister8 hostPCMSK1;
+extern HostRegister8 hostPCMSK2;
+extern HostRegister8 hostTCCR1A;
+extern HostRegister8 hostTCCR1B;
+extern HostRegister8 hostTCCR1C;
+extern HostRegister16 hostTCNT1;
+extern HostRegister16 hostICR1;
+extern HostRegister16 hostOCR1A;
+extern HostRegister16 hostOCR1B;
+extern HostRegister8 hostTIMSK1;
+extern HostRegister8 hostTIFR1;
+extern HostRegister8 hostUCSR0A;
+extern HostRegister8 hostUCSR0B;
+extern HostRegister8 hostUCSR0C;
+extern HostRegister16 hostUBRR0;
+extern HostRegister8 hostUDR0;
+extern HostRegister8 hostTCCR2A;
+extern HostRegister8 hostTCCR2B;
+extern HostRegister8 hostTCNT2;
+extern HostRegister8 hostOCR2A;
+extern HostRegister8 hostOCR2B;
+extern HostRegister8 hostTIMSK2;
+extern HostRegister8 hostTIFR2;
+extern HostRegister8 hostTCCR0A;
+extern HostRegister8 hostTCCR0B;
+extern HostRegister8 hostTCNT0;
+extern HostRegister8 hostOCR0A;
+extern HostRegister8 hostOCR0B;
+extern HostRegister8 hostSMCR;
+extern HostRegister8 hostWDTCSR;
+extern HostRegister8 hostTIMSK0;
+extern HostRegister8 hostADCSRA;
+extern HostRegister8 hostASSR;
+extern HostRegister8 hostTIFR0;
+extern HostRegister16 hostADC;
+extern HostRegister8 hostADCSRB;
+extern HostRegister8 hostADMUX;
+extern HostRegister8 hostDIDR0;
+extern HostRegister8 hostSPCR;
+extern HostRegister8 hostSPSR;
+extern HostRegister8 hostSPDR;
+extern HostRegister8 hostTWBR;
+extern HostRegister8 hostTWSR;
+extern HostRegister8 hostTWAR;
+extern HostRegister8 hostTWDR;
+extern HostRegister8 hostTWCR;
+
+#define PINB         hostPINB
+#define DDRB         hostDDRB
+#define PORTB        hostPORTB
+#define PINC         hostPINC
+#define DDRC         hostDDRC
+#define PORTC        hostPORTC
+#define PIND         hostPIND
+#define DDRD         hostDDRD
+#define PORTD        hostPORTD
+#define SREG         hostSREG
+#define EICRA        hostEICRA
+#define EIMSK        hostEIMSK
+#define EIFR         hostEIFR
+#define PCICR        hostPCICR
+#define PCIFR        hostPCIFR
+#define PCMSK0       hostPCMSK0
+#define PCMSK1       hostPCMSK1
+#define PCMSK2       hostPCMSK2
+#define TCCR1A       hostTCCR1A
+#define TCCR1B       hostTCCR1B
+#define TCCR1C       hostTCCR1C
+#define TCNT1        hostTCNT1
+#define ICR1         hostICR1
+#define OCR1A        hostOCR1A
+#define OCR1B        hostOCR1B
+#define TIMSK1       hostTIMSK1
+#define TIFR1        hostTIFR1
+#define UCSR0A       hostUCSR0A
+#define UCSR0B       hostUCSR0B
+#define UCSR0C       hostUCSR0C
+#define UBRR0        hostUBRR0
+#define UDR0         hostUDR0
+#define TCCR2A       hostTCCR2A
+#define TCCR2B       hostTCCR2B
+#define TCNT2        hostTCNT2
+#define OCR2A        hostOCR2A
+#define OCR2B        hostOCR2B
+#define TIMSK2       hostTIMSK2
+#define TIFR2        hostTIFR2
+#define TCCR0A       hostTCCR0A
+#define TCCR0B       hostTCCR0B
+#define TCNT0        hostTCNT0
+#define OCR0A        hostOCR0A
+#define OCR0B        hostOCR0B
+#define SMCR         hostSMCR
+#define WDTCSR       hostWDTCSR
+#define TIMSK0       hostTIMSK0
+#define ADCSRA       hostADCSRA
+#define ASSR         hostASSR
+#define TIFR0        hostTIFR0
+#define ADC          hostADC
+#define ADCSRB       hostADCSRB
+#define ADMUX        hostADMUX
+#define DIDR0        hostDIDR0
+#define SPCR         hostSPCR
+#define SPSR         hostSPSR
+#define SPDR         hostSPDR
+#define TWBR         hostTWBR
+#define TWSR         hostTWSR
+#define TWAR         hostTWAR
+#define TWDR         hostTWDR
+#define TWCR         hostTWCR
+
+#define INT0_vect       _VECTOR(1)
+#define INT1_vect       _VECTOR(2)
+#define PCINT0_vect     _VECTOR(3)
+#define PCINT1_vect     _VECTOR(4)
+#define PCINT2_vect     _VECTOR(5)
+#define TIMER1_OVF_vect _VECTOR(13)
+#define USART_RX_vect   _VECTOR(18)
+#define USART_UDRE_vect _VECTOR(19)
+#define TIMER2_COMPA_vect _VECTOR(7)
+#define ADC_vect        _VECTOR(21)
+#define SPI_STC_vect    _VECTOR(17)
+#define TWI_vect        _VECTOR(24)
+
+#endif
+
+//Bit-numbers within the registers (the same on both microcontrollers)
+#define CS10    0
+#define CS11    1
+#define CS12    2
+#define TOIE1   0
+#define TOV1    0
+#define CS30    0
+#define CS31    1
+#define CS32    2
+#define TOIE3   0
+#define TOV3    0
+#define CS20    0
+#define CS21    1
+#define CS22    2
+#define TOIE2   0
+#define OCIE2A  1
+#define TOV2    0
+#define OCF2A   1
+#define RXC0    7
+#define TXC0    6
+#define UDRE0   5
+#define FE0     4
+#define DOR0    3
+#define UPE0    2
+#define U2X0    1
+#define RXCIE0  7
+#define TXCIE0  6
+#define UDRIE0  5
+#define RXEN0   4
+#define TXEN0   3
+#define UCSZ01  2
+#define UCSZ00  1
+#define SE      0
+#define SM0     1
+#define SM1     2
+#define SM2     3
+#define WDIE    6
+#define AS2     5
+#define ADEN    7
+#define ADIE    3
+#define ADSC    6
+#define ADATE   5
+#define ADIF    4
+#define ADPS0   0
+#define TOV0    0
+#define OCF0A   1
+#define OCF1B   2
+#define ICF1    5
+#define SPIE    7
+#define SPE     6
+#define DORD    5
+#define MSTR    4
+#define CPOL    3
+#define CPHA    2
+#define SPR1    1
+#define SPR0    0
+#define SPIF    7
+#define SPI2X   0
+#define TWINT   7
+#define TWEA    6
+#define TWSTA   5
+#define TWSTO   4
+#define TWWC    3
+#define TWEN    2
+#define TWIE    0
+#define TWPS0   0
+
+#endif /* HOST_AVR_IO_H_ */
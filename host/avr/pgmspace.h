@@ -0,0 +1,41 @@
+/*
+    avr/pgmspace.h (host-version) - Replaces <avr/pgmspace.h> of avr-libc,
+    when the simpleAVRLib-Library is compiled for the host (see doc/Host.md).
+    The host has only one address-space, so PROGMEM-data is ordinary
+    constant data.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+
+typedef const char* PGM_P;
+
+#define PSTR(s)                 (s)
+#define strlen_P(s)             strlen(s)
+
+#define pgm_read_byte(addr)     (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)     (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)    (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr)      ((void*)*(void* const*)(addr))
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
@@ -0,0 +1,40 @@
+/*
+    avr/sleep.h (host-version) - Replaces <avr/sleep.h> of avr-libc, when
+    the simpleAVRLib-Library is compiled for the host (see doc/Host.md).
+    The sleep-instruction becomes a call of `hostSleep()`.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_AVR_SLEEP_H_
+#define HOST_AVR_SLEEP_H_
+
+#include <avr/io.h>
+
+//Values of the bits SM2:0 in SMCR (the same on both microcontrollers)
+#define SLEEP_MODE_IDLE         0x00
+#define SLEEP_MODE_ADC          0x02
+#define SLEEP_MODE_PWR_DOWN     0x04
+#define SLEEP_MODE_PWR_SAVE     0x06
+#define SLEEP_MODE_STANDBY      0x0C
+#define SLEEP_MODE_EXT_STANDBY  0x0E
+
+#define set_sleep_mode(mode)    (SMCR = (SMCR & (uint8_t)~0x0E) | (mode))
+#define sleep_enable()          (SMCR |= (1<<SE))
+#define sleep_disable()         (SMCR &= (uint8_t)~(1<<SE))
+#define sleep_cpu()             hostSleep()
+
+#endif /* HOST_AVR_SLEEP_H_ */
@@ -0,0 +1,28 @@
+/*
+    util/delay.h (host-version) - Replaces <util/delay.h> of avr-libc, when
+    the simpleAVRLib-Library is compiled for the host (see doc/Host.md).
+    The delays return immediately.
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_UTIL_DELAY_H_
+#define HOST_UTIL_DELAY_H_
+
+static inline void _delay_us( double us ) { (void)us; }
+static inline void _delay_ms( double ms ) { (void)ms; }
+
+#endif /* HOST_UTIL_DELAY_H_ */
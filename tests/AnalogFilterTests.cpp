@@ -0,0 +1,333 @@
+/*
+    AnalogFilterTests.cpp - Test-vectors for the filters of AnalogFilter.h,
+    compiled and executed on the host (see doc/Host.md).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "AnalogInput.h"
+#include "AnalogFilter.h"
+
+#ifndef SIMPLEAVRLIB_HOST
+#error "The tests are compiled for the host (see doc/Host.md)"
+#endif
+
+extern "C" void ADC_vect( void );
+
+static unsigned _failures;
+
+//Compares a value with the expected one, and reports a difference
+#define CHECK_EQUAL( actual, expected )                                     \
+    _checkEqual( (long)(actual), (long)(expected), #actual, __LINE__ )
+
+static void _checkEqual( long actual, long expected, const char* what,
+                         int line )
+{
+    if (actual == expected) return;
+    printf( "AnalogFilterTests.cpp:%d: %s is %ld, expected %ld\n",
+            line, what, actual, expected );
+    _failures++;
+}
+
+//Adds `count` samples with the same value, and returns the number of
+//results, that became available
+template<class Filter>
+static unsigned _addSamples( Filter& filter, uint16_t sample, unsigned count )
+{
+    unsigned results = 0;
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (filter.addSample( sample )) results++;
+    }
+    return results;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// OversampleFilter
+//////////////////////////////////////////////////////////////////////////
+
+static void testOversampleLimits()
+{
+    //the ends of the range of the 10-bit-ADC: 0 ... 4092 with 2 extra bits
+    OversampleFilter<2> low;
+    CHECK_EQUAL( _addSamples( low, 0, 15 ), 0 );
+    CHECK_EQUAL( low.addSample( 0 ), true );
+    CHECK_EQUAL( low.getResult(), 0 );
+
+    OversampleFilter<2> high;
+    CHECK_EQUAL( _addSamples( high, 1023, 16 ), 1 );
+    CHECK_EQUAL( high.getResult(), 4092 );
+
+    //16-bit-results: 4096 samples of 1023 need a 32-bit-sum
+    OversampleFilter<6> widest;
+    CHECK_EQUAL( _addSamples( widest, 1023, 4096 ), 1 );
+    CHECK_EQUAL( widest.getResult(), 65472 );
+    CHECK_EQUAL( OversampleFilter<6>::RESULT_BITS, 16 );
+}
+
+static void testOversampleRounding()
+{
+    //sum 8193: 2048.25 is rounded down
+    OversampleFilter<2> down;
+    _addSamples( down, 512, 15 );
+    down.addSample( 513 );
+    CHECK_EQUAL( down.getResult(), 2048 );
+
+    //sum 8194: 2048.5 is rounded up
+    OversampleFilter<2> up;
+    _addSamples( up, 512, 14 );
+    _addSamples( up, 513, 2 );
+    CHECK_EQUAL( up.getResult(), 2049 );
+
+    //the next result starts with an empty sum
+    CHECK_EQUAL( _addSamples( up, 0, 16 ), 1 );
+    CHECK_EQUAL( up.getResult(), 0 );
+}
+
+static void testOversampleNoise()
+{
+    //a voltage of 300.25 LSB with 1 LSB of noise: the samples are 300 and
+    //301 (3:1), the 12-bit-result is 1201 (300.25 * 4)
+    OversampleFilter<2> filter;
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        filter.addSample( (i & 0x03) == 0 ? 301 : 300 );
+    }
+    CHECK_EQUAL( filter.getResult(), 1201 );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// MovingAverageFilter
+//////////////////////////////////////////////////////////////////////////
+
+static void testMovingAveragePriming()
+{
+    //the first sample fills the window: no ramp up from 0
+    MovingAverageFilter<2> filter;
+    CHECK_EQUAL( filter.addSample( 100 ), true );
+    CHECK_EQUAL( filter.getResult(), 100 );
+
+    //window 200, 100, 100, 100
+    filter.addSample( 200 );
+    CHECK_EQUAL( filter.getResult(), 125 );
+
+    //window 200, 200, 100, 100: 150; then 175 and 200
+    filter.addSample( 200 );
+    CHECK_EQUAL( filter.getResult(), 150 );
+    filter.addSample( 200 );
+    CHECK_EQUAL( filter.getResult(), 175 );
+    filter.addSample( 200 );
+    CHECK_EQUAL( filter.getResult(), 200 );
+}
+
+static void testMovingAverageLimits()
+{
+    //64 samples of 1023: the sum just fits into 16 bits
+    MovingAverageFilter<6> filter;
+    _addSamples( filter, 1023, 100 );
+    CHECK_EQUAL( filter.getResult(), 1023 );
+    _addSamples( filter, 0, 63 );
+    CHECK_EQUAL( filter.getResult(), 16 );     //1023/64 = 15.98
+    filter.addSample( 0 );
+    CHECK_EQUAL( filter.getResult(), 0 );
+
+    //rounding: window 1, 0 gives 0.5, rounded up
+    MovingAverageFilter<1> halves;
+    halves.addSample( 0 );
+    halves.addSample( 1 );
+    CHECK_EQUAL( halves.getResult(), 1 );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// MedianFilter
+//////////////////////////////////////////////////////////////////////////
+
+static void testMedianSpikes()
+{
+    MedianFilter<5> filter;
+    filter.addSample( 10 );
+    CHECK_EQUAL( filter.getResult(), 10 );
+
+    //single spikes up and down are removed
+    const uint16_t samples[] = { 10, 1000, 10, 10, 0, 10, 1023, 10 };
+    for (uint8_t i = 0; i < sizeof(samples)/sizeof(samples[0]); i++)
+    {
+        filter.addSample( samples[i] );
+        CHECK_EQUAL( filter.getResult(), 10 );
+    }
+
+    //a step passes, when it is longer than half the window
+    _addSamples( filter, 10, 5 );
+    filter.addSample( 500 );
+    filter.addSample( 500 );
+    CHECK_EQUAL( filter.getResult(), 10 );
+    filter.addSample( 500 );
+    CHECK_EQUAL( filter.getResult(), 500 );
+}
+
+//The median of the last `length` samples, by sorting a copy
+static uint16_t _referenceMedian( const uint16_t* samples, uint8_t end,
+                                  uint8_t length )
+{
+    uint16_t window[15];
+    for (uint8_t i = 0; i < length; i++)
+    {
+        window[i] = samples[end >= i ? end - i : 0];
+    }
+    for (uint8_t i = 1; i < length; i++)
+    {
+        for (uint8_t j = i; j > 0 && window[j-1] > window[j]; j--)
+        {
+            uint16_t swap = window[j];
+            window[j] = window[j-1];
+            window[j-1] = swap;
+        }
+    }
+    return window[length / 2];
+}
+
+static void testMedianDuplicates()
+{
+    //few different values: many duplicates in the window, so the sorted
+    //copy has to find the right one of equal samples
+    uint16_t samples[200];
+    uint16_t random = 1;
+    for (uint8_t i = 0; i < 200; i++)
+    {
+        random = random * 25173 + 13849;
+        samples[i] = (random >> 8) & 0x03;
+    }
+
+    MedianFilter<7> filter;
+    for (uint8_t i = 0; i < 200; i++)
+    {
+        filter.addSample( samples[i] );
+        CHECK_EQUAL( filter.getResult(), _referenceMedian( samples, i, 7 ) );
+    }
+
+    MedianFilter<3> constant;
+    _addSamples( constant, 5, 10 );
+    CHECK_EQUAL( constant.getResult(), 5 );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// AnalogFilterChain and AnalogFilterBank
+//////////////////////////////////////////////////////////////////////////
+
+static void testFilterChain()
+{
+    //the spike is removed before oversampling
+    AnalogFilterChain< MedianFilter<3>, OversampleFilter<1> > chain;
+    const uint16_t samples[] = { 100, 100, 900, 100 };
+    unsigned results = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        if (chain.addSample( samples[i] )) results++;
+    }
+    CHECK_EQUAL( results, 1 );
+    CHECK_EQUAL( chain.getResult(), 200 );
+}
+
+static void testFilterBank()
+{
+    typedef AnalogFilterBank< OversampleFilter<1>, 2 > Filters;
+
+    //each channel-index has its own filter, that drops 3 of 4 samples
+    uint16_t sample = 0;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        sample = 100;
+        CHECK_EQUAL( Filters::filterSample( 0, &sample ), false );
+        sample = 301;
+        CHECK_EQUAL( Filters::filterSample( 1, &sample ), false );
+    }
+    sample = 100;
+    CHECK_EQUAL( Filters::filterSample( 0, &sample ), true );
+    CHECK_EQUAL( sample, 200 );
+    sample = 302;
+    CHECK_EQUAL( Filters::filterSample( 1, &sample ), true );
+    CHECK_EQUAL( sample, 603 );     //(3*301 + 302) / 2 = 602.5
+
+    //a channel-index without filter is stored unchanged
+    sample = 7;
+    CHECK_EQUAL( Filters::filterSample( 2, &sample ), true );
+    CHECK_EQUAL( sample, 7 );
+}
+
+static void testFilterBankInScan()
+{
+    //Filters in the Interrupt-Service-Routine of the ADC: a scan is only
+    //stored, when both channels have a result (every 4th conversion of each
+    //channel). Another type than in testFilterBank, so the filters start
+    //empty.
+    typedef AnalogFilterBank< OversampleFilter<1>, 3 > Filters;
+    static const uint8_t channels[2] = { 3, 5 };
+    static uint16_t buffer[ANALOG_SCAN_BUFFER_LENGTH( 2, 1 )];
+
+    setAnalogSampleFilter( Filters::filterSample );
+    CHECK_EQUAL( startAnalogScan( channels, 2, buffer, 1,
+                                  ANALOG_REFERENCE_AVCC,
+                                  ANALOG_TRIGGER_TIMER0_COMPA ), true );
+
+    //with a trigger, the conversions are channel-index 0, 1, 0, 1, ...
+    for (uint8_t i = 0; i < 7; i++)
+    {
+        ADC.value = (i & 0x01) ? 250 : 40;
+        ADC_vect();
+    }
+    CHECK_EQUAL( hasAnalogScanBlock(), false );
+    ADC.value = 250;
+    ADC_vect();
+    CHECK_EQUAL( hasAnalogScanBlock(), true );
+
+    const uint16_t* block = takeAnalogScanBlock();
+    CHECK_EQUAL( block[0], 80 );
+    CHECK_EQUAL( block[1], 500 );
+    releaseAnalogScanBlock();
+
+    stopAnalogScan();
+    setAnalogSampleFilter( 0 );
+}
+
+
+int main()
+{
+    testOversampleLimits();
+    testOversampleRounding();
+    testOversampleNoise();
+    testMovingAveragePriming();
+    testMovingAverageLimits();
+    testMedianSpikes();
+    testMedianDuplicates();
+    testFilterChain();
+    testFilterBank();
+    testFilterBankInScan();
+
+    if (_failures)
+    {
+        printf( "AnalogFilterTests: %u failures\n", _failures );
+        return 1;
+    }
+    printf( "AnalogFilterTests: passed\n" );
+    return 0;
+}
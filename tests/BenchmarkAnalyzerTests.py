@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+#
+#   BenchmarkAnalyzerTests.py - Tests of the static analysis of
+#   benchmarks/run_benchmarks.py with the disassembly in tests/fixtures.
+#   This is part of the simpleAVRLib-Library.
+#   Copyright (c) 2018 Wolfgang Zukrigl
+#
+#   This program is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#   tests/fixtures/bench_atmega328p.objdump has the format of
+#   `avr-objdump -d`, bench_atmega328p.size the one of `avr-size`, and
+#   object_atmega2560.objdump the one of `avr-objdump -d -r` of an
+#   object-file (with relocations). The functions are written by hand, so
+#   that the expected values below can be counted in the listing (cycles
+#   from the last instruction backwards).
+
+import io
+import os
+import sys
+import unittest
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+FIXTURES = os.path.join(ROOT, "tests", "fixtures")
+sys.path.insert(0, os.path.join(ROOT, "benchmarks"))
+sys.dont_write_bytecode = True
+
+import run_benchmarks
+
+
+def _read(name):
+    with open(os.path.join(FIXTURES, name)) as f:
+        return f.read()
+
+
+class ParseTests(unittest.TestCase):
+    def setUp(self):
+        self.functions, self.addresses = run_benchmarks.parse_disassembly(
+            _read("bench_atmega328p.objdump"))
+
+    def test_functions(self):
+        self.assertEqual(self.addresses[0x80], "bench_writePin")
+        self.assertEqual(self.addresses[0x9e], "__vector_1")
+        self.assertEqual(len(self.functions["__vector_1"]), 21)
+        self.assertEqual(len(self.functions), 12)
+
+    def test_instructions(self):
+        lookup = self.functions["_lookup"]
+        self.assertEqual([i.mnemonic for i in lookup],
+                         ["cpi", "brcc", "cpse", "subi", "ret", "ldi", "ret"])
+        self.assertEqual(lookup[1].target, 0x8e)
+        self.assertIsNone(lookup[0].target)     # "; 8" is no address
+        call = self.functions["bench_lookup"][1]
+        self.assertEqual((call.address, call.size, call.target),
+                         (0x94, 4, 0x84))
+        self.assertIsNone(self.functions["bench_lookup"][2].target)  # sts
+        self.assertEqual(self.functions["bench_tail"][-1].target, 0x80)
+
+    def test_size(self):
+        self.assertEqual(run_benchmarks.parse_size(_read("bench_atmega328p.size")),
+                         {"text": 278, "data": 0, "bss": 4})
+
+
+class AnalyzerTests(unittest.TestCase):
+    def analyze(self, name, return_address_bytes=2):
+        functions, addresses = run_benchmarks.parse_disassembly(
+            _read("bench_atmega328p.objdump"))
+        analyzer = run_benchmarks.Analyzer(functions, addresses,
+                                           return_address_bytes)
+        return analyzer.analyze(name)
+
+    def assertResult(self, result, instructions, cycles_max, stack_bytes,
+                     flash_bytes, notes=()):
+        self.assertEqual(result, {"instructions": instructions,
+                                  "cycles_max": cycles_max,
+                                  "stack_bytes": stack_bytes,
+                                  "flash_bytes": flash_bytes,
+                                  "notes": sorted(notes)})
+
+    def test_cycle_table(self):
+        small = run_benchmarks.cycle_table(2)
+        big = run_benchmarks.cycle_table(3)
+        self.assertEqual((small["call"], small["ret"], small["rcall"]),
+                         (4, 4, 3))
+        self.assertEqual((big["call"], big["ret"], big["rcall"]), (5, 5, 4))
+        self.assertEqual((small["lds"], small["sbi"], small["lpm"]),
+                         (2, 2, 3))
+        self.assertNotIn("ldi", small)
+
+    def test_straight(self):
+        # sbi (2) + ret (4)
+        self.assertResult(self.analyze("bench_writePin"), 2, 6, 0, 4)
+
+    def test_branch_and_skip(self):
+        # cpi, brcc not taken, cpse skipping subi, ret: 1 + 1 + 2 + 4
+        self.assertResult(self.analyze("_lookup"), 7, 8, 0, 14)
+
+    def test_call(self):
+        # ldi, call (4) + _lookup (8), sts (2), ret (4); return-address
+        self.assertResult(self.analyze("bench_lookup"), 11, 19, 2, 26)
+        # ATmega2560: call, ret and the return-address take one more
+        self.assertResult(self.analyze("bench_lookup", 3), 11, 22, 3, 26)
+
+    def test_interrupt(self):
+        # 6 pushes; the handler called by icall is not included
+        self.assertResult(self.analyze("__vector_1"), 21, 41, 6, 46,
+                          ["indirect_call"])
+
+    def test_loop(self):
+        self.assertResult(self.analyze("bench_clear"), 8, None, 0, 16,
+                          ["loop"])
+
+    def test_frame_and_tail_call(self):
+        # 2 pushes and 4 bytes of local variables; jmp (3) + bench_writePin
+        # (6) reuses the return-address
+        self.assertResult(self.analyze("bench_tail"), 22, 35, 6, 46)
+
+    def test_rcall_frame(self):
+        # "rcall .+0" allocates 2 bytes (3 on the ATmega2560)
+        self.assertResult(self.analyze("bench_frame"), 4, 11, 2, 8)
+        self.assertResult(self.analyze("bench_frame", 3), 4, 13, 3, 8)
+
+
+class ObjectFileTests(unittest.TestCase):
+    """An object-file, as in the comparison of two versions of GPIO.cpp
+    (doc/Benchmarks.md). The targets of calls and jumps are relocations."""
+
+    def setUp(self):
+        functions, addresses = run_benchmarks.parse_disassembly(
+            _read("object_atmega2560.objdump"))
+        self.functions = functions
+        self.analyzer = run_benchmarks.Analyzer(functions, addresses, 3)
+
+    def test_relocations(self):
+        write_pin = self.functions["writePin"]
+        self.assertEqual((write_pin[0].symbol, write_pin[0].target),
+                         ("_lookupPort", 0x00))
+        self.assertEqual((write_pin[3].symbol, write_pin[3].target),
+                         (".text+0x1c", 0x1c))  # static function
+        modify = self.functions["_modify"]
+        self.assertEqual(modify[0].target, 0x24)     # rcall of _setBits
+        self.assertIsNone(modify[1].target)          # in another file
+
+    def test_analyze(self):
+        # a relocated "rcall .+0" is a call (4) of _setBits (7), not a
+        # stack-frame; the call into another file counts only itself (5)
+        self.assertEqual(self.analyzer.analyze("_modify"),
+                         {"instructions": 5, "cycles_max": 21,
+                          "stack_bytes": 3, "flash_bytes": 12,
+                          "notes": ["unknown_call"]})
+        # call (5) + _lookupPort (9), cpi, breq not taken, jmp (3) + _modify
+        self.assertEqual(self.analyzer.analyze("writePin"),
+                         {"instructions": 17, "cycles_max": 40,
+                          "stack_bytes": 3, "flash_bytes": 40,
+                          "notes": ["unknown_call"]})
+
+    def test_analyze_listings(self):
+        stdout = sys.stdout
+        sys.stdout = io.StringIO()
+        try:
+            run_benchmarks.analyze_listings(
+                [os.path.join(FIXTURES, "object_atmega2560.objdump")],
+                "atmega2560")
+            lines = sys.stdout.getvalue().splitlines()
+        finally:
+            sys.stdout = stdout
+        self.assertEqual(len(lines), 6)
+        self.assertEqual(lines[3].split(),
+                         ["writePin", "17", "40", "3", "40", "unknown_call"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,188 @@
+/*
+    DebounceTests.cpp - Test-vectors for the debouncing of Debounce.h,
+    compiled and executed on the host (see doc/Host.md).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "Debounce.h"
+
+#ifndef SIMPLEAVRLIB_HOST
+#error "The tests are compiled for the host (see doc/Host.md)"
+#endif
+
+static unsigned _failures;
+
+//Compares a value with the expected one, and reports a difference
+#define CHECK_EQUAL( actual, expected )                                     \
+    _checkEqual( (long)(actual), (long)(expected), #actual, __LINE__ )
+
+static void _checkEqual( long actual, long expected, const char* what,
+                         int line )
+{
+    if (actual == expected) return;
+    printf( "DebounceTests.cpp:%d: %s is %ld, expected %ld\n",
+            line, what, actual, expected );
+    _failures++;
+}
+
+//Feeds the voltage-levels `samples` of PINB (one per call of debouncePort)
+//and checks the changes returned by each call
+static void _feed( DebouncedPort* debouncedPort, const uint8_t* samples,
+                   const uint8_t* changes, uint8_t count, int line )
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        PINB.value = samples[i];
+        uint8_t changed = debouncePort( debouncedPort );
+        if (changed != changes[i])
+        {
+            printf( "DebounceTests.cpp:%d: sample %u (0x%02X): changed is "
+                    "0x%02X, expected 0x%02X\n",
+                    line, i, samples[i], changed, changes[i] );
+            _failures++;
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Tests
+//////////////////////////////////////////////////////////////////////////
+
+//A button between PB0 and GND: pressed after 4 equal samples, not after 3
+static void testPressAndRelease()
+{
+    DebouncedPort buttons;
+    PINB.value = 0x01;
+    initDebouncedPort( &buttons, port_B, 0x01, 0x01 );
+    CHECK_EQUAL( getDebouncedState( &buttons ), 0x00 );
+
+    static const uint8_t press[4]   = { 0x00, 0x00, 0x00, 0x00 };
+    static const uint8_t pressed[4] = { 0x00, 0x00, 0x00, 0x01 };
+    _feed( &buttons, press, pressed, 4, __LINE__ );
+    CHECK_EQUAL( getDebouncedState( &buttons ), 0x01 );
+    CHECK_EQUAL( getDebouncedPressed( &buttons ), 0x01 );
+    CHECK_EQUAL( getDebouncedPressed( &buttons ), 0x00 );
+    CHECK_EQUAL( getDebouncedReleased( &buttons ), 0x00 );
+
+    static const uint8_t release[5]  = { 0x01, 0x01, 0x01, 0x01, 0x01 };
+    static const uint8_t released[5] = { 0x00, 0x00, 0x00, 0x01, 0x00 };
+    _feed( &buttons, release, released, 5, __LINE__ );
+    CHECK_EQUAL( getDebouncedState( &buttons ), 0x00 );
+    CHECK_EQUAL( getDebouncedReleased( &buttons ), 0x01 );
+    CHECK_EQUAL( getDebouncedPressed( &buttons ), 0x00 );
+}
+
+//A bouncing contact: each sample equal to the debounced state restarts the
+//count of 4
+static void testBounce()
+{
+    DebouncedPort buttons;
+    PINB.value = 0x01;
+    initDebouncedPort( &buttons, port_B, 0x01, 0x01 );
+
+    static const uint8_t press[13] =
+        { 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01,
+          0x00, 0x00, 0x00, 0x00 };
+    static const uint8_t pressed[13] =
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+          0x00, 0x00, 0x00, 0x01 };
+    _feed( &buttons, press, pressed, 13, __LINE__ );
+
+    static const uint8_t release[10] =
+        { 0x01, 0x00, 0x01, 0x01, 0x01, 0x00, 0x01, 0x01, 0x01, 0x01 };
+    static const uint8_t released[10] =
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 };
+    _feed( &buttons, release, released, 10, __LINE__ );
+    CHECK_EQUAL( getDebouncedState( &buttons ), 0x00 );
+    CHECK_EQUAL( getDebouncedPressed( &buttons ), 0x01 );
+    CHECK_EQUAL( getDebouncedReleased( &buttons ), 0x01 );
+}
+
+//Each pin has its own counter: PB0 (active low) and PB1 (active high) start
+//at different samples, PB7 is not debounced
+static void testPinsIndependent()
+{
+    DebouncedPort buttons;
+    PINB.value = 0x01;
+    initDebouncedPort( &buttons, port_B, 0x03, 0x01 );
+
+    static const uint8_t samples[6] = { 0x80, 0x80, 0x82, 0x82, 0x82, 0x82 };
+    static const uint8_t changes[6] = { 0x00, 0x00, 0x00, 0x01, 0x00, 0x02 };
+    _feed( &buttons, samples, changes, 6, __LINE__ );
+    CHECK_EQUAL( getDebouncedState( &buttons ), 0x03 );
+    CHECK_EQUAL( getDebouncedPressed( &buttons ), 0x03 );
+}
+
+//A button already pressed at the initialization gives no "pressed"-event
+static void testPressedAtInit()
+{
+    DebouncedPort buttons;
+    PINB.value = 0x00;
+    initDebouncedPort( &buttons, port_B, 0x01, 0x01 );
+    CHECK_EQUAL( getDebouncedState( &buttons ), 0x01 );
+
+    static const uint8_t samples[4] = { 0x00, 0x00, 0x00, 0x00 };
+    static const uint8_t changes[4] = { 0x00, 0x00, 0x00, 0x00 };
+    _feed( &buttons, samples, changes, 4, __LINE__ );
+    CHECK_EQUAL( getDebouncedPressed( &buttons ), 0x00 );
+}
+
+//debouncePorts and the class PortDebouncer
+static void testPortsAndClass()
+{
+    DebouncedPort ports[2];
+    PINB.value = 0x00;
+    PIND.value = 0x00;
+    initDebouncedPort( &ports[0], port_B, 0x01, 0x00 );
+    initDebouncedPort( &ports[1], port_D, 0x01, 0x00 );
+    PortDebouncer buttons( port_D, 0x02, 0x00 );
+
+    PINB.value = 0x01;
+    PIND.value = 0x03;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        debouncePorts( ports, 2 );
+        CHECK_EQUAL( buttons.debounce(), i == 3 ? 0x02 : 0x00 );
+    }
+    CHECK_EQUAL( getDebouncedState( &ports[0] ), 0x01 );
+    CHECK_EQUAL( getDebouncedState( &ports[1] ), 0x01 );
+    CHECK_EQUAL( buttons.getState(), 0x02 );
+    CHECK_EQUAL( buttons.getPressed(), 0x02 );
+    CHECK_EQUAL( buttons.getReleased(), 0x00 );
+}
+
+
+int main()
+{
+    testPressAndRelease();
+    testBounce();
+    testPinsIndependent();
+    testPressedAtInit();
+    testPortsAndClass();
+
+    if (_failures)
+    {
+        printf( "DebounceTests: %u failures\n", _failures );
+        return 1;
+    }
+    printf( "DebounceTests: passed\n" );
+    return 0;
+}
@@ -0,0 +1,218 @@
+/*
+    GPIOTests.cpp - Tests of the register-accesses of GPIO.cpp and of the
+    Special-Function-Registers of the host-backend (see doc/Host.md).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "GPIO.h"
+
+#ifndef SIMPLEAVRLIB_HOST
+#error "The tests are compiled for the host (see doc/Host.md)"
+#endif
+
+static unsigned _failures;
+
+//Compares a value with the expected one, and reports a difference
+#define CHECK_EQUAL( actual, expected )                                     \
+    _checkEqual( (long)(actual), (long)(expected), #actual, __LINE__ )
+
+static void _checkEqual( long actual, long expected, const char* what,
+                         int line )
+{
+    if (actual == expected) return;
+    printf( "GPIOTests.cpp:%d: %s is %ld, expected %ld\n",
+            line, what, actual, expected );
+    _failures++;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// GPIO.cpp
+//////////////////////////////////////////////////////////////////////////
+
+//One read-modify-write of DDRx, no other register
+static void testSetPortMode()
+{
+    hostResetRegisters();
+    DDRB.value = 0xF0;
+    setPortMode( port_B, 0x05, 0x0F );
+    CHECK_EQUAL( DDRB.value, 0xF5 );
+    CHECK_EQUAL( DDRB.reads, 1 );
+    CHECK_EQUAL( DDRB.writes, 1 );
+    CHECK_EQUAL( PORTB.reads + PORTB.writes, 0 );
+    CHECK_EQUAL( hostGetAccessCount().reads, 1 );
+    CHECK_EQUAL( hostGetAccessCount().writes, 1 );
+}
+
+//One read-modify-write of PORTx, also on port L of the ATmega2560 (outside
+//of the I/O-space)
+static void testWritePin()
+{
+    hostResetRegisters();
+    PORTD.value = 0x81;
+    writePin( port_D, 3, HIGH_LEVEL );
+    CHECK_EQUAL( PORTD.value, 0x89 );
+    writePin( port_D, 0, LOW_LEVEL );
+    CHECK_EQUAL( PORTD.value, 0x88 );
+    CHECK_EQUAL( PORTD.reads, 2 );
+    CHECK_EQUAL( PORTD.writes, 2 );
+    CHECK_EQUAL( DDRD.reads + DDRD.writes + PIND.reads + PIND.writes, 0 );
+
+#ifdef PORTL
+    hostResetAccessCount();
+    writePin( port_L, 3, HIGH_LEVEL );
+    CHECK_EQUAL( PORTL.value, 0x08 );
+    CHECK_EQUAL( PORTL.reads, 1 );
+    CHECK_EQUAL( PORTL.writes, 1 );
+#else
+    //The port doesn't exist: nothing is accessed
+    hostResetAccessCount();
+    writePin( port_L, 3, HIGH_LEVEL );
+    CHECK_EQUAL( hostGetAccessCount().reads, 0 );
+    CHECK_EQUAL( hostGetAccessCount().writes, 0 );
+#endif
+}
+
+//One write of PINx (no read of PORTx)
+static void testTogglePin()
+{
+    hostResetRegisters();
+    PORTB.value = 0x01;
+    togglePin( port_B, 0 );
+    CHECK_EQUAL( PORTB.value, 0x00 );
+    togglePin( port_B, 5 );
+    CHECK_EQUAL( PORTB.value, 0x20 );
+    CHECK_EQUAL( PINB.writes, 2 );
+    CHECK_EQUAL( PINB.reads, 0 );
+    CHECK_EQUAL( PORTB.reads + PORTB.writes, 0 );
+    CHECK_EQUAL( hostGetAccessCount().reads, 0 );
+    CHECK_EQUAL( hostGetAccessCount().writes, 2 );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Host-backend
+//////////////////////////////////////////////////////////////////////////
+
+//Writing 1-Bits to PINx toggles PORTx, PINx keeps the input-levels
+static void testPINWrite()
+{
+    hostResetRegisters();
+    PIND.value = 0x3C;
+    PORTD.value = 0x0F;
+    PIND = 0x81;
+    CHECK_EQUAL( PORTD.value, 0x8E );
+    CHECK_EQUAL( PIND.value, 0x3C );
+    PIND = 0x00;
+    CHECK_EQUAL( PORTD.value, 0x8E );
+    CHECK_EQUAL( PORTD.writes, 0 );
+}
+
+//Interrupt-Flag-Registers: writing 1-Bits clears them, 0-Bits don't change
+//them. A read-modify-write (like `EIFR |= 0x01`) clears all set flags, as on
+//the microcontroller.
+static void testW1C()
+{
+    static const char* const names[] =
+        { "EIFR", "PCIFR", "TIFR0", "TIFR1", "TIFR2", "TIFR3" };
+    for (uint8_t i = 0; i < sizeof(names)/sizeof(names[0]); i++)
+    {
+        HostRegister8* reg = hostFindRegister( names[i] );
+#ifndef TIFR3
+        if (i == 5)
+        {
+            CHECK_EQUAL( reg == 0, true );
+            continue;
+        }
+#endif
+        if (!reg)
+        {
+            printf( "GPIOTests.cpp:%d: %s not found\n", __LINE__, names[i] );
+            _failures++;
+            continue;
+        }
+        reg->value = 0xFF;
+        *reg = 0x05;
+        CHECK_EQUAL( reg->value, 0xFA );
+        *reg = 0x00;
+        CHECK_EQUAL( reg->value, 0xFA );
+        reg->value = 0x0A;
+        *reg |= 0x01;
+        CHECK_EQUAL( reg->value, 0x00 );
+    }
+
+    //a plain register stores the written value
+    hostResetRegisters();
+    EIMSK = 0x05;
+    EIMSK = 0x00;
+    CHECK_EQUAL( EIMSK.value, 0x00 );
+}
+
+//The counters are per register. A 16-Bit-register counts two accesses.
+static void testAccessCountsPerRegister()
+{
+    hostResetRegisters();
+    PORTB = 0x01;
+    uint8_t value = PORTB;
+    value += PORTB;
+    DDRD |= 0x01;
+    CHECK_EQUAL( value, 0x02 );
+    CHECK_EQUAL( PORTB.reads, 2 );
+    CHECK_EQUAL( PORTB.writes, 1 );
+    CHECK_EQUAL( DDRD.reads, 1 );
+    CHECK_EQUAL( DDRD.writes, 1 );
+    CHECK_EQUAL( PORTD.reads + PORTD.writes + DDRB.reads + DDRB.writes, 0 );
+
+    TCNT1 = 1000;
+    uint16_t count = TCNT1;
+    CHECK_EQUAL( count, 1000 );
+    CHECK_EQUAL( TCNT1.reads, 2 );
+    CHECK_EQUAL( TCNT1.writes, 2 );
+    CHECK_EQUAL( hostGetAccessCount().reads, 5 );
+    CHECK_EQUAL( hostGetAccessCount().writes, 4 );
+
+    CHECK_EQUAL( hostFindRegister( "PORTB" ) == &PORTB, true );
+    CHECK_EQUAL( hostFindRegister16( "TCNT1" ) == &TCNT1, true );
+
+    //hostResetAccessCount clears the counters of each register, but keeps
+    //the values
+    hostResetAccessCount();
+    CHECK_EQUAL( PORTB.reads + PORTB.writes + TCNT1.reads + TCNT1.writes, 0 );
+    CHECK_EQUAL( PORTB.value, 0x01 );
+}
+
+
+int main()
+{
+    testSetPortMode();
+    testWritePin();
+    testTogglePin();
+    testPINWrite();
+    testW1C();
+    testAccessCountsPerRegister();
+
+    if (_failures)
+    {
+        printf( "GPIOTests: %u failures\n", _failures );
+        return 1;
+    }
+    printf( "GPIOTests: passed\n" );
+    return 0;
+}
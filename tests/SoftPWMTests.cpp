@@ -0,0 +1,240 @@
+/*
+    SoftPWMTests.cpp - Tests of the Interrupt-Service-Routine of SoftPWM.cpp
+    with a simulated Timer/Counter2, compiled and executed on the host (see
+    doc/Host.md).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "SoftPWM.h"
+
+#ifndef SIMPLEAVRLIB_HOST
+#error "The tests are compiled for the host (see doc/Host.md)"
+#endif
+
+extern "C" void TIMER2_COMPA_vect( void );
+
+static unsigned _failures;
+
+//Compares a value with the expected one, and reports a difference
+#define CHECK_EQUAL( actual, expected )                                     \
+    _checkEqual( (long)(actual), (long)(expected), #actual, __LINE__ )
+
+static void _checkEqual( long actual, long expected, const char* what,
+                         int line )
+{
+    if (actual == expected) return;
+    printf( "SoftPWMTests.cpp:%d: %s is %ld, expected %ld\n",
+            line, what, actual, expected );
+    _failures++;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Simulated Timer/Counter2
+//////////////////////////////////////////////////////////////////////////
+
+//Ticks since the start, and the levels of PORTB and PORTD during each tick
+//(at its end)
+#define _PERIODS    3
+static uint16_t _ticks;
+static uint8_t _levelsB[_PERIODS * 256];
+static uint8_t _levelsD[_PERIODS * 256];
+
+//Advances the Timer/Counter by one tick. An overflow sets TOV2.
+static void _tick()
+{
+    if (_ticks < _PERIODS * 256)
+    {
+        _levelsB[_ticks] = PORTB.value;
+        _levelsD[_ticks] = PORTD.value;
+    }
+    _ticks++;
+    TCNT2.value = (uint8_t)_ticks;
+    if (TCNT2.value == 0) TIFR2.value |= (1<<TOV2);
+}
+
+//Each read of TCNT2 takes time: every 8th read is in the next tick, so the
+//Interrupt-Service-Routine can wait for an output-change close to the
+//current one. It starts at the beginning of a tick (reads = 0).
+static uint8_t _reads;
+
+static void _onReadTCNT2( HostRegister8* reg )
+{
+    (void)reg;
+    if (++_reads % 8 == 0) _tick();
+}
+
+//Runs the Timer/Counter for `_PERIODS` periods from tick 0, and calls the
+//Interrupt-Service-Routine at each Compare-Match. Returns the values of
+//OCR2A after the Interrupt-Service-Routines of period `period`.
+static uint8_t _run( uint8_t period, uint8_t* ocrValues, uint8_t maxValues )
+{
+    _ticks = 0;
+    TCNT2.value = 0;
+    TCNT2.onRead = _onReadTCNT2;
+    uint8_t ocrCount = 0;
+    while (_ticks < _PERIODS * 256)
+    {
+        uint16_t tick = _ticks;
+        if ((TIMSK2.value & (1<<OCIE2A)) && TCNT2.value == OCR2A.value)
+        {
+            _reads = 0;
+            TIMER2_COMPA_vect();
+            if (tick / 256 == period && ocrCount < maxValues)
+            {
+                ocrValues[ocrCount++] = OCR2A.value;
+            }
+        }
+        //a tick not used up by the Interrupt-Service-Routine
+        if (_ticks == tick) _tick();
+    }
+    TCNT2.onRead = 0;
+    return ocrCount;
+}
+
+//Checks the level of a pin in each tick of a period against the expected
+//ones (`on` is called with the tick within the period)
+static void _checkPeriod( const uint8_t* levels, uint8_t period, uint8_t mask,
+                          bool (*on)( uint8_t tick, uint8_t duty ),
+                          uint8_t duty, int line )
+{
+    for (uint16_t tick = 0; tick < 256; tick++)
+    {
+        bool level = levels[period * 256 + tick] & mask;
+        if (level != on( (uint8_t)tick, duty ))
+        {
+            printf( "SoftPWMTests.cpp:%d: duty %u, tick %u: level is %u\n",
+                    line, duty, tick, level );
+            _failures++;
+            return;
+        }
+    }
+}
+
+static bool _pwmOn( uint8_t tick, uint8_t duty )
+{
+    return duty == 255 || tick < duty;
+}
+
+static bool _bamOn( uint8_t tick, uint8_t duty )
+{
+    if (tick == 0) return false;
+    uint8_t slot = 7;
+    while (!(tick & (0x80 >> (7 - slot)))) slot--;
+    return duty & (0x01 << slot);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Tests
+//////////////////////////////////////////////////////////////////////////
+
+//PB0 ... PB4 and PD0
+static const uint8_t _duties[6] = { 64, 64, 65, 0, 255, 128 };
+static uint8_t _channels[6];
+
+static void _setDuties()
+{
+    for (uint8_t c = 0; c < 6; c++) setSoftPWMDuty( _channels[c], _duties[c] );
+}
+
+static void testPWM()
+{
+    _setDuties();
+    startSoftPWM( SOFTPWM_MODE_PWM, SOFTPWM_PRESCALER_64 );
+
+    //the first period is all off, the committed duties start with period 1
+    uint8_t ocrValues[8];
+    uint8_t ocrCount = _run( 1, ocrValues, 8 );
+    CHECK_EQUAL( isSoftPWMCommitPending(), false );
+    for (uint8_t pin = 0; pin < 5; pin++)
+    {
+        _checkPeriod( _levelsB, 0, 0x01<<pin, _pwmOn, 0, __LINE__ );
+        _checkPeriod( _levelsB, 1, 0x01<<pin, _pwmOn, _duties[pin], __LINE__ );
+        _checkPeriod( _levelsB, 2, 0x01<<pin, _pwmOn, _duties[pin], __LINE__ );
+    }
+    _checkPeriod( _levelsD, 1, 0x01, _pwmOn, _duties[5], __LINE__ );
+    _checkPeriod( _levelsD, 2, 0x01, _pwmOn, _duties[5], __LINE__ );
+
+    //OCR2A after the Interrupt-Service-Routines of period 1: after its start
+    //64, after 64 (PB0 and PB1 in one store) and 65 (PB2, waited for in the
+    //same run) 128, and after 128 (PD0) the start of period 2
+    CHECK_EQUAL( ocrCount, 3 );
+    CHECK_EQUAL( ocrValues[0], 64 );
+    CHECK_EQUAL( ocrValues[1], 128 );
+    CHECK_EQUAL( ocrValues[2], 0 );
+
+    stopSoftPWM();
+    CHECK_EQUAL( PORTB.value & 0x1F, 0 );
+    CHECK_EQUAL( PORTD.value & 0x01, 0 );
+}
+
+static void testLostToggle()
+{
+    _setDuties();
+    startSoftPWM( SOFTPWM_MODE_PWM, SOFTPWM_PRESCALER_64 );
+    _run( 1, 0, 0 );
+
+    //a read-modify-write of the program undoes the toggle of PB0 at tick 64
+    //of the last period: the next period starts with the right levels again
+    PORTB.value |= 0x01;
+    _run( 0, 0, 0 );
+    _checkPeriod( _levelsB, 0, 0x01, _pwmOn, _duties[0], __LINE__ );
+    stopSoftPWM();
+}
+
+static void testBAM()
+{
+    static const uint8_t duties[6] = { 0xA5, 0x5A, 0x01, 0x00, 0xFF, 0x80 };
+    for (uint8_t c = 0; c < 6; c++) setSoftPWMDuty( _channels[c], duties[c] );
+    startSoftPWM( SOFTPWM_MODE_BAM, SOFTPWM_PRESCALER_64 );
+
+    _run( 1, 0, 0 );
+    for (uint8_t pin = 0; pin < 5; pin++)
+    {
+        _checkPeriod( _levelsB, 1, 0x01<<pin, _bamOn, duties[pin], __LINE__ );
+        _checkPeriod( _levelsB, 2, 0x01<<pin, _bamOn, duties[pin], __LINE__ );
+    }
+    _checkPeriod( _levelsD, 2, 0x01, _bamOn, duties[5], __LINE__ );
+    stopSoftPWM();
+}
+
+
+int main()
+{
+    for (uint8_t pin = 0; pin < 5; pin++)
+    {
+        _channels[pin] = addSoftPWMChannel( port_B, pin );
+    }
+    _channels[5] = addSoftPWMChannel( port_D, 0 );
+    CHECK_EQUAL( _channels[5], 5 );
+
+    testPWM();
+    testLostToggle();
+    testBAM();
+
+    if (_failures)
+    {
+        printf( "SoftPWMTests: %u failures\n", _failures );
+        return 1;
+    }
+    printf( "SoftPWMTests: passed\n" );
+    return 0;
+}
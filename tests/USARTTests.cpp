@@ -0,0 +1,190 @@
+/*
+    USARTTests.cpp - Tests of the baudrate-settings and the buffers of
+    USART.cpp, compiled and executed on the host (see doc/Host.md).
+    This is part of the simpleAVRLib-Library.
+    Copyright (c) 2018 Wolfgang Zukrigl
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "USART.h"
+
+#ifndef SIMPLEAVRLIB_HOST
+#error "The tests are compiled for the host (see doc/Host.md)"
+#endif
+
+#ifdef USART0_RX_vect
+extern "C" void USART0_RX_vect( void );
+extern "C" void USART0_UDRE_vect( void );
+#define _receiveVector      USART0_RX_vect
+#define _transmitVector     USART0_UDRE_vect
+#else
+//ATmega328p
+extern "C" void USART_RX_vect( void );
+extern "C" void USART_UDRE_vect( void );
+#define _receiveVector      USART_RX_vect
+#define _transmitVector     USART_UDRE_vect
+#endif
+
+static unsigned _failures;
+
+//Compares a value with the expected one, and reports a difference
+#define CHECK_EQUAL( actual, expected )                                     \
+    _checkEqual( (long)(actual), (long)(expected), #actual, __LINE__ )
+
+static void _checkEqual( long actual, long expected, const char* what,
+                         int line )
+{
+    if (actual == expected) return;
+    printf( "USARTTests.cpp:%d: %s is %ld, expected %ld\n",
+            line, what, actual, expected );
+    _failures++;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Baudrate
+//////////////////////////////////////////////////////////////////////////
+
+//Double-speed-mode (U2X0), 8N1, receiver, transmitter and the receive-
+//interrupt
+static void testRegisters()
+{
+    initUSART( 0, 9600 );
+    CHECK_EQUAL( UCSR0A.value, (1<<U2X0) );
+    CHECK_EQUAL( UCSR0B.value, (1<<RXCIE0) | (1<<RXEN0) | (1<<TXEN0) );
+    CHECK_EQUAL( UCSR0C.value, (1<<UCSZ01) | (1<<UCSZ00) );
+}
+
+//UBRR is the divider closest to F_CPU / (8 * baudrate), minus 1
+static void testBaudrateRounding()
+{
+    static const uint32_t baudrates[] = { 1200, 2400, 4800, 9600, 14400,
+        19200, 28800, 38400, 57600, 76800, 115200, 230400, 250000, 500000,
+        1000000 };
+    for (uint8_t i = 0; i < sizeof(baudrates)/sizeof(baudrates[0]); i++)
+    {
+        initUSART( 0, baudrates[i] );
+        double divider = (double)F_CPU / 8 / baudrates[i];
+        CHECK_EQUAL( UBRR0.value, (long)(divider + 0.5) - 1 );
+    }
+}
+
+//The values of the table "Examples of UBRRn Settings" in the datasheet
+//(U2Xn = 1, 16 MHz)
+static void testBaudrateTable()
+{
+#if F_CPU == 16000000UL
+    static const uint32_t baudrates[] = { 2400, 4800, 9600, 14400, 19200,
+        28800, 38400, 57600, 76800, 115200, 230400, 250000, 500000, 1000000 };
+    static const uint16_t ubrrs[] = { 832, 416, 207, 138, 103, 68, 51, 34,
+        25, 16, 8, 7, 3, 1 };
+    for (uint8_t i = 0; i < sizeof(baudrates)/sizeof(baudrates[0]); i++)
+    {
+        initUSART( 0, baudrates[i] );
+        CHECK_EQUAL( UBRR0.value, ubrrs[i] );
+        CHECK_EQUAL( UCSR0A.value & (1<<U2X0), (1<<U2X0) );
+    }
+#endif
+}
+
+//Other USART-interfaces, and invalid arguments (no register is accessed)
+static void testOtherInterfaces()
+{
+#if USART_COUNT > 3
+    initUSART( 3, 115200 );
+    CHECK_EQUAL( UBRR3.value, (long)((double)F_CPU / 8 / 115200 + 0.5) - 1 );
+    CHECK_EQUAL( UCSR3A.value, (1<<U2X0) );
+#endif
+    hostResetAccessCount();
+    initUSART( USART_COUNT, 9600 );
+    initUSART( 0, 0 );
+    HostAccessCount count = hostGetAccessCount();
+    CHECK_EQUAL( count.reads, 0 );
+    CHECK_EQUAL( count.writes, 0 );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Buffers
+//////////////////////////////////////////////////////////////////////////
+
+//Bytes and blocks are sent in the order they are queued, then the Data-
+//Register-Empty-Interrupt is turned off
+static void testTransmit()
+{
+    static const uint8_t bytes[2] = { 'a', 'b' };
+    static const uint8_t block[3] = { 'c', 'd', 'e' };
+    initUSART( 0, 9600 );
+    CHECK_EQUAL( writeUSART( 0, bytes, 2 ), 2 );
+    CHECK_EQUAL( queueUSARTBlock( 0, block, 3 ), true );
+    CHECK_EQUAL( writeUSARTByte( 0, 'f' ), true );
+    CHECK_EQUAL( UCSR0B.value & (1<<UDRIE0), (1<<UDRIE0) );
+    CHECK_EQUAL( isUSARTBlockQueued( 0, block ), true );
+
+    static const char expected[] = "abcdef";
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        _transmitVector();
+        CHECK_EQUAL( UDR0.value, expected[i] );
+    }
+    CHECK_EQUAL( isUSARTBlockQueued( 0, block ), false );
+    CHECK_EQUAL( isUSARTTransmitIdle( 0 ), true );
+    _transmitVector();
+    CHECK_EQUAL( UCSR0B.value & (1<<UDRIE0), 0 );
+}
+
+//Received bytes are read in order, a full buffer drops bytes
+static void testReceive()
+{
+    initUSART( 0, 9600 );
+    for (uint8_t i = 0; i < USART_RX_BUFFER_SIZE + 1; i++)
+    {
+        UDR0.value = i;
+        _receiveVector();
+    }
+    CHECK_EQUAL( getUSARTReceivedCount( 0 ), USART_RX_BUFFER_SIZE );
+    CHECK_EQUAL( getUSARTReceiveDropCount( 0 ), 1 );
+
+    uint8_t byte = 0xFF;
+    CHECK_EQUAL( readUSARTByte( 0, &byte ), true );
+    CHECK_EQUAL( byte, 0 );
+    uint8_t buffer[USART_RX_BUFFER_SIZE];
+    CHECK_EQUAL( readUSART( 0, buffer, sizeof(buffer) ),
+                 USART_RX_BUFFER_SIZE - 1 );
+    CHECK_EQUAL( buffer[USART_RX_BUFFER_SIZE - 2], USART_RX_BUFFER_SIZE - 1 );
+    CHECK_EQUAL( readUSARTByte( 0, &byte ), false );
+}
+
+
+int main()
+{
+    testRegisters();
+    testBaudrateRounding();
+    testBaudrateTable();
+    testOtherInterfaces();
+    testTransmit();
+    testReceive();
+
+    if (_failures)
+    {
+        printf( "USARTTests: %u failures\n", _failures );
+        return 1;
+    }
+    printf( "USARTTests: passed\n" );
+    return 0;
+}
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+#
+#   run_tests.py - Compiles the tests of the library for the host and runs
+#   them (see doc/Host.md).
+#   This is part of the simpleAVRLib-Library.
+#   Copyright (c) 2018 Wolfgang Zukrigl
+#
+#   This program is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#   Usage:
+#       python3 tests/run_tests.py [--cxx g++] [--f-cpu 16000000]
+#
+#   Each file tests/*Tests.cpp is a test-program: it is compiled for the host
+#   together with the library, once for each microcontroller, and executed.
+#   It prints its failures and returns 0, if all checks have passed. Each
+#   file tests/*Tests.py (tests of the python-scripts) is executed once with
+#   the same python-interpreter. The exit code of this script is 1, if a
+#   test has failed.
+
+import argparse
+import glob
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+MCUS = {
+    # name: macro for the host-build
+    "atmega2560": "__AVR_ATmega2560__",
+    "atmega328p": "__AVR_ATmega328P__",
+}
+
+LIBRARY_SOURCES = ["GPIO.cpp", "GPIOTransaction.cpp", "ExternalInterrupts.cpp",
+                   "Timebase.cpp", "EventLoop.cpp", "AnalogInput.cpp",
+                   "SPIMaster.cpp", "TWIMaster.cpp", "SoftPWM.cpp",
+                   "USART.cpp", "Debounce.cpp"]
+
+
+def run_test(source, mcu, cxx, f_cpu, workdir):
+    """Compiles and runs a test-program. Returns true, if it has passed."""
+    name = os.path.splitext(os.path.basename(source))[0]
+    exe = os.path.join(workdir, name + "_" + mcu)
+    sources = [source] + [os.path.join(ROOT, s) for s in LIBRARY_SOURCES] \
+              + [os.path.join(ROOT, "host", "HostRegisters.cpp")]
+    try:
+        subprocess.check_call([cxx, "-std=c++11", "-Wall", "-D" + MCUS[mcu],
+                               "-DF_CPU=%dUL" % f_cpu,
+                               "-I" + os.path.join(ROOT, "host"),
+                               "-I" + ROOT] + sources + ["-o", exe])
+    except subprocess.CalledProcessError:
+        print("%s (%s): compile-error" % (name, mcu))
+        return False
+
+    result = subprocess.run([exe], stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    output = result.stdout.decode().rstrip()
+    print("%s (%s): %s" % (name, mcu,
+                           "passed" if result.returncode == 0 else "FAILED"))
+    if result.returncode != 0 and output:
+        print(output)
+    return result.returncode == 0
+
+
+def run_python_test(source):
+    """Runs a test of the python-scripts. Returns true, if it has passed."""
+    name = os.path.splitext(os.path.basename(source))[0]
+    result = subprocess.run([sys.executable, source], stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    output = result.stdout.decode().rstrip()
+    print("%s: %s" % (name, "passed" if result.returncode == 0 else "FAILED"))
+    if result.returncode != 0 and output:
+        print(output)
+    return result.returncode == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Runs the tests of simpleAVRLib on the host")
+    parser.add_argument("--cxx", default="g++",
+                        help="C++-compiler of the host (default g++)")
+    parser.add_argument("--f-cpu", type=int, default=16000000,
+                        help="clock-frequency in Hz (default 16000000)")
+    args = parser.parse_args()
+
+    tests = sorted(glob.glob(os.path.join(ROOT, "tests", "*Tests.cpp")))
+    python_tests = sorted(glob.glob(os.path.join(ROOT, "tests", "*Tests.py")))
+    failed = 0
+    with tempfile.TemporaryDirectory() as workdir:
+        for source in tests:
+            for mcu in MCUS:
+                if not run_test(source, mcu, args.cxx, args.f_cpu, workdir):
+                    failed += 1
+    for source in python_tests:
+        if not run_python_test(source):
+            failed += 1
+
+    print("%d of %d test-runs failed" % (failed, len(tests) * len(MCUS)
+                                         + len(python_tests)))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())